@@ -45,45 +45,84 @@
 
 
 #include "FlipApplyCuts.h"
+#include "FlipBatch.h"                      // for the batched cuts
 
 
-int recast(
+double recast(
     Pythia8::Pythia& pythia,                // Pythia object
-    vector< pair<string, int> > &counts,    // intermediate data (for checking)
+    vector<cutcount> &counts,               // intermediate data (for checking)
     int iSR,                                // Signal Region #
-    int nEvent                              // # events in the Pythia object
+    int nEvent,                             // # events in the Pythia object
+    const recastextras& extras              // optional extras, see header
     ){
     
     Pythia8::Event& event = pythia.event;       
     Pythia8::Event& process = pythia.process;   
     int nAbort = pythia.mode("Main:timesAllowErrors");
+    runstatus* status = extras.status;
+    PartonVeto* veto = extras.veto;
     
     vector<signalregion> signal_region;    // as defined in SUS-12-017 Table 1
     fill_signalregions(signal_region);     // fills data from above paper
     
-    // DEBUGGING
-    // ofstream debug;
-    // debug.open("debug.txt"); // append to end of file
+    // HISTOGRAMS (instead of debug prints), see FlipHistograms.h
+    if (extras.histograms && extras.histograms->hist.empty())
+        init_histograms(*extras.histograms, nCutStages);
     
     
     /****************************************************************************
     *   SET UP COUNTERS FOR SANITY CHECK COUNTS                                 *
+    *   tally.nStage[cutKinematic] is the # events that pass the kinematic     *
+    *   cuts on leptons, etc. See the cutstage list in FlipApplyCuts.h          *
     ****************************************************************************/
     
-    int nGenerated  = 0; // # generated events 
-    int nKinematic  = 0; // # events that pass kinematic cuts on leptons
-    int nLepID      = 0; // # events that pass lepton ID efficiencies
-    int nLepIso     = 0; // # events that pass lepton isolation efficiencies
-    int nbjetSelect = 0; // # events that pass bJet selection efficiencies
-    int nDilepton   = 0; // # events that pass dilepton requirement
-    int nDilepTrig  = 0; // # events that pass dilep req & trig efficiency
-    int nSS2L       = 0; // # events that pass same sign leptons requirement
-    int nJets       = 0; // # events with mininum number of jets
-    int nbJets      = 0; // # events with minimum number of tagged b jets
-    int nMET        = 0; // # events that pass minimum MET requirement
-    int nHT         = 0; // # events that pass minimum HT requirement
-    int nCharge     = 0; // # events that pass ++ or -- requirement
-    int nPassed     = 0; // # events that passed all cuts
+    cuttally tally;
+    
+    
+    /****************************************************************************
+    *   ORDER OF THE CUTS                                                       *
+    *   By default the cut units are applied in the canonical order, i.e. the   *
+    *   order of the cutflow. With RPVg:tuneCuts = on, the first tuneEvents     *
+    *   events apply every unit (to measure its cost and rejection), and the   *
+    *   rest use the cheapest order and stop at the first unit that fails.     *
+    *   The rows in between are then estimated, see tune_cut_order.            *
+    ****************************************************************************/
+    
+    int nProfile = 0;
+    if (pythia.flag("RPVg:tuneCuts")){
+        if (extras.histograms || extras.replicas || extras.events)
+            cout << endl << " RPVg:tuneCuts is off: histograms, replicas and "
+                << "event records need every stage" << endl;
+        else nProfile = pythia.mode("RPVg:tuneEvents");
+    }
+    cutorder order(nProfile);
+    
+    // With RPVg:profileFile every unit applied is timed (plain loop only)
+    string profileFile = pythia.word("RPVg:profileFile");
+    if (pythia.mode("RPVg:batchEvents") == 0 && !profileFile.empty()){
+        order.timeApplied = true;
+        order.applied.clockCost = clock_cost();
+    }
+    
+    
+    /****************************************************************************
+    *   PARTON LEVEL VETO                                                       *
+    *   Events vetoed inside pythia.next() never make it here, but they were   *
+    *   generated: they count towards nEvent and the 'Generated' row.          *
+    ****************************************************************************/
+    
+    int nVetoed = 0;
+    
+    
+    /****************************************************************************
+    *   BATCHED CUTS                                                            *
+    *   With RPVg:batchEvents > 0 the events are collected in a block and cut  *
+    *   all at once when it's full, see FlipBatch.h.                            *
+    ****************************************************************************/
+    
+    eventbatch batch;
+    int nBatch = pythia.mode("RPVg:batchEvents");
+    if (nBatch > 0) init_batch(batch, nBatch);
     
     
     /****************************************************************************
@@ -93,7 +132,17 @@ int recast(
     int iAbort = 0;
     for (int iEvent = 0; iEvent < nEvent; ++iEvent) { // loop over events
         
-        if (!pythia.next()) {                   // if no new event
+        bool generated = pythia.next();
+        
+        if (veto && veto->nVetoed > nVetoed){   // events we never saw
+            tally.nStage[cutGenerated] += veto->nVetoed - nVetoed;
+            iEvent += veto->nVetoed - nVetoed;
+            nVetoed = veto->nVetoed;
+        }
+        
+        if (!generated) {                       // if no new event
+            if (status) update_status(*status, tally.nStage[cutGenerated]
+                + batch.nEvents, tally.nPassed, iAbort+1);
             if (++iAbort < nAbort) continue;    // if not over abort limit
             cout << " Event generation aborted prematurely, owing to error!\n"; 
             break;
@@ -102,187 +151,761 @@ int recast(
             
         /************************************************************************
         * SET UP EVENT DATA FOR LATER INSPECTION                                *
+        * --------------------------------------                                *
+        * Most events don't have two good leptons, so we only grab the leptons  *
+        * here. pythia.process is read when a cut first needs it, and the       *
+        * hadrons are never stored: the isolation only needs the pT in each     *
+        * lepton cone, which hadron_cone_pT sums up in one pass.                *
         ************************************************************************/
         
-        vector< pair<int, fastjet::PseudoJet> > leptons; // generated leptons
-        vector< pair<int, fastjet::PseudoJet> > partons; // generated partons
-        vector< pair<int, fastjet::PseudoJet> > bpartons;   // b quarks (parton)
-        vector< pair<int, fastjet::PseudoJet> > hadrons;    // hadrons in event
-        fastjet::PseudoJet METvec (0.0, 0.0, 0.0, 0.0);     // cumulative MET
-        double MET (0.0);                                   // MET scalar
-        double HT (0.0);                                    // HT scalar
-            
+        eventobjects objects;
+        objects.event       = &event;
+        objects.process     = &process;
+        objects.haveProcess = false;
+        objects.unitsApplied = 0;
+        objects.stagesPassed = 0;
+        objects.random      = 0;
+        objects.keepStages  = (extras.histograms != 0);
+        objects.uMET        = -1.0;
+        objects.uHT         = -1.0;
+        if (extras.events){         // the same for every SR in the record
+            objects.uMET    = event_uniform(*extras.events);
+            objects.uHT     = event_uniform(*extras.events);
+        }
         
-        /************************************************************************
-        * LOOP THROUGH EVENT PARTICLES                                          *
-        ************************************************************************/
+        // Event weight (biased sampling) x forced decay weight, FlipWeights.h
+        double weight = event_weight(pythia.info, process, extras.decays);
         
-        grabEvent(event, leptons, hadrons);
-        grabProcess(process, METvec, partons, bpartons);
-        nGenerated++;        
+        grabLeptons(event, objects.leptons);
         
         
         /************************************************************************
-        * IMPOSE KINEMATIC CUTS AND ID EFFICIENCIES                             *
+        * IMPOSE CUTS                                                           *
+        * -----------                                                           *
+        * 'reached' is the first stage that the event fails (nCutStages if it  *
+        * passes everything); it passes all of the stages before that.          *
         ************************************************************************/        
-                        
-        leptons = apply_cut(lepton_kinematic_cut, leptons);
-        if (leptons.size() > 1) nKinematic++; else continue;
-
-        partons = apply_cut(jet_kinematic_cut, partons);
-        
-        leptons = apply_cut(lepton_ID_eff, leptons);
-        if (leptons.size() > 1) nLepID++; else continue;
-                
-        leptons = apply_iso(leptons, hadrons);
-        if (leptons.size() > 1) nLepIso++; else continue;
-        
-        // Order leptons by pT: do this AFTER isolation since we re-order
-        sort (leptons.begin(), leptons.end(), pTordered);
-
-        bpartons = apply_cut(b_selection_efficiency, bpartons);
-        if (bpartons.size() > 1) nbjetSelect++; else continue;
-        
-        if (leptons.size() < 2) continue; else nDilepton++;
-        
-        if (!lepton_trig_efficiency(leptons)) continue; else nDilepTrig++;
-        
-        // Same-sign dileptons
-        // -------------------
-        if (leptons[0].first/abs(leptons[0].first) != 
-            leptons[1].first/abs(leptons[1].first)) continue;
-        else nSS2L++;
-        // Note: assuming that you're only looking at two hardest leptons
-        
-        
         
-        // Signal region cuts: from input
-        // ------------------------------
+        if (nBatch > 0){
+            int topo = extras.topologies ? decay_topology(process) : topoOther;
+            add_to_batch(batch, objects.leptons, &event, process, weight, topo);
+            if (batch_full(batch)) flush_batch(batch, signal_region[iSR], 
+                tally, extras.histograms, extras.topologies, extras.replicas);
+        }
+        else {
+            int reached = cut_event(objects, signal_region[iSR], order);
+            tally_event(tally, reached, weight, objects.tunedStop);
+            if (extras.histograms) fill_event_histograms(*extras.histograms, 
+                objects, reached, weight);
+            if (extras.topologies) tally_topology(*extras.topologies, 
+                decay_topology(process), reached == nCutStages, weight);
+            if (extras.replicas) tally_replicas(*extras.replicas, reached, 
+                weight);
+            if (extras.events) record_event(*extras.events, objects, 
+                signal_region, iSR, reached, weight);
+        }
+        
+        if (status) update_status(*status, tally.nStage[cutGenerated]
+            + batch.nEvents, tally.nPassed, iAbort);
         
-        if (partons.size() < signal_region[iSR].minJets) continue;        
-        else nJets++;
         
-        if (bpartons.size() < signal_region[iSR].minbJets) continue;
-        else nbJets++;
-        
-        MET = METvec.pt(); 
-        if (!METefficiency(MET,signal_region[iSR].minMET)) continue;
-        else nMET++;
-        
-        for(unsigned int iPar = 0; iPar < partons.size(); iPar++){
-            HT += partons[iPar].second.pt();
-        } // end for loop over partons
-        // 
-        if (!HTefficiency(HT,signal_region[iSR].minHT)) continue;
-        else nHT++;
-        
-        bool minmin = (leptons[0].first > 0) && signal_region[iSR].minusminus;
-        bool pluplu = (leptons[0].first < 0) && signal_region[iSR].plusplus;
-        
-        if (!(minmin || pluplu)) continue;
-        else nCharge++;
+        /************************************************************************
+        * EARLY STOP                                                            *
+        * ----------                                                            *
+        * Once in a while (see FlipLimit.h), check whether the point is        *
+        * already clearly excluded or allowed. Batched: only between blocks.    *
+        ************************************************************************/
         
-        // Made it this far? YOU PASS
-        nPassed++;
+        if (extras.limit && (batch.nEvents == 0)
+            && (tally.nStage[cutGenerated] >= extras.limit->nextLook) 
+            && limit_look(*extras.limit, tally.nStage[cutGenerated], 
+                tally.sumwPassed, tally.sumw2[nCutStages-1], 
+                pythia.info.sigmaGen(), pythia.info.sigmaErr()) ){
+            cout << endl << " Stopped after " << tally.nStage[cutGenerated] 
+                << " events: " << limit_decision_name[extras.limit->decision]
+                << " at " << extras.limit->confidence << " confidence" << endl;
+            break;
+        }
         
     } // end for loop, going through Events
     
+    flush_batch(batch, signal_region[iSR], tally, extras.histograms, 
+        extras.topologies, extras.replicas);    // what's left of the last block
+    
+    if (veto){
+        cout << endl << " " << nVetoed << " events vetoed at parton level" << endl;
+        tally.sumw[cutGenerated] += veto->sumw;
+        tally.sumw2[cutGenerated] += veto->sumw2;
+        if (extras.topologies) add_topologies(*extras.topologies, veto->topologies);
+        if (extras.replicas) add_replicas(*extras.replicas, veto->replicas);
+    }
+    
+    estimate_rows(tally, order);
+    fill_counts(counts, tally, signal_region[iSR]);
+    if (order.timeApplied && !write_profile(profileFile, order.applied))
+        cout << endl << "ERROR: can't write the cut profile to " << profileFile
+            << endl;
+    
+    
+    return tally.sumwPassed; 
+    
+    
+} // end void signal_efficiency(...)
+
+
+
+
+// HELPER FUNCTIONS
+
+
+void addRecastSettings(Pythia8::Pythia& pythia){
+    // Our own settings live next to Pythia's, e.g. in the command file:
+    //      RPVg:statusInterval = 30.
+    
+    pythia.settings.addFlag("RPVg:status", true);
+    pythia.settings.addWord("RPVg:statusDir", "/tmp/RPVgStatus");
+    pythia.settings.addParm("RPVg:statusInterval", 10.0, true, false, 0.0, 0.0);
+    pythia.settings.addMode("RPVg:shardIndex", 0, true, false, 0, 0);
+    pythia.settings.addMode("RPVg:shardCount", 1, true, false, 1, 0);
+    pythia.settings.addMode("RPVg:seed", 0, true, true, 0, 900000000);
+    pythia.settings.addFlag("RPVg:writeCutflow", false);
+    pythia.settings.addFlag("RPVg:partonVeto", false);
+    pythia.settings.addFlag("RPVg:decayBias", false);
+    pythia.settings.addParm("RPVg:decayBiasFactor", 0.2, true, true, 0.0, 1.0);
+    pythia.settings.addFlag("RPVg:tuneCuts", false);
+    pythia.settings.addMode("RPVg:tuneEvents", 2000, true, false, 1, 0);
+    pythia.settings.addWord("RPVg:profileFile", "");    // "": no profile
+    pythia.settings.addMode("RPVg:analysisThreads", 0, true, false, 0, 0);
+    pythia.settings.addMode("RPVg:generators", 1, true, false, 1, 0);
+    pythia.settings.addMode("RPVg:ringSize", 64, true, false, 2, 0);
+    pythia.settings.addMode("RPVg:batchSize", 8, true, false, 1, 0);
+    pythia.settings.addMode("RPVg:sharedParticles", 4000, true, false, 1, 0);
+    pythia.settings.addMode("RPVg:workers", 1, true, false, 1, 0);
+    pythia.settings.addMode("RPVg:batchEvents", 0, true, false, 0, 0);
+    pythia.settings.addFlag("RPVg:histograms", false);
+    pythia.settings.addParm("RPVg:targetPrecision", 0.0, true, false, 0.0, 0.0);
+    pythia.settings.addMode("RPVg:maxEvents", 1000000, true, false, 1, 0);
+    pythia.settings.addFlag("RPVg:earlyStop", false);
+    pythia.settings.addWord("RPVg:upperLimits", "");    // no spaces: 3.1,4.2
+    pythia.settings.addParm("RPVg:luminosity", 10.5, true, false, 0.0, 0.0);
+    pythia.settings.addParm("RPVg:stopConfidence", 0.95, true, true, 0.5, 0.999999);
+    pythia.settings.addMode("RPVg:stopFirstLook", 1000, true, false, 1, 0);
+    pythia.settings.addFlag("RPVg:effMap", false);
+    pythia.settings.addWord("RPVg:effMapFile", "effmap.dat");
+    pythia.settings.addFlag("RPVg:eventRecord", false);
+    pythia.settings.addMode("RPVg:bootstrap", 0, true, false, 0, 0);
+    pythia.settings.addFlag("RPVg:timing", false);
+    pythia.settings.addWord("RPVg:timingFile", "timing.dat");
+    // Read by RPVgPoint before Pythia exists (see FlipCache.h), declared here
+    // so that Pythia doesn't complain about them
+    pythia.settings.addFlag("RPVg:cache", true);
+    pythia.settings.addFlag("RPVg:cacheRefresh", false);
+    pythia.settings.addFlag("RPVg:cacheUnseeded", false);
+    pythia.settings.addWord("RPVg:cacheDir", "cache");
+    pythia.settings.addMode("RPVg:cacheMaxEntries", 10000, true, false, 1, 0);
+} // end addRecastSettings
+
+
+
+double clock_cost(){
+    // The time one reading of the monotonic clock takes
+    
+    const int nRead = 1000;
+    double start = monotonic();
+    for (int iRead = 1; iRead < nRead; iRead++) monotonic();
+    return (monotonic() - start) / nRead;
+} // end clock_cost
+
+
+
+void leading_pT(vector< pair<int,fastjet::PseudoJet> >& leptons,
+    bool kinematic, double& lep1pT, double& lep2pT){
+    // The two hardest leptons (0: none), only the ones that pass the 
+    // kinematic cuts if asked
+    
+    lep1pT = 0.0;
+    lep2pT = 0.0;
+    for (unsigned int iLep = 0; iLep < leptons.size(); iLep++){
+        double pT = leptons[iLep].second.pt();
+        if (kinematic && !lepton_kinematic_cut(leptons[iLep].first, pT,
+            leptons[iLep].second.eta())) continue;
+        if (pT > lep1pT){
+            lep2pT = lep1pT;
+            lep1pT = pT;
+        }
+        else if (pT > lep2pT) lep2pT = pT;
+    } // end loop over leptons
+} // end leading_pT
+
+
+
+void pass_stages(eventobjects& objects, int unit, int failed){
+    // Marks the stages of the unit that the event was checked for and passed
+    
+    for (int iStage = unit_first_stage[unit]; 
+         iStage < unit_first_stage[unit+1] && iStage < failed; iStage++)
+        objects.stagesPassed |= 1u << iStage;
+} // end pass_stages
+
+
+
+void time_unit(cutprofile& profile, int unit, int failed, double seconds){
+    // One application of the unit, for the profile
+    
+    profile.cost[unit] += seconds;
+    profile.nTried[unit]++;
+    if (failed == nCutStages) profile.nPassed[unit]++;
+} // end time_unit
+
+
+
+int cut_event(eventobjects& objects, signalregion& region, cutorder& order){
+    // The cut chain for one event, see FlipApplyCuts.h
+    
+    int reached = nCutStages;
+    objects.stagesPassed |= 1u << cutGenerated;
+    objects.tunedStop = false;
+    
+    if (order.nProfiled < order.nProfile){
+        // Profiling: every unit whose inputs are there, in canonical order.
+        // A unit takes well under a microsecond, so the clock is read once 
+        // between units and the cost of reading it is taken off.
+        if (order.nProfiled == 0) order.profile.clockCost = clock_cost();
+        
+        bool unitPassed[nCutUnits];
+        double start = monotonic();
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+            unitPassed[iUnit] = false;
+            order.profiledFailed.push_back(nCutStages);
+            if ( (cut_dependency[iUnit] >= 0) && 
+                 !unitPassed[cut_dependency[iUnit]] ) continue;
+            
+            int failed = apply_unit(iUnit, objects, region);
+            double now = monotonic();
+            double seconds = now - start - order.profile.clockCost;
+            start = now;
+            time_unit(order.profile, iUnit, failed, seconds);
+            if (order.timeApplied) 
+                time_unit(order.applied, iUnit, failed, seconds);
+            pass_stages(objects, iUnit, failed);
+            
+            if (failed == nCutStages) unitPassed[iUnit] = true;
+            else {
+                order.profiledFailed.back() = failed;
+                if (reached == nCutStages) reached = failed;
+            }
+        } // end loop over units
+        order.profiledReached.push_back(reached);
+        
+        if (++order.nProfiled == order.nProfile){
+            order.order = tune_cut_order(order.profile);
+            count_first_failures(order);
+            if (order.verbose){
+                cout << endl << " Cut units are now applied in the order:";
+                for (unsigned int iUnit = 0; iUnit < order.order.size(); iUnit++)
+                    cout << " " << cut_unit_name[order.order[iUnit]];
+                cout << endl;
+            }
+        }
+        return reached;
+    }
+    
+    // Stop at the first unit that fails (timing each one for 
+    // RPVg:profileFile). Ahead of its canonical place, the units before 
+    // that place that were skipped could fail too: estimate_rows.
+    double start = order.timeApplied ? monotonic() : 0.0;
+    for (unsigned int iUnit = 0; iUnit < order.order.size(); iUnit++){
+        int unit = order.order[iUnit];
+        reached = apply_unit(unit, objects, region);
+        if (order.timeApplied){
+            double now = monotonic();
+            time_unit(order.applied, unit, reached, 
+                now - start - order.applied.clockCost);
+            start = now;
+        }
+        pass_stages(objects, unit, reached);
+        if (reached == nCutStages) continue;
+        
+        for (int jUnit = 0; jUnit < unit; jUnit++)
+            if (!(objects.unitsApplied & (1u << jUnit))) 
+                objects.tunedStop = true;
+        break;
+    } // end loop over units
+    return reached;
+} // end cut_event
+
+
+
+void tally_event(cuttally& tally, int reached, double weight, bool tunedStop){
+    // Made it to 'reached'? You passed everything before it
+    
+    if (tunedStop){             // only generated is certain: estimate_rows
+        tally.nStage[cutGenerated]++;
+        tally.sumw[cutGenerated] += weight;
+        tally.sumw2[cutGenerated] += weight*weight;
+        tally.nTuned[reached]++;
+        tally.sumwTuned[reached] += weight;
+        tally.sumw2Tuned[reached] += weight*weight;
+        return;
+    }
     
+    for (int iStage = 0; iStage < reached; iStage++){
+        tally.nStage[iStage]++;
+        tally.sumw[iStage] += weight;
+        tally.sumw2[iStage] += weight*weight;
+    }
     
-    // Fill counts
-    // -----------
-    fill_vector(counts, "Generated events \t", nGenerated);
-    fill_vector(counts, ">1 lep. kin. cuts\t", nKinematic);
-    fill_vector(counts, ">1 lep. ID. eff.\t", nLepID);
-    fill_vector(counts, ">1 lep. Iso. eff.\t", nLepIso);
-    fill_vector(counts, ">1 bjets tagged \t", nbjetSelect);
-    fill_vector(counts, "at least two leptons \t", nDilepton);
-    fill_vector(counts, "triggered two leptons \t", nDilepTrig);
-    fill_vector(counts, "same sign dileptons \t", nSS2L);
+    // Made it all the way? YOU PASS
+    if (reached == nCutStages){
+        tally.nPassed++;
+        tally.sumwPassed += weight;
+    }
+} // end tally_event
+
+
+
+void estimate_rows(cuttally& tally, cutorder& order){
+    // Each event that stopped at stage t in the tuned order passes stage s 
+    // with the fraction of the profiled events stopping at t that did. No 
+    // profiled event stopped there: as if the skipped units had passed.
+    
+    for (int tStage = 0; tStage < nCutStages; tStage++){
+        if (tally.nTuned[tStage] == 0) continue;
+        
+        int nProfiled = 0;
+        for (int rStage = 0; rStage < nCutStages; rStage++)
+            nProfiled += order.nShare[tStage][rStage];
+        
+        int nBeyond = nProfiled;    // # profiled that passed stage s
+        for (int iStage = cutGenerated + 1; iStage < nCutStages; iStage++){
+            nBeyond -= order.nShare[tStage][iStage];
+            double fraction = (iStage < tStage) ? 1.0 : 0.0;
+            if (nProfiled > 0) fraction = double(nBeyond) / nProfiled;
+            
+            tally.nStage[iStage] += int(tally.nTuned[tStage] * fraction + 0.5);
+            tally.sumw[iStage] += tally.sumwTuned[tStage] * fraction;
+            tally.sumw2[iStage] += tally.sumw2Tuned[tStage] * fraction;
+        } // end loop over stages
+        
+        tally.nTuned[tStage] = 0;
+        tally.sumwTuned[tStage] = 0.0;
+        tally.sumw2Tuned[tStage] = 0.0;
+    } // end loop over tuned stops
+} // end estimate_rows
+
+
+
+void add_tally(cuttally& total, cuttally& tally){
+    for (int iStage = 0; iStage < nCutStages; iStage++){
+        total.nStage[iStage] += tally.nStage[iStage];
+        total.sumw[iStage] += tally.sumw[iStage];
+        total.sumw2[iStage] += tally.sumw2[iStage];
+    }
+    total.nPassed += tally.nPassed;
+    total.sumwPassed += tally.sumwPassed;
+} // end add_tally
+
+
+
+void fill_event_histograms(histogramset& histograms, eventobjects& objects,
+    int reached, double weight){
+    // Fill every stage passed (all of them checked, see cut_event) with the
+    // objects the event had after it: the leptons after each lepton cut, 
+    // b quarks tagged from cutbSelect on, cones from cutLepID on
+    
+    need_process(objects);
+    
+    double HT = 0.0;
+    for (unsigned int iPar = 0; iPar < objects.partons.size(); iPar++)
+        HT += objects.partons[iPar].second.pt();
+    
+    double value[nHistVariables];
+    value[histMET]      = objects.METvec.pt();
+    value[histHT]       = HT;
+    value[histnJets]    = objects.partons.size();
+    
+    for (int iStage = 0; iStage < reached; iStage++){
+        int lepStage = min(iStage, (int)cutLepIso);
+        value[histLep1pT]   = objects.lep1pT[lepStage];
+        value[histLep2pT]   = objects.lep2pT[lepStage];
+        value[histnbJets]   = (iStage < cutbSelect) ? objects.nbPartons 
+                                                    : objects.bpartons.size();
+        
+        vector<histogram>& hist = histograms.hist[iStage];
+        for (int iVar = 0; iVar < histConeSum; iVar++)
+            fill_histogram(hist[iVar], value[iVar], weight);
+        if (iStage < cutLepID) continue;
+        
+        vector<double>& cones = (iStage == cutLepID) ? objects.coneSums
+                                                     : objects.isoConeSums;
+        for (unsigned int iLep = 0; iLep < cones.size(); iLep++)
+            fill_histogram(hist[histConeSum], cones[iLep], weight);
+    } // end loop over stages
+} // end fill_event_histograms
+
+
+
+void record_event(eventwriter& writer, eventobjects& objects,
+    vector<signalregion>& signal_region, int iSR, int reached, double weight){
+    // The cuts that all SRs share are decided once the event got past them:
+    // cut_event applies every unit before its first failure in canonical
+    // order, tuned or not
+    
+    bool common = (reached > cutSS2L);
+    
+    need_process(objects);
+    double HT = 0.0;
+    for (unsigned int iPar = 0; iPar < objects.partons.size(); iPar++)
+        HT += objects.partons[iPar].second.pt();
+    unsigned int nbJets = objects.nbPartons;
+    if (objects.unitsApplied & (1u << unitbTag)) nbJets = objects.bpartons.size();
+    
+    eventrecord record;
+    record.weight   = weight;
+    record.MET      = objects.METvec.pt();
+    record.HT       = HT;
+    record.stages   = objects.stagesPassed;
+    record.regions  = 0;
+    record.nJets    = min(objects.partons.size(), (size_t)255);
+    record.nbJets   = min(nbJets, 255u);
+    record.nLeptons = min(objects.leptons.size(), (size_t)255);
+    record.charge   = 0;
+    if (common) record.charge = (objects.leptons[0].first < 0) ? 1 : -1;
+    
+    // The SRs: the run's own from its cutflow, the others with the two 
+    //  numbers its MET and HT units used (objects.uMET, uHT)
+    
+    if (common){
+        for (unsigned int iRegion = 0; iRegion < signal_region.size() && 
+            iRegion < 16; iRegion++){
+            bool passed;
+            if ((int)iRegion == iSR) passed = (reached == nCutStages);
+            else {
+                signalregion& region = signal_region[iRegion];
+                passed = (objects.partons.size() >= region.minJets) && 
+                    (nbJets >= region.minbJets) &&
+                    METefficiency(record.MET, region.minMET, 0, objects.uMET)
+                    && HTefficiency(HT, region.minHT, 0, objects.uHT);
+                if (passed) passed = (record.charge > 0) ? region.plusplus :
+                    region.minusminus;
+            }
+            if (passed) record.regions |= 1u << iRegion;
+        } // end loop over SRs
+    }
+    
+    write_event(writer, record);
+} // end record_event
+
+
+
+void fill_counts(vector<cutcount>& counts, cuttally& tally, 
+    signalregion& region){
+    // The labels of the cutflow rows
+    
+    int* nStage = tally.nStage;
+    double* sumw = tally.sumw;
+    double* sumw2 = tally.sumw2;
+    
+    fill_vector(counts, "Generated events \t", nStage[cutGenerated],
+        sumw[cutGenerated], sumw2[cutGenerated]);
+    fill_vector(counts, ">1 lep. kin. cuts\t", nStage[cutKinematic],
+        sumw[cutKinematic], sumw2[cutKinematic]);
+    fill_vector(counts, ">1 lep. ID. eff.\t", nStage[cutLepID],
+        sumw[cutLepID], sumw2[cutLepID]);
+    fill_vector(counts, ">1 lep. Iso. eff.\t", nStage[cutLepIso],
+        sumw[cutLepIso], sumw2[cutLepIso]);
+    fill_vector(counts, ">1 bjets tagged \t", nStage[cutbSelect],
+        sumw[cutbSelect], sumw2[cutbSelect]);
+    fill_vector(counts, "at least two leptons \t", nStage[cutDilepton],
+        sumw[cutDilepton], sumw2[cutDilepton]);
+    fill_vector(counts, "triggered two leptons \t", nStage[cutDilepTrig],
+        sumw[cutDilepTrig], sumw2[cutDilepTrig]);
+    fill_vector(counts, "same sign dileptons \t", nStage[cutSS2L],
+        sumw[cutSS2L], sumw2[cutSS2L]);
     
     // The following cuts depend on the signal region, so we have to
     //  "dynamically" generate their labels
     
     stringstream nJetComment;
-    nJetComment << "at least " << signal_region[iSR].minJets << " jets \t";
-    fill_vector(counts, nJetComment.str(), nJets);
+    nJetComment << "at least " << region.minJets << " jets \t";
+    fill_vector(counts, nJetComment.str(), nStage[cutJets],
+        sumw[cutJets], sumw2[cutJets]);
     
     stringstream nbJetComment;
-    nbJetComment << "at least " << signal_region[iSR].minbJets << " b jets \t";
-    fill_vector(counts, nbJetComment.str(), nbJets);
+    nbJetComment << "at least " << region.minbJets << " b jets \t";
+    fill_vector(counts, nbJetComment.str(), nStage[cutbJets],
+        sumw[cutbJets], sumw2[cutbJets]);
     
     stringstream nMETComment;
-    nMETComment << "at least " << signal_region[iSR].minMET << " GeV MET \t";
-    fill_vector(counts, nMETComment.str(), nMET);
+    nMETComment << "at least " << region.minMET << " GeV MET \t";
+    fill_vector(counts, nMETComment.str(), nStage[cutMET],
+        sumw[cutMET], sumw2[cutMET]);
     
     stringstream HTComment;
-    HTComment << "at least " << signal_region[iSR].minHT << " GeV HT \t";
-    fill_vector(counts, HTComment.str(), nHT);
+    HTComment << "at least " << region.minHT << " GeV HT \t";
+    fill_vector(counts, HTComment.str(), nStage[cutHT],
+        sumw[cutHT], sumw2[cutHT]);
     
     stringstream nChargeComment;
-    if ( signal_region[iSR].minusminus && !signal_region[iSR].plusplus)
+    if ( region.minusminus && !region.plusplus)
         nChargeComment << "only -- leptons \t";
-    else if ( !signal_region[iSR].minusminus && signal_region[iSR].plusplus)
+    else if ( !region.minusminus && region.plusplus)
         nChargeComment << "only ++ leptons \t";
-    else if ( signal_region[iSR].minusminus && signal_region[iSR].plusplus)
+    else if ( region.minusminus && region.plusplus)
         nChargeComment << "either ++ or -- leptons";
     else nChargeComment << "You fucked up, neither ++ or -- leptons ";
     
-    fill_vector(counts, nChargeComment.str(), nCharge);
+    fill_vector(counts, nChargeComment.str(), nStage[cutCharge],
+        sumw[cutCharge], sumw2[cutCharge]);
+} // end fill_counts
+
+
+
+void need_process(eventobjects& objects){
+    if (objects.haveProcess) return;
+    
+    objects.METvec = fastjet::PseudoJet(0.0, 0.0, 0.0, 0.0);
+    grabProcess(*objects.process, objects.METvec, objects.partons, 
+        objects.bpartons);
+    apply_chain<jetchain>(objects.partons, 0, objects.random);
+    objects.nbPartons = objects.bpartons.size();
+    objects.haveProcess = true;
+} // end need_process
+
+
+
+int apply_unit(int unit, eventobjects& objects, signalregion& region){
+    // One unit of the cut chain. The units are listed in FlipApplyCuts.h;
+    // apart from the dependencies in cut_dependency they can go in any order.
+    
+    vector< pair<int, fastjet::PseudoJet> >& leptons = objects.leptons;
+    vector< pair<int, fastjet::PseudoJet> >& partons = objects.partons;
+    vector< pair<int, fastjet::PseudoJet> >& bpartons = objects.bpartons;
+    objects.unitsApplied |= 1u << unit;
+    
+    // Everything but the leptons comes from pythia.process
+    if (unit != unitLeptons && unit != unitSign && unit != unitCharge)
+        need_process(objects);
     
+    switch (unit){
     
-    // DEBUGGING
-    // debug.close();
+    case unitLeptons: {
+        // Kinematic cuts and ID efficiency in one pass (FlipCutChain.h),
+        // then the isolation efficiency. For the histograms, the two 
+        // hardest leptons after each stage (the kinematic cuts don't draw
+        // random numbers, so they can be tried first) and the isolated cones
+        if (objects.keepStages){
+            leading_pT(leptons, false, objects.lep1pT[cutGenerated], 
+                objects.lep2pT[cutGenerated]);
+            leading_pT(leptons, true, objects.lep1pT[cutKinematic], 
+                objects.lep2pT[cutKinematic]);
+        }
+        int survivors[leptonchain::nStages];
+        apply_chain<leptonchain>(leptons, survivors, objects.random);
+        if (survivors[0] < 2) return cutKinematic;
+        if (survivors[1] < 2) return cutLepID;
+        if (objects.keepStages) leading_pT(leptons, false, 
+            objects.lep1pT[cutLepID], objects.lep2pT[cutLepID]);
+        
+        objects.coneSums = hadron_cone_pT(*objects.event, leptons);
+        if (objects.keepStages)
+            for (unsigned int iLep = 0; iLep < leptons.size(); iLep++)
+                if (lepton_iso_eff(iLep, leptons, objects.coneSums[iLep]))
+                    objects.isoConeSums.push_back(objects.coneSums[iLep]);
+        leptons = apply_iso(leptons, objects.coneSums);
+        if (leptons.size() < 2) return cutLepIso;
         
-    return nPassed; 
+        // Order leptons by pT: do this AFTER isolation since we re-order
+        sort (leptons.begin(), leptons.end(), pTordered);
+        if (objects.keepStages){
+            objects.lep1pT[cutLepIso] = leptons[0].second.pt();
+            objects.lep2pT[cutLepIso] = leptons[1].second.pt();
+        }
+        return nCutStages;
+    }
     
+    case unitbTag:
+        apply_chain<bchain>(bpartons, 0, objects.random);
+        if (bpartons.size() < 2) return cutbSelect;
+        return nCutStages;
     
-} // end void signal_efficiency(...)
+    case unitSign:
+        if (leptons.size() < 2) return cutDilepton;
+        if (!lepton_trig_efficiency(leptons, objects.random)) 
+            return cutDilepTrig;
+        
+        // Same-sign dileptons
+        // Note: assuming that you're only looking at two hardest leptons
+        if (leptons[0].first/abs(leptons[0].first) != 
+            leptons[1].first/abs(leptons[1].first)) return cutSS2L;
+        return nCutStages;
+    
+    // Signal region cuts: from input
+    // ------------------------------
+    
+    case unitJets:
+        if (partons.size() < region.minJets) return cutJets;
+        return nCutStages;
+    
+    case unitbJets:
+        if (bpartons.size() < region.minbJets) return cutbJets;
+        return nCutStages;
+    
+    case unitMET:
+        if (!METefficiency(objects.METvec.pt(), region.minMET, objects.random,
+            objects.uMET)) return cutMET;
+        return nCutStages;
+    
+    case unitHT: {
+        double HT (0.0);
+        for(unsigned int iPar = 0; iPar < partons.size(); iPar++){
+            HT += partons[iPar].second.pt();
+        } // end for loop over partons
+        if (!HTefficiency(HT, region.minHT, objects.random, objects.uHT)) 
+            return cutHT;
+        return nCutStages;
+    }
+    
+    case unitCharge: {
+        bool minmin = (leptons[0].first > 0) && region.minusminus;
+        bool pluplu = (leptons[0].first < 0) && region.plusplus;
+        if (!(minmin || pluplu)) return cutCharge;
+        return nCutStages;
+    }
+    
+    } // end switch over units
+    
+    cout << endl << "ERROR: apply_unit, no unit " << unit << endl;
+    return cutGenerated;
+} // end apply_unit
 
 
 
+vector<int> tune_cut_order(cutprofile& profile){
+    // For independent filters, the expected cost is smallest when they are
+    // sorted by cost / (1 - pass rate). We pick greedily among the units 
+    // whose dependency has already been placed.
+    
+    double rank[nCutUnits];
+    for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+        double cost = 0.0;
+        double rate = 1.0;
+        if (profile.nTried[iUnit] > 0){
+            cost = max(profile.cost[iUnit], 0.0) / profile.nTried[iUnit];
+            rate = double(profile.nPassed[iUnit]) / profile.nTried[iUnit];
+        }
+        if (rate < 1.0) rank[iUnit] = cost / (1.0 - rate);
+        else rank[iUnit] = 1.0e30;          // never rejects: put it last
+    } // end loop over units
+    
+    vector<int> order;
+    bool placed[nCutUnits];
+    for (int iUnit = 0; iUnit < nCutUnits; iUnit++) placed[iUnit] = false;
+    
+    for (int iPlace = 0; iPlace < nCutUnits; iPlace++){
+        int best = -1;
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+            if (placed[iUnit]) continue;
+            if (cut_dependency[iUnit] >= 0 && !placed[cut_dependency[iUnit]])
+                continue;
+            if (best < 0 || rank[iUnit] < rank[best]) best = iUnit;
+        } // end loop over units
+        placed[best] = true;
+        order.push_back(best);
+    } // end loop over places
+    
+    return order;
+} // end tune_cut_order
 
-// HELPER FUNCTIONS
 
 
-void grabEvent(Pythia8::Event& event,           // Pythia.event
-    vector< pair<int,fastjet::PseudoJet> >& leptons,    // leptons
-    vector< pair<int,fastjet::PseudoJet> >& hadrons     // hadrons
+void count_first_failures(cutorder& order){
+    // The profiled events as the tuned order would have cut them
+    
+    for (int iEvent = 0; iEvent < order.nProfiled; iEvent++){
+        int* failedAt = &order.profiledFailed[iEvent * nCutUnits];
+        for (unsigned int iUnit = 0; iUnit < order.order.size(); iUnit++){
+            int tStage = failedAt[order.order[iUnit]];
+            if (tStage == nCutStages) continue;
+            order.nShare[tStage][order.profiledReached[iEvent]]++;
+            break;
+        } // end loop over units
+    } // end loop over profiled events
+    
+    order.profiledFailed.clear();
+    order.profiledReached.clear();
+} // end count_first_failures
+
+
+
+bool write_profile(string filename, cutprofile& profile){
+    ofstream outstream(filename.c_str());
+    if (!outstream.is_open()) return false;
+    
+    outstream << "# unit\ttried\tpassed\tseconds" << endl;
+    outstream.precision(12);
+    for (int iUnit = 0; iUnit < nCutUnits; iUnit++)
+        outstream << cut_unit_name[iUnit] << "\t" << profile.nTried[iUnit] 
+            << "\t" << profile.nPassed[iUnit] << "\t" << profile.cost[iUnit]
+            << endl;
+    outstream.close();
+    return true;
+} // end write_profile
+
+
+
+bool read_profile(string filename, cutprofile& profile){
+    ifstream instream(filename.c_str());
+    if (!instream.is_open()) return false;
+    
+    profile = cutprofile();
+    int nFound = 0;
+    string line;
+    while (getline(instream, line)){
+        if (line.empty() || line[0] == '#') continue;
+        stringstream linestream(line);
+        string name;
+        int nTried, nPassed;
+        double seconds;
+        if (!(linestream >> name >> nTried >> nPassed >> seconds)) continue;
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+            if (name != cut_unit_name[iUnit]) continue;
+            profile.nTried[iUnit]   = nTried;
+            profile.nPassed[iUnit]  = nPassed;
+            profile.cost[iUnit]     = seconds;
+            nFound++;
+        }
+    } // end loop over lines
+    
+    instream.close();
+    return nFound == nCutUnits;
+} // end read_profile
+
+
+
+void grabLeptons(Pythia8::Event& event,         // Pythia.event
+    vector< pair<int,fastjet::PseudoJet> >& leptons     // leptons
     ){
         
     for (int iPart = 0; iPart < event.size(); iPart++){
             
-        // Skip things that we can't see
-        // -----------------------------
+        // Only visible final state leptons
+        // --------------------------------
         if (!event[iPart].isFinal()) continue;
-        if (!event[iPart].isVisible()) continue;   
+        if ( !isLepton( event[iPart].id() ) ) continue;
         if (abs(event[iPart].eta()) >= 5.0) continue;
                     
-        // Save particle 4-momentum and negative contribution to MET
-        // ---------------------------------------------------------
+        // Save PDG code and 4-momentum
+        // ----------------------------
         fastjet::PseudoJet momentum(event[iPart].px(),
                                     event[iPart].py(),
                                     event[iPart].pz(),
                                     event[iPart].e());
         
-        
-        // Keep track of leptons
-        // ---------------------
-        if ( isLepton( event[iPart].id() ) ) {
-        
-            pair<int,fastjet::PseudoJet> cur_lept;
-            cur_lept.first = event[iPart].id();     // PDG code
-            cur_lept.second = momentum;             // 4-vector
-            leptons.push_back(cur_lept);         // put in list
-            continue;
-            
-        } // End "if this is an identfiable lepton"  
-        
-        // Leftover objects are non-leptonic, i.e. hadrons
-        pair<int,fastjet::PseudoJet> cur_hadron;
-        cur_hadron.first = event[iPart].id();     // PDG code
-        cur_hadron.second = momentum;             // 4-vector
-        hadrons.push_back(cur_hadron);
+        pair<int,fastjet::PseudoJet> cur_lept;
+        cur_lept.first = event[iPart].id();     // PDG code
+        cur_lept.second = momentum;             // 4-vector
+        leptons.push_back(cur_lept);            // put in list
         
         } // End loop through event particles
         
@@ -15,12 +15,295 @@
 #include <iomanip>                          // for setting precision?
 #include <fstream>                          // for file in/out
 #include "FlipCuts.h"                       // for cut/efficiency tools
+#include "FlipCutChain.h"                   // for one pass object cuts
+#include "FlipStatus.h"                     // for live progress records
+#include "FlipVeto.h"                       // for the parton level veto
+#include "FlipWeights.h"                    // for forced decay weights
+#include "FlipHistograms.h"                 // for cut stage histograms
+#include "FlipLimit.h"                      // for the early stop
+#include "FlipEvents.h"                     // for per-event records
 using namespace std;
 
-int recast(Pythia8::Pythia&, vector< pair<string, int> >&, int, int);
+// CUTFLOW STAGES
+// --------------
+// The rows of the cutflow (the counts vector), in the order they're reported
+enum cutstage { cutGenerated, cutKinematic, cutLepID, cutLepIso, cutbSelect, 
+    cutDilepton, cutDilepTrig, cutSS2L, cutJets, cutbJets, cutMET, cutHT, 
+    cutCharge, nCutStages };
+
+// CUT UNITS
+// ---------
+// The cuts are applied in units: stages that have to go together, e.g. the
+// lepton ID has to come after the lepton kinematic cuts. Listed in canonical
+// order, i.e. the order of the stages in the cutflow. A unit can only be 
+// applied after the unit in cut_dependency (-1: none).
+enum cutunit { unitLeptons, unitbTag, unitSign, unitJets, unitbJets, unitMET,
+    unitHT, unitCharge, nCutUnits };
+const int cut_dependency[nCutUnits] = 
+    { -1, -1, unitLeptons, -1, unitbTag, -1, -1, unitLeptons };
+const char* const cut_unit_name[nCutUnits] = 
+    { "leptons", "btag", "sign", "jets", "bjets", "MET", "HT", "charge" };
+// The stages of unit u are unit_first_stage[u] ... unit_first_stage[u+1]-1
+const int unit_first_stage[nCutUnits+1] = { cutKinematic, cutbSelect, 
+    cutDilepton, cutJets, cutbJets, cutMET, cutHT, cutCharge, nCutStages };
+
+struct eventobjects{
+    // what the cut units work on, for one event
+    vector< pair<int,fastjet::PseudoJet> > leptons;     // leptons
+    vector< pair<int,fastjet::PseudoJet> > partons;     // partons (jet cuts)
+    vector< pair<int,fastjet::PseudoJet> > bpartons;    // b quarks (parton)
+    fastjet::PseudoJet METvec;                          // generator level MET
+    vector<double> coneSums;        // hadronic pT in each isolation cone
+    bool keepStages;                // for the histograms, keep ...
+    double lep1pT[cutbSelect];      // ... the leading ...
+    double lep2pT[cutbSelect];      // ... and subleading lepton pT after
+                                    //  each lepton stage (0: none), and
+    vector<double> isoConeSums;     // ... the coneSums of isolated leptons
+    int nbPartons;                  // # b quarks before tagging
+    Pythia8::Event* event;          // pythia.event, for the isolation cones
+    Pythia8::Event* process;        // pythia.process, for partons and MET
+    bool haveProcess;               // partons, bpartons, METvec are filled
+    bool tunedStop;                 // cut_event stopped ahead of the 
+                                    //  canonical order, see tally_event
+    unsigned int unitsApplied;      // bit u: unit u has been applied
+    unsigned int stagesPassed;      // bit s: stage s was checked and passed
+    uint64_t* random;               // state for the efficiencies (null: 
+                                    //  rand()), see efficiency_random
+    double uMET;                    // the numbers for the MET and HT turn
+    double uHT;                     //  on curves (< 0: drawn), see 
+                                    //  record_event
+};
+
+struct cutprofile{
+    // measured cost and rejection of each unit, see tune_cut_order
+    double cost[nCutUnits];         // total time spent in the unit
+    int nTried[nCutUnits];          // # events the unit was applied to
+    int nPassed[nCutUnits];         // # events that passed the unit
+    double clockCost;               // time to read the clock, taken off
+    cutprofile() : clockCost(0.0) {
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+            cost[iUnit] = 0.0;
+            nTried[iUnit] = 0;
+            nPassed[iUnit] = 0;
+        }
+    }
+};
+
+struct cutorder{
+    // the order in which the units are applied, see RPVg:tuneCuts
+    vector<int> order;              // units, canonical order until tuned
+    cutprofile profile;             // measured on the first nProfile events
+    int nProfile;                   // # events to measure (0: don't tune)
+    int nProfiled;                  // # events measured so far
+    bool verbose;                   // print the order once it's tuned
+    bool timeApplied;               // time every unit that is applied ...
+    cutprofile applied;             // ... in here, see RPVg:profileFile
+    vector<int> profiledFailed;     // per profiled event and unit: stage it
+                                    //  failed (nCutStages: passed or not
+                                    //  tried) ...
+    vector<int> profiledReached;    // ... and the event's first failure
+    int nShare[nCutStages][nCutStages]; // # profiled events that fail stage
+                                    //  t first in the tuned order and stage
+                                    //  r first in canonical order, [t][r]
+    cutorder(int profileEvents = 0, bool talk = true) : 
+        nProfile(profileEvents), nProfiled(0), verbose(talk), 
+        timeApplied(false) {
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++) order.push_back(iUnit);
+        for (int iStage = 0; iStage < nCutStages; iStage++)
+            for (int jStage = 0; jStage < nCutStages; jStage++)
+                nShare[iStage][jStage] = 0;
+    }
+};
+
+struct cuttally{
+    // what ends up in the counts vector: # events and their weights
+    int nStage[nCutStages];         // # events that passed each stage
+    double sumw[nCutStages];        // sum of their weights
+    double sumw2[nCutStages];       // ... and of their squares
+    int nPassed;                    // # events that passed everything
+    double sumwPassed;              // ... and the sum of their weights
+    int nTuned[nCutStages];         // # events that failed this stage in a
+                                    //  tuned order, rows still to estimate
+    double sumwTuned[nCutStages];   // ... sum of their weights
+    double sumw2Tuned[nCutStages];  // ... and of their squares
+    cuttally() : nPassed(0), sumwPassed(0.0) {
+        for (int iStage = 0; iStage < nCutStages; iStage++){
+            nStage[iStage] = 0;
+            sumw[iStage] = 0.0;
+            sumw2[iStage] = 0.0;
+            nTuned[iStage] = 0;
+            sumwTuned[iStage] = 0.0;
+            sumw2Tuned[iStage] = 0.0;
+        }
+    }
+};
+
+
+struct recastextras{
+    // Optional inputs for recast; leave out (null) what you don't use
+    runstatus* status;              // progress record, updated as we go
+    PartonVeto* veto;               // parton level veto given to pythia
+    vector<decaytable>* decays;     // forced decays to reweight
+    histogramset* histograms;       // filled at every stage the event passed
+    limittest* limit;               // stop once the point is decided
+    topologytally* topologies;      // sums per decay topology (FlipEffMap.h)
+    replicatally* replicas;         // bootstrap replicas (FlipBootstrap.h),
+                                    //  initialized; added to, like the rest
+    eventwriter* events;            // per-event records (FlipEvents.h), open
+    recastextras() : status(0), veto(0), decays(0), histograms(0), limit(0),
+        topologies(0), replicas(0), events(0) {}
+};
+
+double recast(Pythia8::Pythia&, vector<cutcount>&, int, int, 
+    const recastextras& = recastextras());
     // This is our main workhorse, it's defined in FlipApplyCuts.cpp
-    // Inputs: pythia object, count vector, signal region index, # event
-    // Output: number of events that pass the cuts
+    // Inputs: pythia object, count vector, signal region index, # event,
+    //  optional extras (see above)
+    // Output: weighted number of events that pass the cuts, i.e. the sum 
+    //  of their event weights: forced decay weight times Pythia's weight 
+    //  (see event_weight in FlipWeights.h). The number of events if there
+    //  are no forced decays and no biased sampling.
+    //
+    // Note: vetoed events only show up in the first row of the cutflow. 
+    //  They might have passed some of the lepton cuts before being vetoed 
+    //  for their b partons or jets; the last row is exact either way.
+
+void addRecastSettings(Pythia8::Pythia&);
+    // Declares our own "RPVg:..." settings in the Pythia settings database
+    // so that they can be set in the command file like any other setting.
+    // Call this BEFORE pythia.readFile(). Current settings:
+    //  RPVg:status         (flag, on)  publish a live status record
+    //  RPVg:statusDir      (word)      node-local directory for the records
+    //  RPVg:statusInterval (parm, 10)  seconds between updates
+    //  RPVg:shardIndex     (mode, 0)   this run is shard k ...
+    //  RPVg:shardCount     (mode, 1)   ... of K shards of the point
+    //  RPVg:seed           (mode, 0)   base seed, 0 = time-based
+    //  RPVg:writeCutflow   (flag, off) save cutflow even if not sharded
+    //  RPVg:partonVeto     (flag, off) veto hopeless events before shower
+    //  RPVg:decayBias      (flag, off) bias the W decays towards e, mu ...
+    //  RPVg:decayBiasFactor (parm, 0.2) ... by suppressing W -> tau by this
+    //  RPVg:tuneCuts       (flag, off) reorder the cut units by cost ...
+    //  RPVg:tuneEvents     (mode, 2000) ... measured on this many events;
+    //                                  the rows between the first and the
+    //                                  last are then estimated, see 
+    //                                  tune_cut_order
+    //  RPVg:profileFile    (word, "")  time every unit the plain loop (no
+    //                                  threads or batches; with workers, 
+    //                                  worker 0) applies and write the 
+    //                                  times here, see write_profile
+    //  RPVg:analysisThreads (mode, 0)  > 0: pipelined, see FlipPipeline.h
+    //  RPVg:generators     (mode, 1)   # generators when pipelined, the
+    //                                  extra ones forked ...
+    //  RPVg:ringSize       (mode, 64)  # events in flight when pipelined
+    //  RPVg:batchSize      (mode, 8)   # events an analysis thread takes
+    //  RPVg:sharedParticles (mode, 4000) ... room for this many particles
+    //                                  per event, see FlipPipeline.h
+    //  RPVg:workers        (mode, 1)   > 1: fork this many worker processes
+    //                                  after init, see FlipWorkers.h
+    //  RPVg:batchEvents    (mode, 0)   > 0: cut blocks of this many events
+    //                                  at once, see FlipBatch.h
+    //  RPVg:histograms     (flag, off) histograms at each stage, see 
+    //                                  FlipHistograms.h
+    //  RPVg:targetPrecision (parm, 0)  > 0: more events until the relative 
+    //                                  error of the result is below this ...
+    //  RPVg:maxEvents      (mode, 1000000) ... or until this many events
+    //  RPVg:cache          (flag, on)  reuse results of RPVg:seed runs ...
+    //  RPVg:cacheDir       (word)      ... stored in this directory ...
+    //  RPVg:cacheMaxEntries (mode, 10000) ... up to this many
+    //  RPVg:cacheRefresh   (flag, off) recompute even if cached
+    //  RPVg:cacheUnseeded  (flag, off) also cache time-seeded runs
+    //  RPVg:earlyStop      (flag, off) stop once the point is excluded or
+    //                                  allowed, see FlipLimit.h ...
+    //  RPVg:upperLimits    (word)      ... # signal events, one per SR ...
+    //  RPVg:luminosity     (parm, 10.5) ... for this many fb^-1 ...
+    //  RPVg:stopConfidence (parm, 0.95) ... at this confidence ...
+    //  RPVg:stopFirstLook  (mode, 1000) ... first checked after this many
+    //  RPVg:effMap         (flag, off) add the run to an efficiency map ...
+    //  RPVg:effMapFile     (word)      ... in this file, see FlipEffMap.h
+    //  RPVg:bootstrap      (mode, 0)   > 0: # bootstrap replicas for the
+    //                                  errors, see FlipBootstrap.h
+    //  RPVg:timing         (flag, off) append the run time of the point ...
+    //  RPVg:timingFile     (word)      ... to this file, see FlipSchedule.h
+    //  RPVg:eventRecord    (flag, off) write a record of every event, see
+    //                                  FlipEvents.h
+
+int cut_event(eventobjects&, signalregion&, cutorder&);
+    // Inputs: event objects (leptons grabbed), signal region, unit order
+    // Output: first cutflow stage that the event fails, nCutStages if none
+    // While the order is being tuned, this applies every unit whose 
+    //  dependency passed and times it. After that it stops at the first 
+    //  unit that fails in the tuned order: if that is ahead of the unit's
+    //  canonical place, the stage returned is the one it failed there and
+    //  objects.tunedStop is set (the first failure in canonical order can
+    //  be earlier). Sets objects.stagesPassed.
+
+void tally_event(cuttally&, int, double, bool = false);
+    // Inputs: tally, stage returned by cut_event, event weight, 
+    //  objects.tunedStop
+    // The event counts for every stage before the one it failed. Stopped
+    //  in a tuned order, it only counts as generated: the other rows are
+    //  filled in by estimate_rows
+
+void estimate_rows(cuttally&, cutorder&);
+    // Inputs: tally, the order it was cut in
+    // Adds the events that stopped in the tuned order to the rows of the 
+    //  cutflow, shared out like the profiled events that failed the same
+    //  stage first in the tuned order. Call before fill_counts/add_tally
+
+void add_tally(cuttally&, cuttally&);
+    // Adds the second tally to the first
+
+void fill_event_histograms(histogramset&, eventobjects&, int, double);
+    // Inputs: histograms (nCutStages stages), event objects after cut_event
+    //  (with keepStages set before it), stage returned by cut_event, event
+    //  weight
+    // Each stage the event passed gets the objects as they were after that
+    //  stage. Reads pythia.process if no cut needed it yet
+
+void record_event(eventwriter&, eventobjects&, vector<signalregion>&, int,
+    int, double);
+    // Inputs: open record file, event objects after cut_event (with uMET
+    //  and uHT drawn from the file's stream before it), all SRs, the run's
+    //  SR, stage returned by cut_event, event weight
+    // Works out which SRs the event passes and writes its record, see
+    //  FlipEvents.h. Applies no cuts of its own.
+
+void fill_counts(vector<cutcount>&, cuttally&, signalregion&);
+    // Appends the rows of the cutflow, with labels, to the counts vector
+
+void need_process(eventobjects&);
+    // Fills partons (after the jet kinematic cuts), bpartons and METvec 
+    // from pythia.process, unless that was done already
+
+int apply_unit(int, eventobjects&, signalregion&);
+    // Inputs: unit (see cutunit above), event objects, signal region
+    // Output: first cutflow stage that the event fails, nCutStages if none
+
+vector<int> tune_cut_order(cutprofile&);
+    // Output: the order of the units with the smallest expected cost
+    //
+    // Note: the trade-off of RPVg:tuneCuts. An event is cut until the first
+    //  unit that fails in the tuned order and no further, which is what 
+    //  makes it cheaper. Exact are the 'Generated' row and the last row 
+    //  (the events that pass everything pass every unit, in any order), so
+    //  the result, its error and the early stop are as without tuning. The
+    //  rows in between are estimates: an event that failed ahead of the 
+    //  canonical order is shared out over them like the profiled events 
+    //  (exact, every unit applied) that failed the same stage first, see 
+    //  estimate_rows, so their error comes from the tuneEvents profiled 
+    //  events rather than from the whole run. Histograms, bootstrap replicas and event records need
+    //  the stage of every event, so they switch the tuning off.
+
+void count_first_failures(cutorder&);
+    // Fills order.nShare from the profiled events, for the tuned order
+
+bool write_profile(string, cutprofile&);
+    // Writes the profile to the file, one line per unit:
+    //  unit  # tried  # passed  seconds (total)
+    // Output: TRUE if the file was written
+
+bool read_profile(string, cutprofile&);
+    // Reads a file written by write_profile; TRUE if every unit was there
 
 // Eventually we'll want to have different kinds of functions
 // E.g. for doing substructure, etc.
@@ -28,10 +311,15 @@ int recast(Pythia8::Pythia&, vector< pair<string, int> >&, int, int);
 
 // HELPER FUNCTIONS
 
-void grabEvent(Pythia8::Event&,                 // Pythia.event
-    vector< pair<int,fastjet::PseudoJet> >&,    // leptons
-    vector< pair<int,fastjet::PseudoJet> >&     // hadrons
+double clock_cost();
+// The time one reading of monotonic() (FlipStatus.h) takes, in seconds; 
+// taken off the times of the cut units
+
+void grabLeptons(Pythia8::Event&,               // Pythia.event
+    vector< pair<int,fastjet::PseudoJet> >&     // leptons
     );
+// Only the leptons: the hadrons are only needed for isolation, and for that
+// we just need the pT in each lepton cone, see hadron_cone_pT in FlipCuts.
 
 void grabProcess(Pythia8::Event&,   // Pythia.process
     fastjet::PseudoJet&,            // METvec
@@ -0,0 +1,441 @@
+/********************************************************************************
+*   FlipBatch.cpp                                                               *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the batched cuts, see FlipBatch.h                                  *
+*                                                                               *
+*   Every stage is the same pattern: a loop over the objects of the whole      *
+*   block (draw random numbers, compare with the efficiencies), then a loop    *
+*   over the events that counts what's left and kills the events that don't   *
+*   have enough. A dead event's objects are left as they were when it died,    *
+*   so that the histograms see what recast would have seen.                    *
+********************************************************************************/
+
+#include "FlipBatch.h"
+
+
+
+void init_batch(eventbatch& batch, int capacity){
+    batch.capacity = capacity;
+    batch.nEvents = 0;
+
+    batch.weight.reserve(capacity);
+    batch.topology.reserve(capacity);
+    batch.MET.reserve(capacity);
+    batch.HT.reserve(capacity);
+    batch.nJets.reserve(capacity);
+    batch.nbPartons.reserve(capacity);
+    batch.lepFirst.reserve(capacity);
+    batch.lepCount.reserve(capacity);
+    batch.bFirst.reserve(capacity);
+    batch.bCount.reserve(capacity);
+
+    // A handful of leptons and b quarks per event is plenty to start with
+    batch.lepEvent.reserve(4*capacity);
+    batch.lepID.reserve(4*capacity);
+    batch.lepPt.reserve(4*capacity);
+    batch.lepEta.reserve(4*capacity);
+    batch.lepPhi.reserve(4*capacity);
+    batch.lepCone.reserve(4*capacity);
+    batch.bEvent.reserve(4*capacity);
+    batch.bPt.reserve(4*capacity);
+} // end init_batch
+
+
+
+void clear_batch(eventbatch& batch){
+    // clear() keeps the capacity of the vectors
+
+    batch.nEvents = 0;
+    batch.weight.clear();
+    batch.topology.clear();
+    batch.MET.clear();
+    batch.HT.clear();
+    batch.nJets.clear();
+    batch.nbPartons.clear();
+    batch.lepFirst.clear();
+    batch.lepCount.clear();
+    batch.bFirst.clear();
+    batch.bCount.clear();
+    batch.lepEvent.clear();
+    batch.lepID.clear();
+    batch.lepPt.clear();
+    batch.lepEta.clear();
+    batch.lepPhi.clear();
+    batch.lepCone.clear();
+    batch.bEvent.clear();
+    batch.bPt.clear();
+} // end clear_batch
+
+
+
+bool batch_full(eventbatch& batch){
+    return batch.nEvents >= batch.capacity;
+} // end batch_full
+
+
+
+void add_to_batch(eventbatch& batch,
+    vector< pair<int,fastjet::PseudoJet> >& leptons,
+    Pythia8::Event* event, Pythia8::Event& process, double weight,
+    int topology){
+    // The same objects as need_process and the lepton unit use
+
+    int iEvent = batch.nEvents++;
+    batch.weight.push_back(weight);
+    batch.topology.push_back(topology);
+
+    // Leptons, with their hadronic cone sums. Without two leptons the
+    // lepton unit fails before it looks at the cones.
+    vector<double> cone;
+    if (leptons.size() >= 2 && event) cone = hadron_cone_pT(*event, leptons);
+    else cone.assign(leptons.size(), 0.0);
+
+    batch.lepFirst.push_back(batch.lepEvent.size());
+    batch.lepCount.push_back(leptons.size());
+    for (unsigned int iLep = 0; iLep < leptons.size(); iLep++){
+        batch.lepEvent.push_back(iEvent);
+        batch.lepID.push_back(leptons[iLep].first);
+        batch.lepPt.push_back(leptons[iLep].second.pt());
+        batch.lepEta.push_back(leptons[iLep].second.eta());
+        batch.lepPhi.push_back(leptons[iLep].second.phi());
+        batch.lepCone.push_back(cone[iLep]);
+    } // end loop over leptons
+
+    // Partons, b quarks and MET from pythia.process
+    fastjet::PseudoJet METvec(0.0, 0.0, 0.0, 0.0);
+    vector< pair<int,fastjet::PseudoJet> > partons, bpartons;
+    grabProcess(process, METvec, partons, bpartons);
+    apply_chain<jetchain>(partons);
+
+    double HT = 0.0;
+    for (unsigned int iPar = 0; iPar < partons.size(); iPar++)
+        HT += partons[iPar].second.pt();
+    batch.MET.push_back(METvec.pt());
+    batch.HT.push_back(HT);
+    batch.nJets.push_back(partons.size());
+    batch.nbPartons.push_back(bpartons.size());
+
+    batch.bFirst.push_back(batch.bEvent.size());
+    batch.bCount.push_back(bpartons.size());
+    for (unsigned int iB = 0; iB < bpartons.size(); iB++){
+        batch.bEvent.push_back(iEvent);
+        batch.bPt.push_back(bpartons[iB].second.pt());
+    }
+} // end add_to_batch
+
+
+
+void draw_uniform(eventbatch& batch, int nDraw){
+    // Same numbers as the efficiency functions in FlipCuts.cpp draw
+
+    batch.random.resize(nDraw);
+    for (int iDraw = 0; iDraw < nDraw; iDraw++)
+        batch.random[iDraw] = efficiency_random(batch.randomState);
+} // end draw_uniform
+
+
+
+void count_alive(vector<int>& first, vector<int>& nObjects,
+    vector<unsigned char>& objectAlive, vector<int>& count){
+    // # live objects of each event
+
+    int nEvents = first.size();
+    count.resize(nEvents);
+    for (int iEvent = 0; iEvent < nEvents; iEvent++){
+        int n = 0;
+        int last = first[iEvent] + nObjects[iEvent];
+        for (int iObject = first[iEvent]; iObject < last; iObject++)
+            n += objectAlive[iObject];
+        count[iEvent] = n;
+    }
+} // end count_alive
+
+
+
+inline void fail_event(eventbatch& batch, int iEvent, bool failed, int stage){
+    // Kills a live event that failed the stage, without a branch
+    int dies = batch.alive[iEvent] & failed;
+    batch.reached[iEvent] = dies ? stage : batch.reached[iEvent];
+    batch.alive[iEvent] &= !dies;
+} // end fail_event
+
+
+
+void batch_kill(eventbatch& batch, int stage){
+    for (int iEvent = 0; iEvent < batch.nEvents; iEvent++)
+        fail_event(batch, iEvent, batch.count[iEvent] < 2, stage);
+} // end batch_kill
+
+
+
+void batch_lepton_kinematics(eventbatch& batch){
+    // Every event is alive here
+
+    int nLep = batch.lepEvent.size();
+    batch.lepAlive.resize(nLep);
+    for (int iLep = 0; iLep < nLep; iLep++)
+        batch.lepAlive[iLep] = lepton_kinematic_cut(batch.lepID[iLep],
+            batch.lepPt[iLep], batch.lepEta[iLep]);
+
+    count_alive(batch.lepFirst, batch.lepCount, batch.lepAlive, batch.count);
+    batch_kill(batch, cutKinematic);
+} // end batch_lepton_kinematics
+
+
+
+void batch_lepton_ID(eventbatch& batch){
+    // As leptonchain (FlipCutChain.h): every lepton that passed the
+    // kinematic cuts, also in events that didn't have two of them
+
+    int nLep = batch.lepEvent.size();
+    draw_uniform(batch, nLep);
+    for (int iLep = 0; iLep < nLep; iLep++)
+        batch.lepAlive[iLep] &= batch.random[iLep] <
+            lepton_ID_efficiency(batch.lepID[iLep]);
+
+    count_alive(batch.lepFirst, batch.lepCount, batch.lepAlive, batch.count);
+    batch_kill(batch, cutLepID);
+} // end batch_lepton_ID
+
+
+
+void batch_lepton_iso(eventbatch& batch){
+    // As lepton_iso_eff with the hadronic cone precomputed: the cone also
+    // has the other leptons that passed the ID, whether or not they turn
+    // out to be isolated themselves
+
+    double lepton_dR  = 0.3;        // as in lepton_iso_eff
+    double Iiso       = 0.15;
+
+    int nLep = batch.lepEvent.size();
+    batch.lepIsoTried.resize(nLep);
+    for (int iLep = 0; iLep < nLep; iLep++)
+        batch.lepIsoTried[iLep] = batch.lepAlive[iLep] &
+            batch.alive[batch.lepEvent[iLep]];
+
+    vector<unsigned char> isolated(nLep, 0);
+    for (int iEvent = 0; iEvent < batch.nEvents; iEvent++){
+        int first = batch.lepFirst[iEvent];
+        int last = first + batch.lepCount[iEvent];
+        for (int iLep = first; iLep < last; iLep++){
+            double cone = batch.lepCone[iLep];
+            for (int jLep = first; jLep < last; jLep++){
+                double dphi = batch.lepPhi[jLep] - batch.lepPhi[iLep];
+                double deta = batch.lepEta[jLep] - batch.lepEta[iLep];
+                bool inCone = batch.lepIsoTried[jLep] && (jLep != iLep) &&
+                    (sqrt(dphi*dphi + deta*deta) < lepton_dR);
+                cone += inCone ? batch.lepPt[jLep] : 0.0;
+            }
+            isolated[iLep] = cone < Iiso*batch.lepPt[iLep];
+        }
+    } // end loop over events
+
+    for (int iLep = 0; iLep < nLep; iLep++)
+        batch.lepAlive[iLep] = batch.lepIsoTried[iLep] ? isolated[iLep]
+            : batch.lepAlive[iLep];
+
+    count_alive(batch.lepFirst, batch.lepCount, batch.lepAlive, batch.count);
+    batch_kill(batch, cutLepIso);
+
+    // The two hardest leptons left, instead of sorting (see pTordered)
+    batch.lead.assign(batch.nEvents, -1);
+    batch.sublead.assign(batch.nEvents, -1);
+    for (int iEvent = 0; iEvent < batch.nEvents; iEvent++){
+        int first = batch.lepFirst[iEvent];
+        int last = first + batch.lepCount[iEvent];
+        double leadPt = -1.0, subleadPt = -1.0;
+        for (int iLep = first; iLep < last; iLep++){
+            if (!batch.lepAlive[iLep]) continue;
+            double pT = batch.lepPt[iLep];
+            if (pT > leadPt){
+                batch.sublead[iEvent] = batch.lead[iEvent];
+                subleadPt = leadPt;
+                batch.lead[iEvent] = iLep;
+                leadPt = pT;
+            }
+            else if (pT > subleadPt){
+                batch.sublead[iEvent] = iLep;
+                subleadPt = pT;
+            }
+        }
+    } // end loop over events
+} // end batch_lepton_iso
+
+
+
+void batch_btag(eventbatch& batch){
+    int nB = batch.bEvent.size();
+    draw_uniform(batch, nB);
+    batch.bAlive.resize(nB);
+    for (int iB = 0; iB < nB; iB++)
+        batch.bAlive[iB] = batch.random[iB] < b_tag_efficiency(batch.bPt[iB]);
+
+    count_alive(batch.bFirst, batch.bCount, batch.bAlive, batch.nbTagged);
+    batch.count = batch.nbTagged;
+    batch_kill(batch, cutbSelect);
+} // end batch_btag
+
+
+
+void batch_sign(eventbatch& batch){
+    // Trigger and same sign, on the two hardest leptons
+
+    draw_uniform(batch, batch.nEvents);
+    for (int iEvent = 0; iEvent < batch.nEvents; iEvent++){
+        int lead = batch.lead[iEvent];
+        int sublead = batch.sublead[iEvent];
+        bool twoLeptons = (sublead >= 0);
+        fail_event(batch, iEvent, !twoLeptons, cutDilepton);
+        if (!twoLeptons) continue;      // dead, and nothing to look at
+
+        int id1 = batch.lepID[lead];
+        int id2 = batch.lepID[sublead];
+        fail_event(batch, iEvent, !(batch.random[iEvent] <
+            dilepton_trig_efficiency(id1, id2)), cutDilepTrig);
+        fail_event(batch, iEvent, (id1 > 0) != (id2 > 0), cutSS2L);
+    } // end loop over events
+} // end batch_sign
+
+
+
+void batch_region(eventbatch& batch, signalregion& region){
+    // The signal region cuts; the turn on curves are set up once per block
+
+    int nEvents = batch.nEvents;
+    for (int iEvent = 0; iEvent < nEvents; iEvent++){
+        fail_event(batch, iEvent,
+            batch.nJets[iEvent] < int(region.minJets), cutJets);
+        fail_event(batch, iEvent,
+            batch.nbTagged[iEvent] < int(region.minbJets), cutbJets);
+    }
+
+    double x12, sig;
+    if (MET_turnon(region.minMET, x12, sig)){
+        draw_uniform(batch, nEvents);
+        for (int iEvent = 0; iEvent < nEvents; iEvent++){
+            double efficiency = 0.5*(erf((batch.MET[iEvent]-x12)/sig) + 1);
+            fail_event(batch, iEvent, !(batch.random[iEvent] < efficiency),
+                cutMET);
+        }
+    }
+
+    if (HT_turnon(region.minHT, x12, sig)){
+        draw_uniform(batch, nEvents);
+        for (int iEvent = 0; iEvent < nEvents; iEvent++){
+            double efficiency = 0.5*(erf((batch.HT[iEvent]-x12)/sig) + 1);
+            fail_event(batch, iEvent, !(batch.random[iEvent] < efficiency),
+                cutHT);
+        }
+    }
+
+    for (int iEvent = 0; iEvent < nEvents; iEvent++){
+        if (!batch.alive[iEvent]) continue;     // lead might not exist
+        int id = batch.lepID[batch.lead[iEvent]];
+        bool minmin = (id > 0) && region.minusminus;
+        bool pluplu = (id < 0) && region.plusplus;
+        fail_event(batch, iEvent, !(minmin || pluplu), cutCharge);
+    }
+} // end batch_region
+
+
+
+void cut_batch(eventbatch& batch, signalregion& region){
+    // The units of apply_unit, in canonical order
+
+    batch.alive.assign(batch.nEvents, 1);
+    batch.reached.assign(batch.nEvents, nCutStages);
+
+    batch_lepton_kinematics(batch);
+    batch_lepton_ID(batch);
+    batch_lepton_iso(batch);
+    batch_btag(batch);
+    batch_sign(batch);
+    batch_region(batch, region);
+} // end cut_batch
+
+
+
+void batch_leading_pT(eventbatch& batch, int iEvent, int lepStage,
+    double& lep1pT, double& lep2pT){
+    // The two hardest leptons of the event after a lepton stage (0: none),
+    // for the histograms. Only the kinematic cuts have to be tried again.
+
+    lep1pT = 0.0;
+    lep2pT = 0.0;
+    int first = batch.lepFirst[iEvent];
+    int last = first + batch.lepCount[iEvent];
+    for (int iLep = first; iLep < last; iLep++){
+        double pT = batch.lepPt[iLep];
+        bool there = true;
+        if (lepStage == cutKinematic) there = lepton_kinematic_cut(
+            batch.lepID[iLep], pT, batch.lepEta[iLep]);
+        else if (lepStage == cutLepID) there = batch.lepIsoTried[iLep];
+        else if (lepStage == cutLepIso) there = batch.lepAlive[iLep];
+        if (!there) continue;
+        if (pT > lep1pT){
+            lep2pT = lep1pT;
+            lep1pT = pT;
+        }
+        else if (pT > lep2pT) lep2pT = pT;
+    } // end loop over leptons
+} // end batch_leading_pT
+
+
+
+void tally_batch(eventbatch& batch, cuttally& tally,
+    histogramset* histograms, topologytally* topologies,
+    replicatally* replicas){
+
+    for (int iEvent = 0; iEvent < batch.nEvents; iEvent++){
+        int reached = batch.reached[iEvent];
+        double weight = batch.weight[iEvent];
+        tally_event(tally, reached, weight);
+        if (topologies) tally_topology(*topologies, batch.topology[iEvent],
+            reached == nCutStages, weight);
+        if (replicas) tally_replicas(*replicas, reached, weight);
+        if (!histograms) continue;
+
+        // As fill_event_histograms: the objects the event had after each
+        // stage. The leptons that passed the ID are the ones tried for
+        // isolation: an event filled at cutLepID got that far.
+        double lep1pT[cutbSelect], lep2pT[cutbSelect];
+        for (int lepStage = cutGenerated; lepStage < cutbSelect; lepStage++)
+            batch_leading_pT(batch, iEvent, lepStage, lep1pT[lepStage],
+                lep2pT[lepStage]);
+        int first = batch.lepFirst[iEvent];
+        int last = first + batch.lepCount[iEvent];
+
+        double value[nHistVariables];
+        value[histMET]      = batch.MET[iEvent];
+        value[histHT]       = batch.HT[iEvent];
+        value[histnJets]    = batch.nJets[iEvent];
+
+        for (int iStage = 0; iStage < reached; iStage++){
+            int lepStage = min(iStage, (int)cutLepIso);
+            value[histLep1pT]   = lep1pT[lepStage];
+            value[histLep2pT]   = lep2pT[lepStage];
+            value[histnbJets]   = (iStage < cutbSelect) ? 
+                batch.nbPartons[iEvent] : batch.nbTagged[iEvent];
+
+            vector<histogram>& hist = histograms->hist[iStage];
+            for (int iVar = 0; iVar < histConeSum; iVar++)
+                fill_histogram(hist[iVar], value[iVar], weight);
+            if (iStage < cutLepID) continue;
+            for (int iLep = first; iLep < last; iLep++)
+                if (batch.lepIsoTried[iLep] && 
+                    (iStage == cutLepID || batch.lepAlive[iLep]))
+                    fill_histogram(hist[histConeSum], batch.lepCone[iLep], weight);
+        } // end loop over stages
+    } // end loop over events
+} // end tally_batch
+
+
+
+void flush_batch(eventbatch& batch, signalregion& region, cuttally& tally,
+    histogramset* histograms, topologytally* topologies,
+    replicatally* replicas){
+    if (batch.nEvents == 0) return;
+    cut_batch(batch, region);
+    tally_batch(batch, tally, histograms, topologies, replicas);
+    clear_batch(batch);
+} // end flush_batch
@@ -0,0 +1,128 @@
+// FlipBatch.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPBATCH_H_INCLUDED__
+#define __FLIPBATCH_H_INCLUDED__
+
+// Batched cuts: instead of taking one event through the whole cut chain
+// (cut_event), a block of events is extracted into flat arrays (one array
+// per quantity, structure of arrays) and each stage of the cutflow is one
+// loop over the whole block. The loops have no early exits: an event that
+// fails is switched off in the mask rather than branched around, so the
+// arithmetic stages can be vectorized, and each stage only touches the
+// arrays it needs while it runs over the block.
+//
+// Per event: weight, topology, MET, HT, # jets, # b quarks, and where its
+// leptons and b quarks start in the per object arrays (offset, count).
+// Per lepton/b quark: the event it belongs to, its kinematics and an alive
+// flag. The survival mask alive[] and reached[] (the first stage failed,
+// as returned by cut_event) come out at the end and go into the tally.
+//
+// The stages are the ones of apply_unit, in canonical order, with the same
+// efficiencies. The random numbers for a stage are drawn for the whole
+// block first, so the events get different draws than in recast, but the
+// statistics are the same. RPVg:tuneCuts has no effect: every stage runs
+// over the whole block anyway.
+//
+// Settings (see addRecastSettings):
+//  RPVg:batchEvents = 0 cuts one event at a time; > 0 cuts blocks of this
+//  many events, in recast and in the analysis threads of FlipPipeline.h.
+//
+// With the early stop, the point is only looked at between blocks.
+
+#include "FlipApplyCuts.h"          // for the stages, tally, histograms
+#include <vector>
+using namespace std;
+
+struct eventbatch{
+    // a block of events, structure of arrays
+    int capacity;                   // # events in a full block
+    int nEvents;                    // # events in the block so far
+
+    // per event
+    vector<double> weight;          // event weight, see event_weight
+    vector<int> topology;           // decay topology (efficiency maps)
+    vector<double> MET;             // generator level MET
+    vector<double> HT;              // scalar sum of jet (parton) pT
+    vector<int> nJets;              // # partons passing the jet cuts
+    vector<int> nbPartons;          // # b quarks before tagging
+    vector<int> lepFirst;           // offset of the event's leptons ...
+    vector<int> lepCount;           // ... and how many
+    vector<int> bFirst;             // offset of the event's b quarks ...
+    vector<int> bCount;             // ... and how many
+    vector<int> nbTagged;           // # b quarks tagged
+    vector<int> lead;               // leading lepton (-1: none) ...
+    vector<int> sublead;            // ... and subleading
+    vector<unsigned char> alive;    // survival mask
+    vector<int> reached;            // first stage failed (nCutStages: none)
+
+    // per lepton
+    vector<int> lepEvent;           // event the lepton belongs to
+    vector<int> lepID;              // PDG code
+    vector<double> lepPt;
+    vector<double> lepEta;
+    vector<double> lepPhi;          // fastjet convention, 0 ... 2 pi
+    vector<double> lepCone;         // hadronic pT in the isolation cone
+    vector<unsigned char> lepAlive; // still in the event's lepton list
+    vector<unsigned char> lepIsoTried;  // tested for isolation
+
+    // per b quark
+    vector<int> bEvent;             // event the b quark belongs to
+    vector<double> bPt;
+    vector<unsigned char> bAlive;   // tagged
+
+    // scratch
+    vector<double> random;          // uniform random numbers for a stage
+    vector<int> count;              // per event counts for a stage
+    uint64_t* randomState;          // where they come from (null: rand()),
+                                    //  see efficiency_random
+    eventbatch() : capacity(0), nEvents(0), randomState(0) {}
+};
+
+
+void init_batch(eventbatch&, int);
+// Inputs: batch, # events in a full block. Reserves the arrays.
+
+void clear_batch(eventbatch&);
+// Empties the block, keeping the memory
+
+bool batch_full(eventbatch&);
+
+void add_to_batch(eventbatch&, vector< pair<int,fastjet::PseudoJet> >&,
+    Pythia8::Event*, Pythia8::Event&, double, int);
+// Inputs: batch, leptons (from grabLeptons), pythia.event (only looked at
+//  with two or more leptons), pythia.process, event weight, topology
+// Extracts what the cuts need; nothing points back into Pythia afterwards.
+
+void cut_batch(eventbatch&, signalregion&);
+// Runs every stage over the block; fills alive and reached
+
+void tally_batch(eventbatch&, cuttally&, histogramset*, topologytally*,
+    replicatally*);
+// Inputs: batch after cut_batch, tally, histograms, topologies and
+//  bootstrap replicas (or null)
+// Adds every event of the block, like tally_event etc. in recast
+
+void flush_batch(eventbatch&, signalregion&, cuttally&, histogramset*,
+    topologytally*, replicatally*);
+// cut_batch, tally_batch and clear_batch, if the block has any events
+
+
+// THE STAGES
+// ----------
+// Each one only changes events that are still alive, and kills the ones
+// that fail it, setting reached to the stage (see cutstage)
+
+void batch_lepton_kinematics(eventbatch&);      // cutKinematic
+void batch_lepton_ID(eventbatch&);              // cutLepID
+void batch_lepton_iso(eventbatch&);             // cutLepIso, orders leptons
+void batch_btag(eventbatch&);                   // cutbSelect
+void batch_sign(eventbatch&);                   // cutDilepton ... cutSS2L
+void batch_region(eventbatch&, signalregion&);  // cutJets ... cutCharge
+
+void batch_kill(eventbatch&, int);
+// Inputs: batch, stage. Kills the live events whose count is below 2.
+
+
+// END INCLUDE GUARD
+#endif // __FLIPBATCH_H_INCLUDED__
@@ -0,0 +1,148 @@
+/********************************************************************************
+*   FlipBootstrap.cpp                                                           *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the Poisson bootstrap functions, see FlipBootstrap.h              *
+*                                                                               *
+*   The replica weights come from splitmix64, a counter based generator:       *
+*   event n of a stream starts it at stream ^ (n x odd constant), and each    *
+*   replica takes the next number. Same stream and event, same weights.        *
+********************************************************************************/
+
+#include "FlipBootstrap.h"
+#include "FlipCutflow.h"            // for fnv1a
+#include <cmath>                    // for sqrt, exp
+#include <algorithm>                // for sort
+
+
+
+uint64_t splitmix64(uint64_t& state){
+    // http://prng.di.unimi.it/splitmix64.c
+
+    uint64_t z = (state += 0x9E3779B97F4A7C15UL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+    return z ^ (z >> 31);
+} // end splitmix64
+
+
+
+int poisson_one(uint64_t random){
+    // Poisson with mean 1 from 64 random bits: invert the cumulative
+    // distribution, 0.368, 0.736, 0.920, 0.981, ...
+
+    double uniform = (random >> 11) * (1.0 / 9007199254740992.0);  // 2^-53
+    double term = exp(-1.0), cumulative = term;
+    int k = 0;
+    while (uniform >= cumulative && k < 20){
+        k++;
+        term /= k;
+        cumulative += term;
+    }
+    return k;
+} // end poisson_one
+
+
+
+void init_replicas(replicatally& tally, int nReplicas, int nStages,
+    uint64_t stream){
+    tally.nReplicas = nReplicas;
+    tally.nStages   = nStages;
+    tally.stream    = stream;
+    tally.nEvents   = 0;
+    tally.generated.assign(nReplicas, 0.0);
+    tally.sumw.assign(nStages * nReplicas, 0.0);
+} // end init_replicas
+
+
+
+uint64_t replica_stream(uint64_t stream, string what){
+    uint64_t state = fnv1a(what, stream);
+    return splitmix64(state);
+} // end replica_stream
+
+
+
+void tally_replicas(replicatally& tally, int reached, double weight){
+    // The event passed stages 0 ... reached-1 (see tally_event)
+
+    if (tally.nReplicas == 0) return;
+    uint64_t state = tally.stream ^ ((uint64_t)tally.nEvents * 0xD1B54A32D192ED03UL);
+    tally.nEvents++;
+    if (reached > tally.nStages) reached = tally.nStages;
+
+    int nReplicas = tally.nReplicas;
+    for (int iReplica = 0; iReplica < nReplicas; iReplica++){
+        int k = poisson_one(splitmix64(state));
+        if (k == 0) continue;               // not in this replica
+        tally.generated[iReplica] += k;
+        double replicaWeight = k * weight;
+        for (int iStage = 0; iStage < reached; iStage++)
+            tally.sumw[iStage * nReplicas + iReplica] += replicaWeight;
+    } // end loop over replicas
+} // end tally_replicas
+
+
+
+void pack_replicas(replicatally& tally, double* values){
+    for (unsigned int iSum = 0; iSum < tally.generated.size(); iSum++)
+        *values++ = tally.generated[iSum];
+    for (unsigned int iSum = 0; iSum < tally.sumw.size(); iSum++)
+        *values++ = tally.sumw[iSum];
+} // end pack_replicas
+
+
+
+void unpack_replicas(double* values, replicatally& tally){
+    tally.generated.assign(values, values + tally.nReplicas);
+    values += tally.nReplicas;
+    tally.sumw.assign(values, values + tally.nStages * tally.nReplicas);
+} // end unpack_replicas
+
+
+
+bool add_replicas(replicatally& total, replicatally& tally){
+    if (total.nReplicas != tally.nReplicas || total.nStages != tally.nStages){
+        total = replicatally();
+        return false;
+    }
+
+    total.nEvents += tally.nEvents;
+    for (unsigned int iReplica = 0; iReplica < total.generated.size(); iReplica++)
+        total.generated[iReplica] += tally.generated[iReplica];
+    for (unsigned int iSum = 0; iSum < total.sumw.size(); iSum++)
+        total.sumw[iSum] += tally.sumw[iSum];
+    return true;
+} // end add_replicas
+
+
+
+bool replica_spread(replicatally& tally, int iStage, double nGenerated,
+    double& error, double& low, double& high){
+    // Each replica scaled to nGenerated events, then their spread
+
+    error = low = high = 0.0;
+    if (tally.nReplicas < 2 || iStage < 0 || iStage >= tally.nStages)
+        return false;
+
+    vector<double> values;
+    for (int iReplica = 0; iReplica < tally.nReplicas; iReplica++){
+        if (tally.generated[iReplica] <= 0) continue;
+        values.push_back(tally.sumw[iStage * tally.nReplicas + iReplica]
+            * nGenerated / tally.generated[iReplica]);
+    }
+    int nValues = values.size();
+    if (nValues < 2) return false;
+
+    double mean = 0.0, variance = 0.0;
+    for (int iValue = 0; iValue < nValues; iValue++) mean += values[iValue];
+    mean /= nValues;
+    for (int iValue = 0; iValue < nValues; iValue++)
+        variance += (values[iValue] - mean) * (values[iValue] - mean);
+    error = sqrt(variance / (nValues - 1));
+
+    sort(values.begin(), values.end());
+    int iLow = int(0.025 * nValues);        // central 95%
+    low  = values[iLow];
+    high = values[nValues - 1 - iLow];
+    return true;
+} // end replica_spread
@@ -0,0 +1,86 @@
+// FlipBootstrap.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPBOOTSTRAP_H_INCLUDED__
+#define __FLIPBOOTSTRAP_H_INCLUDED__
+
+// Uncertainties from one run: Poisson bootstrap. Every event gets R
+// replica weights, each drawn from a Poisson distribution with mean 1,
+// and each replica keeps its own cutflow, the sums of (replica weight x
+// event weight) at every stage. Replica r is then what another run with
+// the same settings could have given, and the spread of the R replicas is
+// the uncertainty of every row of the cutflow. cut_error (FlipCutflow.h)
+// already gives each row's error on its own; what the replicas add is 
+// that they are the same for every row, so they keep the correlations
+// between the stages (the same events pass every stage up to their last),
+// they don't assume a distribution for weighted events (biased sampling,
+// forced decays), and they give an interval as well as an error.
+//
+// The replica weights are a hash of (stream, event #, replica), not drawn
+// from rand() or Pythia, so switching the bootstrap on doesn't change the
+// result of a seeded run. Each thread, veto and shard has its own stream.
+//
+// Replica r of row i is scaled to the # events actually generated,
+//      sumw_r(i) x N / N_r      N_r = sum of replica r's weights of all
+// generated events (vetoed included), so it's an estimate of the same
+// thing as the row itself. The error is the standard deviation over the
+// replicas, the interval the central 95% of them.
+//
+// Settings (see addRecastSettings):
+//  RPVg:bootstrap = R replicas (0: off; 100 is plenty for an error)
+//
+// The replica sums go into the cutflow record, so shards and the cache
+// carry them (see FlipCutflow.h); output.dat gets three more columns:
+// error, low and high of the result.
+
+#include <string>
+#include <vector>
+#include <stdint.h>                 // for uint64_t
+using namespace std;
+
+struct replicatally{
+    // replica cutflows of one run (or thread, veto, shard)
+    int nReplicas;                  // R, 0: no bootstrap
+    int nStages;                    // # rows of the cutflow
+    uint64_t stream;                // which replica weights, see above
+    long nEvents;                   // # events tallied so far
+    vector<double> generated;       // N_r: sum of the replica weights
+    vector<double> sumw;            // [stage x nReplicas + replica]
+    replicatally() : nReplicas(0), nStages(0), stream(0), nEvents(0) {}
+};
+
+
+void init_replicas(replicatally&, int, int, uint64_t);
+// Inputs: tally, # replicas, # stages, stream
+
+uint64_t replica_stream(uint64_t, string);
+// Inputs: stream (or seed), what it's for (e.g. "veto", "thread2")
+// Output: another stream, independent of the first
+
+uint64_t splitmix64(uint64_t&);
+// Output: 64 random bits; advances the state
+
+void tally_replicas(replicatally&, int, double);
+// Inputs: tally, stage returned by cut_event (1 for a vetoed event),
+//  event weight. Does nothing if nReplicas is 0.
+
+void pack_replicas(replicatally&, double*);
+// Writes generated, then sumw: nReplicas x (nStages + 1) doubles, e.g. into
+//  shared memory
+
+void unpack_replicas(double*, replicatally&);
+// Inputs: packed values, tally with nReplicas and nStages set (output)
+
+bool add_replicas(replicatally&, replicatally&);
+// Adds the second tally to the first. FALSE if they don't have the same
+//  # replicas and stages (the first then has no replicas left: replicas of
+//  only part of the events mean nothing).
+
+bool replica_spread(replicatally&, int, double, double&, double&, double&);
+// Inputs: tally, stage, # events generated, error (output), low and high
+//  end of the central 95% (output)
+// Output: FALSE if there are no replicas
+
+
+// END INCLUDE GUARD
+#endif // __FLIPBOOTSTRAP_H_INCLUDED__
@@ -0,0 +1,201 @@
+/******************************************************************************** 
+*   FlipCache.cpp                                                               *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains functions for the on-disk result cache, see FlipCache.h           *
+********************************************************************************/
+
+#include "FlipCache.h"
+#include <cctype>                   // for isalnum, tolower
+#include <cstdio>                   // for remove, rename
+#include <algorithm>                // for sort
+#include <dirent.h>                 // for opendir
+#include <sys/stat.h>               // for mkdir, stat
+#include <utime.h>                  // for utime
+#include <unistd.h>                 // for getpid
+
+
+
+string lowercase(string text){
+    for (unsigned int iChar = 0; iChar < text.size(); iChar++)
+        text[iChar] = tolower(text[iChar]);
+    return text;
+} // end lowercase
+
+
+
+string normalize_setting(string line){
+    // "Main:numberOfEvents     = 10000   ! comment" -> "main:numberofevents=10000"
+    // Empty if the line is a comment (as in Pythia: doesn't start with a 
+    // letter or digit). Keys are case insensitive, values are kept as is.
+    
+    size_t startpos = line.find_first_not_of(" \t");
+    if (startpos == string::npos || !isalnum(line[startpos])) return "";
+    line = line.substr(startpos, line.find('!') - startpos);
+    
+    string compact;
+    for (unsigned int iChar = 0; iChar < line.size(); iChar++)
+        if (line[iChar] != ' ' && line[iChar] != '\t') compact += line[iChar];
+    
+    size_t equals = compact.find('=');
+    if (equals == string::npos) return lowercase(compact);
+    return lowercase(compact.substr(0, equals)) + compact.substr(equals);
+} // end normalize_setting
+
+
+
+vector<string> effective_settings(string cmndfile, vector<string>& settings){
+    // Command file first, then the command line, like RPVgPoint reads them
+    
+    vector<string> lines;
+    
+    ifstream instream;
+    instream.open(cmndfile.c_str());
+    string line;
+    while (getline(instream, line)){
+        line = normalize_setting(line);
+        if (!line.empty()) lines.push_back(line);
+    }
+    instream.close();
+    
+    for (unsigned int iSet = 0; iSet < settings.size(); iSet++){
+        line = normalize_setting(settings[iSet]);
+        if (!line.empty()) lines.push_back(line);
+    }
+    
+    return lines;
+} // end effective_settings
+
+
+
+string effective_setting(vector<string>& lines, string key, string value){
+    // last one wins
+    
+    string start = lowercase(key) + "=";
+    for (unsigned int iLine = 0; iLine < lines.size(); iLine++)
+        if (lines[iLine].substr(0, start.size()) == start)
+            value = lines[iLine].substr(start.size());
+    return value;
+} // end effective_setting
+
+
+
+bool effective_flag(vector<string>& lines, string key, bool value){
+    // Pythia's spellings of 'on'
+    
+    string flag = lowercase(effective_setting(lines, key, value ? "on" : "off"));
+    return (flag == "on" || flag == "yes" || flag == "true" || flag == "1");
+} // end effective_flag
+
+
+
+cachepolicy cache_policy(vector<string>& lines){
+    // Defaults match addRecastSettings
+    
+    cachepolicy policy;
+    policy.use          = effective_flag(lines, "RPVg:cache", true);
+    policy.refresh      = effective_flag(lines, "RPVg:cacheRefresh", false);
+    policy.unseeded     = effective_flag(lines, "RPVg:cacheUnseeded", false);
+    policy.directory    = effective_setting(lines, "RPVg:cacheDir", "cache");
+    policy.maxEntries   = atoi(effective_setting(lines, 
+                                "RPVg:cacheMaxEntries", "10000").c_str());
+    
+    // Seeded: RPVg:seed. A fixed Random:seed only fixes Pythia; the 
+    // efficiencies still draw from rand(), which is seeded from the time
+    bool seeded = (atoi(effective_setting(lines, "RPVg:seed", "0").c_str()) != 0);
+    if (!seeded && !policy.unseeded) policy.use = false;
+    
+    // The cache has no histograms: make them, and update the entry
+    if (effective_flag(lines, "RPVg:histograms", false)) policy.refresh = true;
+    // ... nor the sums for the efficiency map
+    if (effective_flag(lines, "RPVg:effMap", false)) policy.refresh = true;
+    
+    return policy;
+} // end cache_policy
+
+
+
+string cache_key(vector<string>& lines, string spcfile, int iSR){
+    // Hash of everything that determines the result
+    
+    stringstream version;
+    version << "cut_version=" << cut_version << "\nSR=" << iSR << "\n";
+    uint64_t hash = fnv1a(version.str());
+    
+    // Settings that only change how we run, not what we get
+    for (unsigned int iLine = 0; iLine < lines.size(); iLine++){
+        if (lines[iLine].substr(0, 11) == "rpvg:status") continue;
+        if (lines[iLine].substr(0, 10) == "rpvg:cache") continue;
+        if (lines[iLine].substr(0, 11) == "rpvg:timing") continue;
+        if (lines[iLine].substr(0, 10) == "slha:file=") continue;
+        hash = fnv1a(lines[iLine] + "\n", hash);
+    } // end loop over settings
+    
+    // The spectrum itself (its file name doesn't matter)
+    ifstream instream;
+    instream.open(spcfile.c_str());
+    string line;
+    while (getline(instream, line)) hash = fnv1a(line + "\n", hash);
+    instream.close();
+    
+    stringstream key;
+    key << hex;
+    key.width(16);
+    key.fill('0');
+    key << hash;
+    return key.str();
+} // end cache_key
+
+
+
+bool cache_lookup(cachepolicy& policy, string key, cutflowrecord& record){
+    // A hit also marks the entry as recently used
+    
+    if (!policy.use || policy.refresh) return false;
+    
+    string filename = policy.directory + "/" + key + ".cut";
+    if (!read_cutflow(filename, record)) return false;
+    
+    utime(filename.c_str(), 0);     // set modification time to now
+    return true;
+} // end cache_lookup
+
+
+
+void cache_store(cachepolicy& policy, string key, cutflowrecord& record){
+    // Store, then remove the least recently used entries. The entry is 
+    // written to a temporary file and renamed, so that a run looking it up
+    // at the same time never reads half of it.
+    
+    if (!policy.use) return;
+    
+    mkdir(policy.directory.c_str(), 0777); // fine if it already exists
+    string filename = policy.directory + "/" + key + ".cut";
+    stringstream tempfile;
+    tempfile << filename << ".tmp" << getpid();
+    if (!write_cutflow(tempfile.str(), record) 
+        || rename(tempfile.str().c_str(), filename.c_str()) != 0){
+        cout << "ERROR writing cache entry " << filename << endl;
+        remove(tempfile.str().c_str());
+        return;
+    }
+    
+    // List entries, oldest first
+    vector< pair<long, string> > entries;
+    DIR* directory = opendir(policy.directory.c_str());
+    if (!directory) return;
+    struct dirent* entry;
+    while ((entry = readdir(directory))){
+        string name = entry->d_name;
+        if (name.size() < 4 || name.substr(name.size() - 4) != ".cut") continue;
+        name = policy.directory + "/" + name;
+        struct stat info;
+        if (stat(name.c_str(), &info) == 0) 
+            entries.push_back(pair<long, string>(info.st_mtime, name));
+    }
+    closedir(directory);
+    
+    sort(entries.begin(), entries.end());
+    for (int iEntry = 0; iEntry < int(entries.size()) - policy.maxEntries; 
+        iEntry++)
+        remove(entries[iEntry].second.c_str());
+} // end cache_store
@@ -0,0 +1,69 @@
+// FlipCache.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPCACHE_H_INCLUDED__
+#define __FLIPCACHE_H_INCLUDED__
+
+// Result cache: repeated or overlapping scans rerun points that we already
+// have. Each result is stored as a cutflow record named after a hash of 
+// everything that determines it:
+//  * the patched spectrum file,
+//  * the effective settings (command file and command line, without 
+//    comments and without settings that don't change the result),
+//  * the signal region,
+//  * the version of the cuts (cut_version below).
+// The seed policy and event count are settings, so they're in the key too.
+// Runs without RPVg:seed are NOT cached unless RPVg:cacheUnseeded = on: a
+// fixed Random:seed only fixes Pythia, not the rand() of the efficiencies,
+// and rerunning an unseeded point is usually meant to give independent 
+// statistics.
+// Runs with RPVg:histograms = on (or RPVg:effMap = on) always recompute,
+// since only the cutflow is stored.
+
+#include "FlipCutflow.h"            // cutflow records
+#include <string>
+#include <vector>
+using namespace std;
+
+const int cut_version = 2;
+// Bump this whenever a change to FlipCuts / FlipApplyCuts changes results,
+// so that old cache entries are no longer found.
+
+struct cachepolicy{
+    bool use;                       // look up and store results
+    bool refresh;                   // recompute (and overwrite) on a hit
+    bool unseeded;                  // also cache runs with time-based seeds
+    string directory;               // where the entries live
+    int maxEntries;                 // least recently used are removed
+};
+
+
+vector<string> effective_settings(string, vector<string>&);
+// Inputs: command file, extra settings from the command line
+// Output: the setting lines in order, comments and whitespace removed
+
+string effective_setting(vector<string>&, string, string);
+// Inputs: effective settings, key (e.g. "RPVg:seed"), default value
+// Output: the last value given to key (keys are case insensitive, as in
+//  Pythia), or the default
+
+bool effective_flag(vector<string>&, string, bool);
+// Same for a flag setting ("on", "yes", "true" or "1" count as on)
+
+cachepolicy cache_policy(vector<string>&);
+// Reads RPVg:cache, RPVg:cacheDir, ... from the effective settings. We 
+// need them before the Pythia object exists, which is the whole point.
+
+string cache_key(vector<string>&, string, int);
+// Inputs: effective settings, spectrum file, signal region
+// Output: 16 hex digits
+
+bool cache_lookup(cachepolicy&, string, cutflowrecord&);
+// TRUE if the key is in the cache; fills the record
+
+void cache_store(cachepolicy&, string, cutflowrecord&);
+// Stores the record and removes the oldest entries beyond maxEntries
+
+
+// END INCLUDE GUARD
+#endif // __FLIPCACHE_H_INCLUDED__
@@ -5,6 +5,8 @@
 ********************************************************************************/
 
 #include "FlipCommandFileFixer.h"
+#include <cstdio>                   // for remove
+#include <cstdlib>                  // for atoi
 
 bool  FixSpectrum(               // TRUE if spc file changed successfully
         std::string &templatefile,  // full path of the template spectrum
@@ -119,3 +121,119 @@ bool  FixCommand(                     // TRUE if successful
             
 }
 
+
+
+bool  FixSLHA(std::string &filename, std::string &entry, std::string &value){
+
+    // Which block and indices
+    vector<string> indices;
+    stringstream entrystream(entry);
+    string field;
+    while (getline(entrystream, field, '/')) indices.push_back(field);
+    if (indices.empty()) return false;
+    string block = indices[0];
+    transform(block.begin(), block.end(), block.begin(), ::toupper);
+    indices.erase(indices.begin());
+    bool isDecay = (block == "DECAY");
+    if (isDecay && indices.empty()) return false;
+
+    // Read everything first, so that the file can be rewritten in place
+    ifstream instream;
+    instream.open(filename.c_str());
+    if (!instream.is_open()) return false;
+    vector<string> lines;
+    string line;
+    while (getline(instream, line)) lines.push_back(line);
+    instream.close();
+
+    bool success = false;
+    bool inBlock = false;       // in the block (or decay table) we want
+
+    for (unsigned int iLine = 0; iLine < lines.size(); iLine++){
+        string data = lines[iLine];
+        string comment = "";
+        size_t hash = data.find('#');
+        if (hash != string::npos){
+            comment = "   " + data.substr(hash);
+            data = data.substr(0, hash);
+        }
+        vector<string> tokens;
+        stringstream tokenstream(data);
+        while (tokenstream >> field) tokens.push_back(field);
+        if (tokens.empty()) continue;
+
+        string keyword = tokens[0];
+        transform(keyword.begin(), keyword.end(), keyword.begin(), ::toupper);
+
+        // BLOCK and DECAY lines start a new block
+        if (keyword == "BLOCK"){
+            string name = (tokens.size() > 1) ? tokens[1] : "";
+            transform(name.begin(), name.end(), name.begin(), ::toupper);
+            inBlock = !isDecay && (name == block);
+            continue;
+        }
+        if (keyword == "DECAY"){
+            inBlock = isDecay && (tokens.size() > 2) && 
+                (atoi(tokens[1].c_str()) == atoi(indices[0].c_str()));
+            if (inBlock && indices.size() == 1){       // the width
+                lines[iLine] = data.substr(0, data.find_first_not_of(" \t"))
+                    + tokens[0] + "   " + tokens[1] + "   " + value + comment;
+                success = true;
+            }
+            continue;
+        }
+        if (!inBlock) continue;
+
+        // BLOCK entry: indices, then the value
+        if (!isDecay){
+            if (tokens.size() != indices.size() + 1) continue;
+            bool match = true;
+            for (unsigned int iIdx = 0; iIdx < indices.size(); iIdx++)
+                if (atoi(tokens[iIdx].c_str()) != atoi(indices[iIdx].c_str()))
+                    match = false;
+            if (!match) continue;
+            string newline = "";
+            for (unsigned int iIdx = 0; iIdx < indices.size(); iIdx++)
+                newline += "   " + tokens[iIdx];
+            lines[iLine] = newline + "   " + value + comment;
+            success = true;
+            continue;
+        }
+
+        // DECAY table line: BR, # daughters, daughters
+        if (indices.size() < 2 || tokens.size() != indices.size()) continue;
+        vector<int> wanted, found;
+        for (unsigned int iIdx = 2; iIdx < indices.size(); iIdx++)
+            wanted.push_back(atoi(indices[iIdx].c_str()));
+        for (unsigned int iTok = 2; iTok < tokens.size(); iTok++)
+            found.push_back(atoi(tokens[iTok].c_str()));
+        sort(wanted.begin(), wanted.end());
+        sort(found.begin(), found.end());
+        if ( (atoi(tokens[1].c_str()) != atoi(indices[1].c_str())) || 
+             (wanted != found) ) continue;
+        string newline = "   " + value;
+        for (unsigned int iTok = 1; iTok < tokens.size(); iTok++)
+            newline += "   " + tokens[iTok];
+        lines[iLine] = newline + comment;
+        success = true;
+    } // end loop over lines
+
+    ofstream outstream;
+    outstream.open(filename.c_str());
+    for (unsigned int iLine = 0; iLine < lines.size(); iLine++)
+        outstream << lines[iLine] << '\n';
+    outstream.close();
+
+    return success;
+}
+
+
+
+void RemoveFiles(std::vector<std::string> &filenames){
+    for(unsigned int iStr = 0; iStr < filenames.size(); iStr++){
+        if( remove(filenames[iStr].c_str()) !=0 )
+            cout << "ERROR deleting " << filenames[iStr] << endl;
+        else
+            cout << filenames[iStr] << " deleted correctly." << endl;
+    } // end loop over temporary files
+}
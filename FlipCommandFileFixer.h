@@ -5,6 +5,7 @@
 #define __FLIPCOMMANDFILEFIXER_H_INCLUDED__
 
 #include <string>              
+#include <vector>               // for vectors
 #include <sstream>              // for string stream
 #include <iostream>             // for i don't know
 #include <iomanip>              // for setting precision?
@@ -59,6 +60,30 @@ bool  FixCommand(                     // TRUE if successful
 
 
 
+bool  FixSLHA(                        // TRUE if the entry was found
+        std::string &filename,        // spectrum file, changed in place
+        std::string &entry,           // which entry, see below
+        std::string &value);          // new value
+//
+// Usage: more general than FixSpectrum, for entries of any block. The entry
+//  is the block name and the indices, separated by '/':
+//      MASS/1000006            mass of the stop (BLOCK MASS)
+//      RVLAMUDD/3/1/2          an RPV coupling (BLOCK RVLAMUDD)
+//      DECAY/1000006           width of the stop (the DECAY line)
+//      DECAY/1000006/2/-5/-3   BR of stop -> bbar sbar: # daughters, then
+//                              the daughters in any order
+//  Block names are not case sensitive; indices are compared as numbers and
+//  comments after the value are kept. Other BRs are not rescaled.
+
+
+
+void RemoveFiles(std::vector<std::string> &filenames);
+//
+// Usage: deletes the intermediate files (e.g. the generated spectrum and
+//  command files) and reports on each one.
+
+
+
 // END INCLUDE GUARD
 #endif __FLIPCOMMANDFILEFIXER_H_INCLUDED__
 
@@ -0,0 +1,117 @@
+// FlipCutChain.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPCUTCHAIN_H_INCLUDED__
+#define __FLIPCUTCHAIN_H_INCLUDED__
+
+// Object cuts put together at compile time. apply_cut (FlipCuts.h) calls
+// the cut through a function pointer, copies every object into the call
+// and builds a new vector for each cut, so the lepton kinematic cuts and
+// the ID efficiency were two passes with two allocations. Here each cut is
+// a type with a static pass(), a chain of them is a type,
+//      typedef cutchain<leptonkinematics, cutchain<leptonID> > leptonchain;
+// and apply_chain<leptonchain> goes over the objects once, trying the
+// stages in order on each object and stopping at the first one it fails
+// (so the ID efficiency is only drawn for leptons that passed the
+// kinematic cuts, as before). The survivors are moved to the front of the
+// vector in place. The # objects that passed each stage comes back for the
+// cutflow.
+//
+// Templates, so everything is here; the cuts themselves are the functions
+// of FlipCuts.h. Every pass() gets the random number state for the 
+// efficiencies (null: rand(), see efficiency_random), used or not.
+
+#include "FlipCuts.h"               // the cuts and efficiencies
+#include <vector>
+#include <stdint.h>                 // for uint64_t
+using namespace std;
+
+
+// THE STAGES
+// ----------
+// One object in, pass or fail out. Objects are passed by reference:
+// copying a PseudoJet isn't free.
+
+struct leptonkinematics{
+    static bool pass(const pair<int,fastjet::PseudoJet>& lepton, uint64_t*){
+        return lepton_kinematic_cut(lepton.first, lepton.second.pt(),
+            lepton.second.eta());
+    }
+};
+
+struct leptonID{
+    // as lepton_ID_eff
+    static bool pass(const pair<int,fastjet::PseudoJet>& lepton, 
+        uint64_t* state){
+        return efficiency_random(state) < lepton_ID_efficiency(lepton.first);
+    }
+};
+
+struct jetkinematics{
+    static bool pass(const pair<int,fastjet::PseudoJet>& jet, uint64_t*){
+        return jet_kinematic_cut(jet.second.pt(), jet.second.eta());
+    }
+};
+
+struct btagging{
+    // as b_selection_efficiency
+    static bool pass(const pair<int,fastjet::PseudoJet>& bjet, 
+        uint64_t* state){
+        return efficiency_random(state) < b_tag_efficiency(bjet.second.pt());
+    }
+};
+
+
+// CHAINS
+// ------
+
+struct endchain{
+    // the end of every chain: nothing left to fail
+    static const int nStages = 0;
+    static int first_failed(const pair<int,fastjet::PseudoJet>&, uint64_t*){
+        return 0;
+    }
+};
+
+template <class Stage, class Next = endchain>
+struct cutchain{
+    static const int nStages = 1 + Next::nStages;
+    static int first_failed(const pair<int,fastjet::PseudoJet>& object,
+        uint64_t* state){
+        // index of the first stage the object fails, nStages if none
+        if (!Stage::pass(object, state)) return 0;
+        return 1 + Next::first_failed(object, state);
+    }
+};
+
+typedef cutchain<leptonkinematics, cutchain<leptonID> > leptonchain;
+typedef cutchain<jetkinematics> jetchain;
+typedef cutchain<btagging> bchain;
+
+
+template <class Chain>
+void apply_chain(vector< pair<int,fastjet::PseudoJet> >& objects,
+    int* survivors = 0, uint64_t* state = 0){
+    // Inputs: objects (only the ones that pass every stage are left),
+    //  survivors (output, optional): # objects that passed stage 0 ... i,
+    //  Chain::nStages of them, random number state (optional)
+
+    if (survivors)
+        for (int iStage = 0; iStage < Chain::nStages; iStage++)
+            survivors[iStage] = 0;
+
+    unsigned int nKept = 0;
+    for (unsigned int iObject = 0; iObject < objects.size(); iObject++){
+        int failed = Chain::first_failed(objects[iObject], state);
+        if (survivors)
+            for (int iStage = 0; iStage < failed; iStage++) survivors[iStage]++;
+        if (failed < Chain::nStages) continue;
+        if (nKept != iObject) objects[nKept] = objects[iObject];
+        nKept++;
+    } // end loop over objects
+    objects.resize(nKept);
+} // end apply_chain
+
+
+// END INCLUDE GUARD
+#endif // __FLIPCUTCHAIN_H_INCLUDED__
@@ -0,0 +1,318 @@
+/******************************************************************************** 
+*   FlipCutflow.cpp                                                             *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains functions for saving, reading and combining cutflows              *
+*                                                                               *
+*   File format: one 'key<TAB>value' pair per line, then one line per cut:     *
+*       cut<TAB>count<TAB>sumw<TAB>sumw2<TAB>description                        *
+*   The description is the rest of the line since it may contain tabs.        *
+*   The header line 'stages' gives the number of cut lines, so that a file    *
+*   that was cut short is not mistaken for a complete one.                    *
+*   With bootstrap replicas (optional) there is one more header line and a    *
+*   line per replica row after the cuts:                                       *
+*       bootstrap<TAB>R<TAB>#stages<TAB>#events<TAB>stream                      *
+*       replicas<TAB>generated or stage #<TAB>R sums                           *
+********************************************************************************/
+
+#include "FlipCutflow.h"
+#include <cmath>                    // for sqrt
+#include <cerrno>                   // for errno
+#include <fcntl.h>                  // for open
+#include <unistd.h>                 // for write, close
+#include <sys/file.h>               // for flock
+#include <sys/stat.h>               // for fstat
+
+
+
+bool write_cutflow(string filename, cutflowrecord& record){
+    // Writes the record to filename, overwriting what's there
+    
+    ofstream outstream;
+    outstream.open(filename.c_str());
+    if (!outstream.is_open()) return false;
+    outstream.precision(12);
+    
+    outstream << "# RPVg cutflow"                   << '\n'
+              << "mstop\t"      << record.mstop     << '\n'
+              << "mgluino\t"    << record.mgluino   << '\n'
+              << "SR\t"         << record.iSR       << '\n'
+              << "shard\t"      << record.shardIndex << '\t' 
+                                << record.shardCount << '\n'
+              << "seed\t"       << record.seed      << '\n'
+              << "requested\t"  << record.nEvent    << '\n'
+              << "result\t"     << record.result    << '\n'
+              << "stages\t"     << record.counts.size() << '\n';
+    if (!record.decision.empty())
+        outstream << "limit\t"    << record.decision  << '\t'
+                  << record.confidence << '\t' << record.signal << '\t'
+                  << record.upperLimit << '\n';
+    
+    for(unsigned int iCut = 0; iCut < record.counts.size(); iCut++)
+        outstream << "cut\t" << record.counts[iCut].count << '\t' 
+                  << record.counts[iCut].sumw << '\t' 
+                  << record.counts[iCut].sumw2 << '\t' 
+                  << record.counts[iCut].label << '\n';
+    
+    replicatally& replicas = record.replicas;
+    if (replicas.nReplicas > 0){
+        outstream << "bootstrap\t" << replicas.nReplicas << '\t' 
+                  << replicas.nStages << '\t' << replicas.nEvents << '\t'
+                  << replicas.stream << '\n';
+        outstream << "replicas\tgenerated";
+        for (int iReplica = 0; iReplica < replicas.nReplicas; iReplica++)
+            outstream << '\t' << replicas.generated[iReplica];
+        outstream << '\n';
+        for (int iStage = 0; iStage < replicas.nStages; iStage++){
+            outstream << "replicas\t" << iStage;
+            for (int iReplica = 0; iReplica < replicas.nReplicas; iReplica++)
+                outstream << '\t' 
+                    << replicas.sumw[iStage * replicas.nReplicas + iReplica];
+            outstream << '\n';
+        }
+    }
+    
+    outstream.close();
+    return true;
+} // end write_cutflow
+
+
+
+void write_result(string filename, cutflowrecord& record){
+    // Same format that RPVgPoint has always used
+    
+    stringstream outstream;
+    outstream.precision(6); 
+    outstream.setf(ios::fixed);
+    outstream.setf(ios::showpoint);
+    outstream << record.mstop << "\t" << record.mgluino << "\t" << record.iSR 
+        << "\t" << record.result << "\t" << record.nEvent;
+    if (!record.decision.empty())
+        outstream << "\t" << record.decision << "\t" << record.confidence;
+    double error, low, high;
+    if (replica_spread(record.replicas, record.replicas.nStages - 1, 
+        record.counts[0].count, error, low, high))
+        outstream << "\t" << error << "\t" << low << "\t" << high;
+    outstream << '\n';
+    if (!append_locked(filename, outstream.str()))
+        cout << "ERROR: can't append to " << filename << endl;
+} // end write_result
+
+
+
+bool append_locked(string filename, string text, string header){
+    // O_APPEND alone doesn't keep a stream's pieces together, so the text
+    // goes out in one write while we hold the lock (closing releases it)
+
+    int file = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0666);
+    if (file < 0) return false;
+    while (flock(file, LOCK_EX) != 0)
+        if (errno != EINTR){
+            close(file);
+            return false;
+        }
+
+    struct stat info;
+    if (!header.empty() && fstat(file, &info) == 0 && info.st_size == 0)
+        text = header + text;
+    size_t written = 0;
+    while (written < text.size()){
+        ssize_t nWritten = write(file, text.data() + written, 
+            text.size() - written);
+        if (nWritten < 0 && errno == EINTR) continue;
+        if (nWritten <= 0) break;
+        written += nWritten;
+    }
+    close(file);
+    return written == text.size();
+} // end append_locked
+
+
+
+bool read_cutflow(string filename, cutflowrecord& record){
+    // Reads a file written by write_cutflow
+    
+    ifstream instream;
+    instream.open(filename.c_str());
+    if (!instream.is_open()) return false;
+    
+    record.counts.clear();
+    record.decision = "";
+    record.replicas = replicatally();
+    int nFound = 0;     // # of header lines found
+    int nCuts = 0;      // # cut lines there should be
+    int nRows = 0;      // # replica rows found
+    string line;
+    
+    while (getline(instream, line)){
+        if (line.empty() || line[0] == '#') continue;
+        
+        stringstream linestream(line);
+        string key;
+        getline(linestream, key, '\t');
+        
+        if      (key == "mstop")    { linestream >> record.mstop;   nFound++; }
+        else if (key == "mgluino")  { linestream >> record.mgluino; nFound++; }
+        else if (key == "SR")       { linestream >> record.iSR;     nFound++; }
+        else if (key == "seed")     { linestream >> record.seed;    nFound++; }
+        else if (key == "requested"){ linestream >> record.nEvent;  nFound++; }
+        else if (key == "result")   { linestream >> record.result;  nFound++; }
+        else if (key == "stages")   { linestream >> nCuts;          nFound++; }
+        else if (key == "shard"){
+            linestream >> record.shardIndex >> record.shardCount;
+            nFound++;
+        }
+        else if (key == "limit"){       // optional, see FlipLimit.h
+            linestream >> record.decision >> record.confidence 
+                >> record.signal >> record.upperLimit;
+        }
+        else if (key == "cut"){
+            string countstring, sumwstring, sumw2string, label;
+            getline(linestream, countstring, '\t');
+            getline(linestream, sumwstring, '\t');
+            getline(linestream, sumw2string, '\t');
+            getline(linestream, label);     // rest of the line
+            cutcount cut;
+            cut.label   = label;
+            cut.count   = atoi(countstring.c_str());
+            cut.sumw    = atof(sumwstring.c_str());
+            cut.sumw2   = atof(sumw2string.c_str());
+            record.counts.push_back(cut);
+        }
+        else if (key == "bootstrap"){   // optional, see FlipBootstrap.h
+            int nReplicas, nStages;
+            long nEvents;
+            uint64_t stream;
+            linestream >> nReplicas >> nStages >> nEvents >> stream;
+            init_replicas(record.replicas, nReplicas, nStages, stream);
+            record.replicas.nEvents = nEvents;
+        }
+        else if (key == "replicas"){
+            replicatally& replicas = record.replicas;
+            string row;
+            getline(linestream, row, '\t');
+            double* sums = 0;
+            if (row == "generated") sums = &replicas.generated[0];
+            else {
+                int iStage = atoi(row.c_str());
+                if (iStage < 0 || iStage >= replicas.nStages) continue;
+                sums = &replicas.sumw[iStage * replicas.nReplicas];
+            }
+            for (int iReplica = 0; iReplica < replicas.nReplicas; iReplica++)
+                linestream >> sums[iReplica];
+            if (linestream) nRows++;
+        }
+    } // end loop over lines
+    
+    instream.close();
+    
+    // Replicas have to be complete, or they're no use
+    if (nRows != record.replicas.nStages + 1) record.replicas = replicatally();
+    
+    return (nFound == 8) && (nCuts > 0) 
+        && ((int)record.counts.size() == nCuts);
+} // end read_cutflow
+
+
+
+bool merge_cutflow(cutflowrecord& total, cutflowrecord& shard){
+    // Sum shard into total; both have to describe the same point & cuts
+    
+    if (total.mstop != shard.mstop)     return false;
+    if (total.mgluino != shard.mgluino) return false;
+    if (total.iSR != shard.iSR)         return false;
+    if (total.counts.size() != shard.counts.size()) return false;
+    for(unsigned int iCut = 0; iCut < total.counts.size(); iCut++)
+        if (total.counts[iCut].label != shard.counts[iCut].label) return false;
+    
+    for(unsigned int iCut = 0; iCut < total.counts.size(); iCut++){
+        total.counts[iCut].count += shard.counts[iCut].count;
+        total.counts[iCut].sumw  += shard.counts[iCut].sumw;
+        total.counts[iCut].sumw2 += shard.counts[iCut].sumw2;
+    }
+    total.nEvent += shard.nEvent;
+    total.result += shard.result;
+    total.decision = "";
+    add_replicas(total.replicas, shard.replicas);
+    
+    return true;
+} // end merge_cutflow
+
+
+
+void read_replicas(cutflowrecord& record){
+    // As read_count, with the bootstrap error and 95% interval of each row
+
+    replicatally& replicas = record.replicas;
+    if (replicas.nReplicas == 0 || record.counts.empty()) return;
+    double nGenerated = record.counts[0].count;
+
+    cout << endl << "Bootstrap, " << replicas.nReplicas << " replicas:" << endl;
+    for (unsigned int iCut = 0; iCut < record.counts.size(); iCut++){
+        double error, low, high;
+        if (!replica_spread(replicas, iCut, nGenerated, error, low, high))
+            continue;
+        cout << record.counts[iCut].label << ": " << record.counts[iCut].sumw
+             << " +- " << error << "  [" << low << ", " << high << "]" << endl;
+    }
+} // end read_replicas
+
+
+
+double cut_error(cutcount& cut, double nGenerated){
+    // Standard error of sumw for a fixed # of generated events: the variance 
+    // of a sum of N independent (weight x pass) terms. For unit weights this
+    // is the binomial error sqrt(n (1 - n/N)).
+    
+    double variance = cut.sumw2;
+    if (nGenerated > 0) variance -= cut.sumw * cut.sumw / nGenerated;
+    if (variance < 0) variance = 0;
+    return sqrt(variance);
+} // end cut_error
+
+
+
+string cutflow_filename(string outfile, string mstop, string mgluino, int iSR, 
+    int shardIndex, int shardCount){
+    // e.g. output.dat.300_800_SR8.shard2of8
+    
+    stringstream name;
+    name << outfile << "." << mstop << "_" << mgluino << "_SR" << iSR 
+         << ".shard" << shardIndex << "of" << shardCount;
+    return name.str();
+} // end cutflow_filename
+
+
+
+int shard_events(int nEvent, int shardIndex, int shardCount){
+    // split nEvent as evenly as possible over shardCount shards
+    
+    int nShard = nEvent / shardCount;
+    if (shardIndex < nEvent % shardCount) nShard++;
+    return nShard;
+} // end shard_events
+
+
+
+long shard_seed(long base, string mstop, string mgluino, int iSR, 
+    int shardIndex){
+    // Hash everything that identifies the shard into a Pythia seed
+    
+    stringstream key;
+    key << base << ":" << mstop << ":" << mgluino << ":" << iSR << ":" 
+        << shardIndex;
+    
+    return 1 + long(fnv1a(key.str()) % 900000000UL);
+} // end shard_seed
+
+
+
+uint64_t fnv1a(string text, uint64_t hash){
+    // http://www.isthe.com/chongo/tech/comp/fnv/
+    
+    for(unsigned int iChar = 0; iChar < text.size(); iChar++){
+        hash ^= (unsigned char)(text[iChar]);
+        hash *= 1099511628211UL;
+    } // end loop over characters
+    
+    return hash;
+} // end fnv1a
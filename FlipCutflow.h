@@ -0,0 +1,108 @@
+// FlipCutflow.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPCUTFLOW_H_INCLUDED__
+#define __FLIPCUTFLOW_H_INCLUDED__
+
+// Cutflow records: a text file with the full counts vector of one run (or
+// one shard of a run) together with the point it belongs to. Shards of the
+// same point are combined with RPVgMerge. With RPVg:bootstrap the record
+// also has the replica cutflows (FlipBootstrap.h), one line per row.
+
+#include <string>
+#include <vector>
+#include <sstream>                  // for string stream
+#include <iostream>                 // for screen output
+#include <fstream>                  // for file in/out
+#include <stdint.h>                 // for uint64_t
+#include <cstdlib>                  // for atoi
+#include "FlipBootstrap.h"          // for bootstrap replicas
+using namespace std;
+
+struct cutcount{
+    // one row of the cutflow: # events and sums of their weights
+    string label;           // description of the cut
+    int count;              // # events that passed
+    double sumw;            // sum of their weights
+    double sumw2;           // sum of their squared weights
+};
+
+struct cutflowrecord{
+    // everything we need to combine runs of the same point
+    string mstop;                           // stop mass
+    string mgluino;                         // gluino mass
+    int iSR;                                // signal region #
+    int shardIndex;                         // this is shard k ...
+    int shardCount;                         // ... of K
+    long seed;                              // random seed (0: time-based)
+    int nEvent;                             // # events requested
+    double result;                          // value in output.dat
+    string decision;                        // early stop (see FlipLimit.h):
+                                            //  excluded, allowed, undecided
+                                            //  or "" if there was no test
+    double confidence;                      // ... its confidence
+    double signal;                          // ... expected # signal events
+    double upperLimit;                      // ... and the limit on them
+    vector<cutcount> counts;                // counts @ each cut
+    replicatally replicas;                  // bootstrap (nReplicas 0: none)
+};
+
+
+bool write_cutflow(string, cutflowrecord&);    // TRUE if file written
+bool read_cutflow(string, cutflowrecord&);     // TRUE if file read & sane:
+                                               //  every header line, and as
+                                               //  many cuts as it says
+
+bool merge_cutflow(cutflowrecord&, cutflowrecord&);
+// Adds the second record to the first. FALSE (and no change) if the records
+// are from different points or have different cuts. The early stop decision
+// of one shard says nothing about the sum, so the sum has none. Replicas
+// are added if both records have the same number, else dropped.
+
+void write_result(string, cutflowrecord&);
+// Appends the usual output.dat row for the record to the given file:
+//  mstop  mgluino  SR  result  #generated
+// followed by the early stop decision and its confidence if there was one,
+// and the bootstrap error and 95% interval of the result if there are
+// replicas. (The decision is a word, so the columns can be told apart.)
+// The row is appended with append_locked, so runs may share the file.
+
+bool append_locked(string, string, string = "");
+// Inputs: filename, text, header
+// Output: TRUE if the text was appended to the file (created if need be)
+//  in one write, under an exclusive flock, so that processes appending to
+//  the same file don't interleave. The header is written first if the file
+//  is empty, under the same lock.
+
+void read_replicas(cutflowrecord&);
+// Prints every row of the cutflow with its bootstrap error and interval,
+//  if the record has replicas
+
+double cut_error(cutcount&, double);
+// Inputs: row of the cutflow, # generated events
+// Output: uncertainty on the row's sumw
+
+string cutflow_filename(string, string, string, int, int, int);
+// Inputs: output filename, mstop, mgluino, iSR, shard k, shard count K
+// Output: e.g. output.dat.300_800_SR8.shard2of8
+
+
+// SHARDING
+// --------
+
+int shard_events(int, int, int);
+// Inputs: total # events, shard k, shard count K
+// Output: # events for shard k. The first nEvent % K shards get one more,
+//  so the shards always add up to the total.
+
+long shard_seed(long, string, string, int, int);
+// Inputs: base seed, mstop, mgluino, iSR, shard k
+// Output: a seed in [1, 900000000] (the range allowed by Pythia's
+//  Random:seed) that only depends on the inputs.
+
+uint64_t fnv1a(string, uint64_t = 14695981039346656037UL);
+// 64 bit FNV-1a hash of a string; second argument continues a previous hash
+
+
+// END INCLUDE GUARD
+#endif // __FLIPCUTFLOW_H_INCLUDED__
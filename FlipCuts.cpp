@@ -8,25 +8,32 @@
 
 
 
-void read_count(vector< pair<string, int> > count){
-    // outputs the contents of count to screen
+void read_count(vector<cutcount> count){
+    // outputs the contents of count to screen: # events, weighted # events
     
     cout << endl;
     for(unsigned int i=0; i < count.size(); i++)
-        cout << count[i].first << ":\t" << count[i].second << endl;
+        cout << count[i].label << ":\t" << count[i].count << "\t" 
+             << count[i].sumw << endl;
 } // end void read_count(...)
 
 
 
-void fill_vector(vector< pair<string, int> > &count, string line, int num){
-    // adds an element to a vector of particles
+void fill_vector(vector<cutcount> &count, string line, int num, 
+    double sumw, double sumw2){
+    // adds a row to the cutflow
     
-    pair<string, int> new_item(line, num);
+    cutcount new_item;
+    new_item.label = line;
+    new_item.count = num;
+    new_item.sumw  = sumw;
+    new_item.sumw2 = sumw2;
     count.push_back(new_item);
 } // end void fill_vector(...)
 
 
 
+
 double get_deltaR(fastjet::PseudoJet vec1, fastjet::PseudoJet vec2){
     // outputs the Delta_R between two four-momenta (pseudoJets)
 
@@ -44,6 +51,16 @@ double get_deltaR(fastjet::PseudoJet vec1, fastjet::PseudoJet vec2){
 bool lepton_kinematic_cut(pair<int, fastjet::PseudoJet> lepton){
     // returns true if a lepton passes the kinematic cuts
     
+    return lepton_kinematic_cut(lepton.first, lepton.second.pt(), 
+        lepton.second.eta());
+        
+} // end lepton_kinematic_cut
+
+
+
+bool lepton_kinematic_cut(int id, double pt, double eta){
+    // same as above, for a PDG code, pT and eta (FlipCutChain.h, FlipBatch.h)
+    
     // LEPTON KINEMATIC CUT PARAMETERS
     double electron_pT  = 20.0;
     double muon_pT      = 20.0;
@@ -51,23 +68,17 @@ bool lepton_kinematic_cut(pair<int, fastjet::PseudoJet> lepton){
     double eta_bar   = 1.442;
     double eta_end   = 1.566;
     
-    bool passes = false;
-    int id = lepton.first;
-    fastjet::PseudoJet momentum = lepton.second;
-    
-    bool pass_pT =  ((abs(id) == 11) && (momentum.pt() >= electron_pT)) ||
-                    ((abs(id) == 13) && (momentum.pt() >= muon_pT));
+    bool pass_pT =  ((abs(id) == 11) && (pt >= electron_pT)) ||
+                    ((abs(id) == 13) && (pt >= muon_pT));
                     
-    bool pass_eta = ((abs(id) == 13) && (abs(momentum.eta()) < lepton_eta)) ||
-                    ((abs(id) == 11) && (abs(momentum.eta()) < eta_bar)) ||
-                    ((abs(id) == 11) && (abs(momentum.eta()) > eta_end)
-                                     && (abs(momentum.eta()) < lepton_eta));
+    bool pass_eta = ((abs(id) == 13) && (abs(eta) < lepton_eta)) ||
+                    ((abs(id) == 11) && (abs(eta) < eta_bar)) ||
+                    ((abs(id) == 11) && (abs(eta) > eta_end)
+                                     && (abs(eta) < lepton_eta));
                                      
-    if (pass_pT && pass_eta) passes = true;
-    
-    return passes;
+    return pass_pT && pass_eta;
         
-} // end lepton_kinematic_cut
+} // end lepton_kinematic_cut (PDG code, pT, eta)
 
 
 
@@ -76,22 +87,25 @@ bool jet_kinematic_cut(pair<int, fastjet::PseudoJet> jet){
     // note that in SUS-12-017 the jet and bjet kin cuts are the same
     //  so I haven't written a separate bjet_kinematic_cut function
     
+    return jet_kinematic_cut(jet.second.pt(), jet.second.eta());
+        
+} // end jet_kinematic_cut
+
+
+
+bool jet_kinematic_cut(double pt, double eta){
+    // same as above, for a pT and eta (cut chains, FlipCutChain.h)
+    
     // JET KINEMATIC CUT PARAMETERS
     double jet_pT   = 40.0;
     double jet_eta  = 2.4;
     
-    bool passes = false;
-    // int id = jet.first; 
-    fastjet::PseudoJet momentum = jet.second;
-    
-    bool pass_pT    = (momentum.pt() >= jet_pT);                    
-    bool pass_eta   = (abs(momentum.eta()) < jet_eta);
+    bool pass_pT    = (pt >= jet_pT);                    
+    bool pass_eta   = (abs(eta) < jet_eta);
                                      
-    if (pass_pT && pass_eta) passes = true;    
-    
-    return passes;
+    return pass_pT && pass_eta;
         
-} // end jet_kinematic_cut
+} // end jet_kinematic_cut (pT, eta)
 
 
 
@@ -149,18 +163,24 @@ bool lepton_ID_eff(pair<int, fastjet::PseudoJet> lepton){
     bool passes = false;
     double random = (double)rand()/(double)RAND_MAX; // random from 0 to 1
     
+    if (random < lepton_ID_efficiency(lepton.first)) passes = true;
+
+    return passes;
+    
+} // end lepton_ID_eff
+
+
+
+double lepton_ID_efficiency(int id){
     // LEPTON EFFICIENCY PARAMETERS
 
     double IDefficiency = 0.0;     
     
-    if (abs(lepton.first) == 11) IDefficiency = 0.76;   // electron    
-    if (abs(lepton.first) == 13) IDefficiency = 0.86;   // muon
+    if (abs(id) == 11) IDefficiency = 0.76;     // electron    
+    if (abs(id) == 13) IDefficiency = 0.86;     // muon
     
-    if (random < IDefficiency) passes = true;
-
-    return passes;
-    
-} // end lepton_ID_eff
+    return IDefficiency;
+} // end lepton_ID_efficiency
 
 
 
@@ -220,6 +240,33 @@ bool lepton_iso_eff(    unsigned int seedLepton,
 
 
 
+bool lepton_iso_eff(    unsigned int seedLepton,
+                        vector< pair<int, fastjet::PseudoJet> >& leptons, 
+                        double hadron_cone_pT){
+    // Lepton isolation efficiency, hadronic cone pT computed beforehand
+    
+    bool passes = false;
+    double cone_pT = hadron_cone_pT;
+    double lepton_dR  = 0.3; // lepton delta R
+    double Iiso       = 0.15;
+    
+    pair<int, fastjet::PseudoJet>& lepton = leptons[seedLepton];
+    
+    // Fill cone_pT with cone leptons, don't count seed lepton
+    for (unsigned int iLep = 0; iLep < leptons.size(); iLep++) {
+        if (get_deltaR(lepton.second, leptons[iLep].second) < lepton_dR){
+            if(iLep != seedLepton)
+                cone_pT += leptons[iLep].second.pt();
+        } // end if lepton is in the cone
+    } // end loop over leptons
+    
+    if (cone_pT < Iiso*lepton.second.pt() ) passes = true;
+    return passes;
+                            
+} // end lepton_iso_eff (precomputed hadron cone)
+
+
+
 bool b_selection_efficiency(pair<int, fastjet::PseudoJet> bjet){
     // based on efficiencies, randomly determines if
     // a generated bjet is successfully tagged
@@ -229,7 +276,17 @@ bool b_selection_efficiency(pair<int, fastjet::PseudoJet> bjet){
     double random = (double)rand()/(double)RAND_MAX; // random from 0 to 1
     
     
-    double pt = bjet.second.pt();
+    double efficiency = b_tag_efficiency(bjet.second.pt());
+    
+    // if (random < efficiency*1000) passes = true;
+    if (random < efficiency) passes = true;
+    
+    return passes;
+} // end tag_b
+
+
+
+double b_tag_efficiency(double pt){
     double efficiency = .65;
     
     // parameterization form SUSY-12-917-pas
@@ -239,15 +296,13 @@ bool b_selection_efficiency(pair<int, fastjet::PseudoJet> bjet){
     
     if (pt < 40) efficiency = 0; // cut on bjet
     
-    // if (random < efficiency*1000) passes = true;
-    if (random < efficiency) passes = true;
-    
-    return passes;
-} // end tag_b
+    return efficiency;
+} // end b_tag_efficiency
 
 
 
-bool lepton_trig_efficiency(vector< pair<int, fastjet::PseudoJet> > leptons){
+bool lepton_trig_efficiency(vector< pair<int, fastjet::PseudoJet> > leptons,
+    uint64_t* state){
     // Gives probability that a dilepton pair is triggered upon
     // Should also require one lepton with pT > 17, other with pT > 8
     //  but this is already automatically satisfied by lepton kinematic cuts
@@ -255,24 +310,15 @@ bool lepton_trig_efficiency(vector< pair<int, fastjet::PseudoJet> > leptons){
     //  two hardest leptons. See FlipApplyCuts.cpp.
     
     bool passes = false;
-    double random = (double)rand()/(double)RAND_MAX; // random from 0 to 1
-    double eff_ee = 0.95;
-    double eff_emu = 0.92;
-    double eff_mumu = 0.88;
+    double random = efficiency_random(state);      // random from 0 to 1
     
     // if (random < eff_emu) return true;
     // else return false;
     
     if (leptons.size()<2) return passes;   // need at least 2 leptons
     
-    if ((abs(leptons[0].first) == 11) && (abs(leptons[1].first) == 11))
-        if (random < eff_ee) passes = true;
-    if ((abs(leptons[0].first) == 11) && (abs(leptons[1].first) == 13))
-        if (random < eff_emu) passes = true;
-    if ((abs(leptons[0].first) == 13) && (abs(leptons[1].first) == 11))
-        if (random < eff_emu) passes = true;
-    if ((abs(leptons[0].first) == 13) && (abs(leptons[1].first) == 13))
-        if (random < eff_mumu) passes = true;
+    if (random < dilepton_trig_efficiency(leptons[0].first, leptons[1].first))
+        passes = true;
     //     
     return passes;
             
@@ -302,18 +348,54 @@ bool lepton_trig_efficiency(vector< pair<int, fastjet::PseudoJet> > leptons){
 
 
 
-bool METefficiency(double MET, double minMET){
+double dilepton_trig_efficiency(int id1, int id2){
+    // the PDG codes of the two hardest leptons; 0 unless both are e or mu
+    
+    double eff_ee = 0.95;
+    double eff_emu = 0.92;
+    double eff_mumu = 0.88;
+    
+    if ((abs(id1) == 11) && (abs(id2) == 11)) return eff_ee;
+    if ((abs(id1) == 11) && (abs(id2) == 13)) return eff_emu;
+    if ((abs(id1) == 13) && (abs(id2) == 11)) return eff_emu;
+    if ((abs(id1) == 13) && (abs(id2) == 13)) return eff_mumu;
+    return 0.0;
+} // end dilepton_trig_efficiency
+
+
+
+bool METefficiency(double MET, double minMET, uint64_t* state, 
+    double given){
     // Converts between parton-level MET and hadronic MET
     // by including effect of 'turn on curves'
     // from 1205.3933
     
     bool passes = false;
-    double random = (double)rand()/(double)RAND_MAX; // random from 0 to 1
+    double random = given;                          // random from 0 to 1
+    if (random < 0.0) random = efficiency_random(state);
     
     double x = MET;
     double x12 = 0;
     double sig = 0;
     
+    if (!MET_turnon(minMET, x12, sig)) return true;    // see below
+    
+    double efficiency = 0.5*(erf((x-x12)/sig) + 1);
+    if (random < efficiency) passes = true;
+    
+    return passes;
+    
+} // end METefficiency
+
+
+
+bool MET_turnon(double minMET, double& x12, double& sig){
+    // The turn on curve for a MET cut (50% point, width). FALSE if there's
+    // no MET cut: every event passes.
+    
+    x12 = 0;
+    sig = 0;
+    
     if (minMET >= 120){
         x12 = 123;
         sig = 37;
@@ -326,32 +408,46 @@ bool METefficiency(double MET, double minMET){
         x12 = 13;
         sig = 44;
     }
-    else if (minMET == 0); // do nothing, see below
+    else if (minMET == 0) return false;
     else cout << endl << "ERROR: METefficiency" << endl;
     
-    double efficiency = 0.5*(erf((x-x12)/sig) + 1);
-    if (random < efficiency) passes = true;
-    
-    if (minMET == 0) passes = true;
-    
-    return passes;
-    
-} // end METefficiency
+    return true;
+} // end MET_turnon
 
 
 
-bool HTefficiency(double HT, double minHT){
+bool HTefficiency(double HT, double minHT, uint64_t* state, 
+    double given){
     // Converts between parton-level HT and hadronic HT
     // by including effect of 'turn on curves'
     // from 1205.3933
     
     bool passes = false;
-    double random = (double)rand()/(double)RAND_MAX; // random from 0 to 1
+    double random = given;                          // random from 0 to 1
+    if (random < 0.0) random = efficiency_random(state);
     
     double x = HT;
     double x12 = 0;
     double sig = 0;
     
+    if (!HT_turnon(minHT, x12, sig)) return true;      // see below
+    
+    double efficiency = 0.5*(erf((x-x12)/sig) + 1);
+    if (random < efficiency) passes = true;
+    
+    return passes;
+} // end HTefficiency
+
+
+
+bool HT_turnon(double minHT, double& x12, double& sig){
+    // The turn on curve for an HT cut. FALSE if every event passes:
+    // minimum pT cuts on jet selection is 40 GeV
+    // so a min HT of 80 trivially passes cuts
+    
+    x12 = 0;
+    sig = 0;
+    
     if (minHT >= 320){
         x12 = 188;
         sig = 88;
@@ -360,19 +456,21 @@ bool HTefficiency(double HT, double minHT){
         x12 = 308;
         sig = 102;
     }
-    else if (minHT == 80); // do nothing, see below
-    else if (minHT == 0);  // equivalent to above cut
+    else if (minHT == 80) return false;
+    else if (minHT == 0) return false;  // equivalent to above cut
     else cout << endl << "ERROR: HTefficiency" << endl;
     
-    double efficiency = 0.5*(erf((x-x12)/sig) + 1);
-    if (random < efficiency) passes = true;
-    
-    if ( (minHT == 80) || (minHT == 0) ) passes = true;
-    // minimum pT cuts on jet selection is 40 GeV
-    // so a min HT of 80 trivially passes cuts
+    return true;
+} // end HT_turnon
+
+
+
+double efficiency_random(uint64_t* state){
+    // rand() unless we have a state of our own
     
-    return passes;
-} // end HTefficiency
+    if (!state) return (double)rand()/(double)RAND_MAX;
+    return (splitmix64(*state) >> 11) * (1.0 / 9007199254740992.0);  // 2^-53
+} // end efficiency_random
 
 
 bool isLepton(int pid){
@@ -419,6 +517,65 @@ vector<pair<int,fastjet::PseudoJet> > apply_iso(
 
 
 
+vector<pair<int,fastjet::PseudoJet> > apply_iso(
+    vector<pair<int,fastjet::PseudoJet> >& leptons,
+    vector<double>& hadronCone){
+    // same as above, with the hadronic cone pT from hadron_cone_pT
+    
+    vector< pair<int, fastjet::PseudoJet> > templeptons;
+    
+    for(unsigned int iLep = 0; iLep < leptons.size(); iLep++){
+        if (lepton_iso_eff(iLep, leptons, hadronCone[iLep])) 
+            templeptons.push_back(leptons[iLep]);
+    } // end for loop over leptons
+    
+    return templeptons;   
+}
+
+
+
+vector<double> hadron_cone_pT(
+    Pythia8::Event& event,
+    vector<pair<int,fastjet::PseudoJet> >& leptons){
+    // Uses the same particles as the old hadron list (final, visible, 
+    // not e or mu, |eta| < 5) and the same Delta R as get_deltaR, i.e. with
+    // fastjet's convention 0 <= phi < 2 pi.
+    
+    double lepton_dR  = 0.3; // lepton delta R, as in lepton_iso_eff
+    double twopi      = 2*M_PI;
+    
+    unsigned int nLep = leptons.size();
+    vector<double> cone(nLep, 0.0);
+    vector<double> lepEta(nLep);
+    vector<double> lepPhi(nLep);
+    for(unsigned int iLep = 0; iLep < nLep; iLep++){
+        lepEta[iLep] = leptons[iLep].second.eta();
+        lepPhi[iLep] = leptons[iLep].second.phi();
+    } // end loop over leptons
+    
+    for (int iPart = 0; iPart < event.size(); iPart++){
+        if (!event[iPart].isFinal()) continue;
+        if (!event[iPart].isVisible()) continue;
+        if (isLepton(event[iPart].id())) continue;
+        
+        double eta = event[iPart].eta();
+        if (abs(eta) >= 5.0) continue;
+        double phi = event[iPart].phi();
+        if (phi < 0) phi += twopi;
+        
+        for(unsigned int iLep = 0; iLep < nLep; iLep++){
+            double dphi = phi - lepPhi[iLep];
+            double deta = eta - lepEta[iLep];
+            if (dphi*dphi + deta*deta < lepton_dR*lepton_dR)
+                cone[iLep] += event[iPart].pT();
+        } // end loop over leptons
+    } // end loop over event particles
+    
+    return cone;
+}
+
+
+
 bool pTordered(pair<int,fastjet::PseudoJet> part1, 
     pair<int,fastjet::PseudoJet> part2){
     //
@@ -5,6 +5,7 @@
 #define __FLIPCUTS_H_INCLUDED__
 
 // Based on FlipEfficiency.h in previous versions of this codes
+// If you change what any of these cuts do, bump cut_version in FlipCache.h
 
 #include "Pythia.h"                         // Include Pythia headers
 #include <fastjet/ClusterSequence.hh>       // fastjet clustering
@@ -15,6 +16,7 @@
 #include <iomanip>                          // for setting precision?
 #include <fstream>                          // for file in/out
 #include <algorithm>                        // for sort
+#include "FlipCutflow.h"                    // for cutcount
 
 using namespace std;
 
@@ -34,12 +36,14 @@ struct signalregion{
 *   Helper functions that calculate intermediate steps, output, etc.            *
 ********************************************************************************/
 
-void read_count(vector< pair<string, int> >);
-void fill_vector(vector< pair<string, int> > &, string, int);
+void read_count(vector<cutcount>);
+void fill_vector(vector<cutcount> &, string, int, double, double);
 double get_deltaR(fastjet::PseudoJet, fastjet::PseudoJet);
 
 bool lepton_kinematic_cut(pair<int, fastjet::PseudoJet>);
+bool lepton_kinematic_cut(int, double, double);     // PDG code, pT, eta
 bool jet_kinematic_cut(pair<int, fastjet::PseudoJet>);
+bool jet_kinematic_cut(double, double);             // pT, eta
 bool lepton_selection_cut(pair<int, fastjet::PseudoJet>);
 bool lepton_ID_eff(pair<int, fastjet::PseudoJet>);
 
@@ -54,12 +58,36 @@ bool lepton_iso_eff(    unsigned int,
                         vector< pair<int, fastjet::PseudoJet> >);
 // arguments: lepton array index, lepton array, parton array
 // for including leptons into the cone, but not the cone lepton itself
+
+// This is the same thing when the hadronic pT in the cone is already known
+bool lepton_iso_eff(    unsigned int,
+                        vector< pair<int, fastjet::PseudoJet> >&,
+                        double);
+// arguments: lepton array index, lepton array, hadronic pT in the cone
                         
                         
 bool b_selection_efficiency(pair<int, fastjet::PseudoJet>);
-bool lepton_trig_efficiency(vector< pair<int, fastjet::PseudoJet> >);
-bool METefficiency(double, double);
-bool HTefficiency(double, double);
+bool lepton_trig_efficiency(vector< pair<int, fastjet::PseudoJet> >, 
+                            uint64_t* = 0);
+bool METefficiency(double, double, uint64_t* = 0, double = -1.0);
+bool HTefficiency(double, double, uint64_t* = 0, double = -1.0);
+// The third argument of these is the random number state, see below. The
+// MET and HT ones can be given the number to use instead (< 0: draw one)
+
+double efficiency_random(uint64_t* = 0);
+// Uniform random number from 0 to 1 for an efficiency. From rand() by 
+// default; with a state, from splitmix64 (FlipBootstrap.h), which advances
+// it. Threads that cut events at the same time each need their own state.
+
+// The efficiencies themselves, without the random number, so that the
+// cut chains (FlipCutChain.h) and batched cuts (FlipBatch.h) use the same
+// numbers
+double lepton_ID_efficiency(int);                   // PDG code
+double b_tag_efficiency(double);                    // b quark pT
+double dilepton_trig_efficiency(int, int);          // two hardest leptons
+bool MET_turnon(double, double&, double&);          // min MET, x12, sigma
+bool HT_turnon(double, double&, double&);           // min HT, x12, sigma
+// turn on curves 0.5 (erf((x - x12)/sigma) + 1); FALSE: no cut
 
 bool isLepton(int);
 
@@ -70,11 +98,23 @@ vector<pair<int,fastjet::PseudoJet> > apply_cut(
     bool(*)(pair<int,fastjet::PseudoJet>),
     vector<pair<int,fastjet::PseudoJet> >
     );
+// Superseded by apply_chain (FlipCutChain.h) in the cut chain
 
 vector<pair<int,fastjet::PseudoJet> > apply_iso(
     vector<pair<int,fastjet::PseudoJet> >,
     vector<pair<int,fastjet::PseudoJet> >);
 
+vector<pair<int,fastjet::PseudoJet> > apply_iso(
+    vector<pair<int,fastjet::PseudoJet> >&,     // leptons
+    vector<double>&);                           // hadronic pT in each cone
+
+vector<double> hadron_cone_pT(
+    Pythia8::Event&,                            // pythia.event
+    vector<pair<int,fastjet::PseudoJet> >&);    // leptons
+// For each lepton, the scalar pT sum of the visible, non-leptonic final state
+// particles in its isolation cone. One pass over the event record, without
+// building a list of hadrons.
+
 bool pTordered(pair<int,fastjet::PseudoJet>, 
     pair<int,fastjet::PseudoJet>);
 
@@ -0,0 +1,234 @@
+/********************************************************************************
+*   FlipEffMap.cpp                                                              *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the efficiency map functions, see FlipEffMap.h                     *
+*                                                                               *
+*   File format: '#' lines are comments, then one line per run, SR and         *
+*   topology (see FlipEffMap.h for the columns).                               *
+********************************************************************************/
+
+#include "FlipEffMap.h"
+#include "FlipCutflow.h"            // for append_locked
+#include <algorithm>                // for sort, unique
+
+
+
+void tally_topology(topologytally& tally, int topo, bool passed, double weight){
+    tally.nGenerated[topo]++;
+    tally.sumwGenerated[topo] += weight;
+    if (!passed) return;
+    tally.sumwPassed[topo] += weight;
+    tally.sumw2Passed[topo] += weight*weight;
+} // end tally_topology
+
+
+
+void add_topologies(topologytally& total, topologytally& tally){
+    for (int iTopo = 0; iTopo < nTopologies; iTopo++){
+        total.nGenerated[iTopo]     += tally.nGenerated[iTopo];
+        total.sumwGenerated[iTopo]  += tally.sumwGenerated[iTopo];
+        total.sumwPassed[iTopo]     += tally.sumwPassed[iTopo];
+        total.sumw2Passed[iTopo]    += tally.sumw2Passed[iTopo];
+    }
+} // end add_topologies
+
+
+
+bool append_effmap(string filename, double mstop, double mgluino, int iSR,
+    topologytally& tally){
+    // One line per topology that had events, all in one locked append
+
+    stringstream lines;
+    lines.precision(12);
+    for (int iTopo = 0; iTopo < nTopologies; iTopo++){
+        if (tally.nGenerated[iTopo] == 0) continue;
+        lines << mstop << '\t' << mgluino << '\t' << iSR << '\t'
+              << topology_name[iTopo] << '\t' << tally.nGenerated[iTopo]
+              << '\t' << tally.sumwGenerated[iTopo] << '\t'
+              << tally.sumwPassed[iTopo] << '\t'
+              << tally.sumw2Passed[iTopo] << '\n';
+    }
+    return append_locked(filename, lines.str(), 
+        "# RPVg efficiency map: mstop mgluino SR topology nGenerated "
+        "sumwGenerated sumwPassed sumw2Passed\n");
+} // end append_effmap
+
+
+
+bool read_effmap(string filename, effmap& emap){
+    // Reads every line, adding up lines of the same point/SR/topology
+
+    ifstream instream;
+    instream.open(filename.c_str());
+    if (!instream.is_open()) return false;
+
+    emap.entries.clear();
+    string line;
+    while (getline(instream, line)){
+        if (line.empty() || line[0] == '#') continue;
+
+        stringstream linestream(line);
+        effmapentry entry;
+        string name;
+        linestream >> entry.mstop >> entry.mgluino >> entry.iSR >> name
+            >> entry.nGenerated >> entry.sumwGenerated >> entry.sumwPassed
+            >> entry.sumw2Passed;
+        if (!linestream) return false;
+        entry.topology = -1;
+        for (int iTopo = 0; iTopo < nTopologies; iTopo++)
+            if (name == topology_name[iTopo]) entry.topology = iTopo;
+        if (entry.topology < 0) return false;
+
+        bool found = false;
+        for (unsigned int iEntry = 0; iEntry < emap.entries.size(); iEntry++){
+            effmapentry& old = emap.entries[iEntry];
+            if ( (old.mstop != entry.mstop) || (old.mgluino != entry.mgluino)
+                || (old.iSR != entry.iSR) || (old.topology != entry.topology) )
+                continue;
+            old.nGenerated      += entry.nGenerated;
+            old.sumwGenerated   += entry.sumwGenerated;
+            old.sumwPassed      += entry.sumwPassed;
+            old.sumw2Passed     += entry.sumw2Passed;
+            found = true;
+            break;
+        }
+        if (!found) emap.entries.push_back(entry);
+    } // end loop over lines
+
+    instream.close();
+    return true;
+} // end read_effmap
+
+
+
+double entry_efficiency(effmapentry& entry, double* error){
+    // Error as in cut_error (FlipCutflow.cpp), divided by sumw(generated)
+
+    if (entry.sumwGenerated <= 0.0){
+        if (error) *error = 0.0;
+        return 0.0;
+    }
+    double variance = entry.sumw2Passed;
+    if (entry.nGenerated > 0)
+        variance -= entry.sumwPassed * entry.sumwPassed / entry.nGenerated;
+    if (variance < 0) variance = 0;
+    if (error) *error = sqrt(variance) / entry.sumwGenerated;
+    return entry.sumwPassed / entry.sumwGenerated;
+} // end entry_efficiency
+
+
+
+double map_efficiency(effmap& emap, double mstop, double mgluino, int iSR,
+    int topo, double* error, bool* inside){
+
+    if (error) *error = 0.0;
+    if (inside) *inside = false;
+
+    // The points we have for this SR and topology
+    vector<effmapentry*> points;
+    vector<double> stops, gluinos;
+    for (unsigned int iEntry = 0; iEntry < emap.entries.size(); iEntry++){
+        effmapentry& entry = emap.entries[iEntry];
+        if (entry.iSR != iSR || entry.topology != topo) continue;
+        points.push_back(&entry);
+        stops.push_back(entry.mstop);
+        gluinos.push_back(entry.mgluino);
+    }
+    if (points.empty()) return 0.0;
+    sort(stops.begin(), stops.end());
+    stops.erase(unique(stops.begin(), stops.end()), stops.end());
+    sort(gluinos.begin(), gluinos.end());
+    gluinos.erase(unique(gluinos.begin(), gluinos.end()), gluinos.end());
+
+
+    // BILINEAR
+    // --------
+    // Grid lines on either side of the point (the same line twice if the
+    // point is on it); all four corners have to be in the map
+    int iStop = -1, iGluino = -1;
+    for (unsigned int i = 0; i + 1 < stops.size(); i++)
+        if (stops[i] <= mstop && mstop <= stops[i+1]) iStop = i;
+    for (unsigned int i = 0; i + 1 < gluinos.size(); i++)
+        if (gluinos[i] <= mgluino && mgluino <= gluinos[i+1]) iGluino = i;
+    if (stops.size() == 1 && stops[0] == mstop) iStop = 0;
+    if (gluinos.size() == 1 && gluinos[0] == mgluino) iGluino = 0;
+
+    if (iStop >= 0 && iGluino >= 0){
+        double x[2] = { stops[iStop], stops[min(iStop + 1, int(stops.size()) - 1)] };
+        double y[2] = { gluinos[iGluino],
+            gluinos[min(iGluino + 1, int(gluinos.size()) - 1)] };
+        double tx = (x[1] > x[0]) ? (mstop - x[0]) / (x[1] - x[0]) : 0.0;
+        double ty = (y[1] > y[0]) ? (mgluino - y[0]) / (y[1] - y[0]) : 0.0;
+
+        double efficiency = 0.0, variance = 0.0;
+        int nCorners = 0;
+        for (int ix = 0; ix < 2; ix++){
+            for (int iy = 0; iy < 2; iy++){
+                for (unsigned int iPoint = 0; iPoint < points.size(); iPoint++){
+                    if (points[iPoint]->mstop != x[ix] ||
+                        points[iPoint]->mgluino != y[iy]) continue;
+                    double w = (ix ? tx : 1 - tx) * (iy ? ty : 1 - ty);
+                    double pointError;
+                    efficiency += w * entry_efficiency(*points[iPoint], &pointError);
+                    variance += w * w * pointError * pointError;
+                    nCorners++;
+                    break;
+                }
+            }
+        }
+        if (nCorners == 4){
+            if (error) *error = sqrt(variance);
+            if (inside) *inside = true;
+            return efficiency;
+        }
+    } // end bilinear
+
+
+    // NEAREST FOUR, 1/distance^2
+    // --------------------------
+    double scaleStop = (stops.back() > stops.front()) ?
+        stops.back() - stops.front() : 1.0;
+    double scaleGluino = (gluinos.back() > gluinos.front()) ?
+        gluinos.back() - gluinos.front() : 1.0;
+    vector< pair<double, int> > distances;
+    for (unsigned int iPoint = 0; iPoint < points.size(); iPoint++){
+        double dx = (points[iPoint]->mstop - mstop) / scaleStop;
+        double dy = (points[iPoint]->mgluino - mgluino) / scaleGluino;
+        distances.push_back(make_pair(dx*dx + dy*dy, int(iPoint)));
+    }
+    sort(distances.begin(), distances.end());
+
+    double efficiency = 0.0, variance = 0.0, sumWeights = 0.0;
+    for (unsigned int iNear = 0; iNear < distances.size() && iNear < 4; iNear++){
+        double pointError;
+        double pointEfficiency = entry_efficiency(
+            *points[distances[iNear].second], &pointError);
+        if (distances[iNear].first == 0.0){         // right on a map point
+            if (error) *error = pointError;
+            return pointEfficiency;
+        }
+        double w = 1.0 / distances[iNear].first;
+        efficiency += w * pointEfficiency;
+        variance += w * w * pointError * pointError;
+        sumWeights += w;
+    }
+    if (error) *error = sqrt(variance) / sumWeights;
+    return efficiency / sumWeights;
+} // end map_efficiency
+
+
+
+void model_fractions(double fractionSS, double BRlepton, double BRtau,
+    double* fractions){
+    // Independent W decays; the rest is 'other'
+
+    double pairs[3] = { BRlepton * BRlepton, 2 * BRlepton * BRtau,
+        BRtau * BRtau };
+    double sum = 0.0;
+    for (int iPair = 0; iPair < 3; iPair++){
+        fractions[topoSSll + iPair] = fractionSS * pairs[iPair];
+        fractions[topoOSll + iPair] = (1 - fractionSS) * pairs[iPair];
+        sum += pairs[iPair];
+    }
+    fractions[topoOther] = 1 - sum;
+} // end model_fractions
@@ -0,0 +1,105 @@
+// FlipEffMap.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPEFFMAP_H_INCLUDED__
+#define __FLIPEFFMAP_H_INCLUDED__
+
+// Efficiency maps: the efficiency of each SR as a function of the masses
+// and of the decay topology of the event, so that a slightly different
+// model (other BRs, other fraction of same sign tops, another cross
+// section) can be estimated without running Pythia:
+//      yield = sigma x luminosity x sum over topologies of  f_t x eff_t
+// where f_t is the fraction of the model's events in topology t.
+//
+// Topology: the two W's from the tops, same sign (SS) or opposite sign
+// (OS), each decaying to e/mu (l) or tau (t); anything else (a hadronic
+// W, not two W's) is 'other'. Within a topology the forced decay weights
+// are the same for every event, so the efficiency doesn't depend on how
+// the W decays were forced.
+//
+// Recorded by RPVgPoint with RPVg:effMap = on: each run appends one line
+// per topology to RPVg:effMapFile (default effmap.dat):
+//      mstop  mgluino  SR  topology  #generated  sumw(generated)
+//          sumw(passed)  sumw2(passed)
+// Lines of the same point, SR and topology (shards, reruns) are added up
+// when the map is read. Look the map up with RPVgEffMap.cc.
+
+#include <string>
+#include <vector>
+#include <sstream>                  // for string stream
+#include <iostream>                 // for screen output
+#include <fstream>                  // for file in/out
+#include <cmath>                    // for sqrt
+using namespace std;
+
+enum topology { topoSSll, topoSSlt, topoSStt, topoOSll, topoOSlt, topoOStt,
+    topoOther, nTopologies };
+const char* const topology_name[nTopologies] =
+    { "SS_ll", "SS_lt", "SS_tt", "OS_ll", "OS_lt", "OS_tt", "other" };
+
+struct topologytally{
+    // sums for one run, per topology
+    long nGenerated[nTopologies];           // # events generated
+    double sumwGenerated[nTopologies];      // ... sum of their weights
+    double sumwPassed[nTopologies];         // sum of weights that passed
+    double sumw2Passed[nTopologies];        // ... and of their squares
+    topologytally(){
+        for (int iTopo = 0; iTopo < nTopologies; iTopo++){
+            nGenerated[iTopo] = 0;
+            sumwGenerated[iTopo] = 0.0;
+            sumwPassed[iTopo] = 0.0;
+            sumw2Passed[iTopo] = 0.0;
+        }
+    }
+};
+
+struct effmapentry{
+    // one line of the map (or the sum of several)
+    double mstop;
+    double mgluino;
+    int iSR;
+    int topology;
+    long nGenerated;
+    double sumwGenerated;
+    double sumwPassed;
+    double sumw2Passed;
+};
+
+struct effmap{
+    vector<effmapentry> entries;            // one per point, SR and topology
+};
+
+
+void tally_topology(topologytally&, int, bool, double);
+// Inputs: tally, topology, passed all cuts?, event weight
+
+void add_topologies(topologytally&, topologytally&);
+// Adds the second tally to the first
+
+bool append_effmap(string, double, double, int, topologytally&);
+// Inputs: map file, mstop, mgluino, SR, sums of the run
+// Output: TRUE if the lines were appended, in one locked write (see 
+//  append_locked), so that runs can add to the same map
+
+bool read_effmap(string, effmap&);
+// TRUE if the file was read; lines of the same point/SR/topology are added
+
+double entry_efficiency(effmapentry&, double* = 0);
+// Output: efficiency, and its uncertainty in the second argument
+
+double map_efficiency(effmap&, double, double, int, int, double* = 0,
+    bool* = 0);
+// Inputs: map, mstop, mgluino, SR, topology, uncertainty (output), inside
+//  (output: FALSE if the point isn't surrounded by map points)
+// Output: interpolated efficiency. Bilinear between the four surrounding
+//  points of a grid; otherwise (scattered points, e.g. a Sobol scan, or
+//  outside the grid) weighted by 1/distance^2 over the nearest four, with
+//  the masses scaled by their ranges.
+
+void model_fractions(double, double, double, double*);
+// Inputs: fraction of SS top pairs, BR(W -> e or mu), BR(W -> tau),
+//  fractions (output, nTopologies of them)
+
+
+// END INCLUDE GUARD
+#endif // __FLIPEFFMAP_H_INCLUDED__
@@ -0,0 +1,187 @@
+/********************************************************************************
+*   FlipEvents.cpp                                                              *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the per-event record files, see FlipEvents.h                       *
+*                                                                               *
+*   Header (72 bytes):  0 magic "RPVgEVTS", 8 version, 12 record size,        *
+*       16 # stages, 20 # SRs, 24 SR, 28 shard k, 32 shard K, 36 (0),          *
+*       40 mstop, 48 mgluino, 56 # generated (8 bytes), 64 sumw generated      *
+*   Record (24 bytes):  0 weight, 8 MET, 12 HT, 16 stages, 18 regions,         *
+*       20 nJets, 21 nbJets, 22 nLeptons, 23 charge                             *
+*   Every field is copied to its offset, so the layout doesn't depend on how  *
+*   the compiler pads the structs.                                              *
+********************************************************************************/
+
+#include "FlipEvents.h"
+#include "FlipBootstrap.h"          // for splitmix64
+#include <cstring>                  // for memcpy, memcmp
+
+const char eventMagic[8] = { 'R', 'P', 'V', 'g', 'E', 'V', 'T', 'S' };
+
+
+
+void put_field(unsigned char* buffer, int offset, const void* value, int size){
+    memcpy(buffer + offset, value, size);
+} // end put_field
+
+
+
+void get_field(const unsigned char* buffer, int offset, void* value, int size){
+    memcpy(value, buffer + offset, size);
+} // end get_field
+
+
+
+void pack_header(eventfile& header, unsigned char* buffer){
+    int32_t version = eventFileVersion, recordBytes = eventRecordBytes;
+    int32_t nStages = header.nStages, nRegions = header.nRegions;
+    int32_t iSR = header.iSR, shardIndex = header.shardIndex;
+    int32_t shardCount = header.shardCount, unused = 0;
+    int64_t nGenerated = header.nGenerated;
+
+    put_field(buffer, 0, eventMagic, 8);
+    put_field(buffer, 8, &version, 4);
+    put_field(buffer, 12, &recordBytes, 4);
+    put_field(buffer, 16, &nStages, 4);
+    put_field(buffer, 20, &nRegions, 4);
+    put_field(buffer, 24, &iSR, 4);
+    put_field(buffer, 28, &shardIndex, 4);
+    put_field(buffer, 32, &shardCount, 4);
+    put_field(buffer, 36, &unused, 4);
+    put_field(buffer, 40, &header.mstop, 8);
+    put_field(buffer, 48, &header.mgluino, 8);
+    put_field(buffer, 56, &nGenerated, 8);
+    put_field(buffer, 64, &header.sumwGenerated, 8);
+} // end pack_header
+
+
+
+bool unpack_header(const unsigned char* buffer, eventfile& header){
+    if (memcmp(buffer, eventMagic, 8) != 0) return false;
+    int32_t version, recordBytes, value;
+    int64_t nGenerated;
+    get_field(buffer, 8, &version, 4);
+    get_field(buffer, 12, &recordBytes, 4);
+    if (version != eventFileVersion || recordBytes != eventRecordBytes)
+        return false;
+
+    get_field(buffer, 16, &value, 4);   header.nStages = value;
+    get_field(buffer, 20, &value, 4);   header.nRegions = value;
+    get_field(buffer, 24, &value, 4);   header.iSR = value;
+    get_field(buffer, 28, &value, 4);   header.shardIndex = value;
+    get_field(buffer, 32, &value, 4);   header.shardCount = value;
+    get_field(buffer, 40, &header.mstop, 8);
+    get_field(buffer, 48, &header.mgluino, 8);
+    get_field(buffer, 56, &nGenerated, 8);
+    header.nGenerated = nGenerated;
+    get_field(buffer, 64, &header.sumwGenerated, 8);
+    return true;
+} // end unpack_header
+
+
+
+bool open_events(eventwriter& writer, string filename, eventfile& header,
+    uint64_t seed){
+    writer.stream.open(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!writer.stream.is_open()) return false;
+    writer.header = header;
+    writer.random = seed;
+    writer.nRecords = 0;
+
+    unsigned char buffer[eventHeaderBytes];
+    pack_header(writer.header, buffer);
+    writer.stream.write((const char*)buffer, eventHeaderBytes);
+    return writer.stream.good();
+} // end open_events
+
+
+
+void write_event(eventwriter& writer, eventrecord& record){
+    unsigned char buffer[eventRecordBytes];
+    put_field(buffer, 0, &record.weight, 8);
+    put_field(buffer, 8, &record.MET, 4);
+    put_field(buffer, 12, &record.HT, 4);
+    put_field(buffer, 16, &record.stages, 2);
+    put_field(buffer, 18, &record.regions, 2);
+    put_field(buffer, 20, &record.nJets, 1);
+    put_field(buffer, 21, &record.nbJets, 1);
+    put_field(buffer, 22, &record.nLeptons, 1);
+    put_field(buffer, 23, &record.charge, 1);
+    writer.stream.write((const char*)buffer, eventRecordBytes);
+    writer.nRecords++;
+} // end write_event
+
+
+
+bool close_events(eventwriter& writer, long nGenerated, double sumwGenerated){
+    // The header again, now that we know what was generated
+
+    writer.header.nGenerated = nGenerated;
+    writer.header.sumwGenerated = sumwGenerated;
+    unsigned char buffer[eventHeaderBytes];
+    pack_header(writer.header, buffer);
+    writer.stream.seekp(0);
+    writer.stream.write((const char*)buffer, eventHeaderBytes);
+    bool good = writer.stream.good();
+    writer.stream.close();
+    return good;
+} // end close_events
+
+
+
+double event_uniform(eventwriter& writer){
+    return (splitmix64(writer.random) >> 11) * (1.0 / 9007199254740992.0);
+} // end event_uniform
+
+
+
+bool read_events(string filename, eventfile& header,
+    vector<eventrecord>& records){
+    // The whole file at once, then the records out of the buffer
+
+    ifstream instream(filename.c_str(), ios::in | ios::binary);
+    if (!instream.is_open()) return false;
+    instream.seekg(0, ios::end);
+    long nBytes = instream.tellg();
+    instream.seekg(0, ios::beg);
+    if (nBytes < eventHeaderBytes) return false;
+
+    vector<unsigned char> buffer(nBytes);
+    instream.read((char*)&buffer[0], nBytes);
+    if (!instream.good() || !unpack_header(&buffer[0], header)) return false;
+
+    long nRecords = (nBytes - eventHeaderBytes) / eventRecordBytes;
+    records.reserve(records.size() + nRecords);
+    for (long iRecord = 0; iRecord < nRecords; iRecord++){
+        const unsigned char* bytes = &buffer[eventHeaderBytes
+            + iRecord * eventRecordBytes];
+        eventrecord record;
+        get_field(bytes, 0, &record.weight, 8);
+        get_field(bytes, 8, &record.MET, 4);
+        get_field(bytes, 12, &record.HT, 4);
+        get_field(bytes, 16, &record.stages, 2);
+        get_field(bytes, 18, &record.regions, 2);
+        get_field(bytes, 20, &record.nJets, 1);
+        get_field(bytes, 21, &record.nbJets, 1);
+        get_field(bytes, 22, &record.nLeptons, 1);
+        get_field(bytes, 23, &record.charge, 1);
+        records.push_back(record);
+    } // end loop over records
+    return true;
+} // end read_events
+
+
+
+double mask_sumw(vector<eventrecord>& records, unsigned int mask, bool all,
+    double& sumw2){
+    double sumw = 0.0;
+    sumw2 = 0.0;
+    for (unsigned int iRecord = 0; iRecord < records.size(); iRecord++){
+        unsigned int passed = records[iRecord].regions & mask;
+        if (all ? (passed != mask) : (passed == 0)) continue;
+        double weight = records[iRecord].weight;
+        sumw += weight;
+        sumw2 += weight * weight;
+    } // end loop over records
+    return sumw;
+} // end mask_sumw
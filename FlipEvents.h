@@ -0,0 +1,116 @@
+// FlipEvents.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPEVENTS_H_INCLUDED__
+#define __FLIPEVENTS_H_INCLUDED__
+
+// Per-event records: a run normally keeps only the cutflow of its own SR.
+// To look at unions or overlaps of SRs, correlations between them, or the
+// best expected SR afterwards, RPVg:eventRecord = on writes one fixed
+// width record per event that made it to the cuts:
+//      weight      (8 bytes)   event weight, see event_weight
+//      MET, HT     (4 + 4)     parton level, GeV (float)
+//      stages      (2)         bit s: stage s of the run's cutflow was
+//                              checked and passed (see below)
+//      regions     (2)         bit r: passed every cut of SR r
+//      nJets, nbJets, nLeptons (1 + 1 + 1)  jets, tagged b jets (b quarks
+//                              if the tagging didn't run), isolated leptons
+//      charge      (1)         +1 for ++, -1 for --, 0 if not same sign
+// after a 72 byte header (see eventfile), in host byte order. The file
+// goes next to the cutflow: output.dat.300_800_SR8.shard0of1.events.
+//
+// The regions: the lepton, b tagging and same sign cuts are the same for
+// every SR. Each event draws one number for the MET and one for the HT 
+// turn on curve (from the record's own stream, not rand()), and every SR
+// uses those two: the run's own SR in its cutflow, so its bit is exactly
+// the cutflow's answer, the other SRs together with their jets, b jets and
+// charge. So an event that passes a turn on curve passes every curve that
+// is higher at its MET (or HT). That is the curve of the looser threshold
+// for the MET (below 1.6 TeV), but not for the HT: the curve for 320 GeV is
+// above the one for 200 GeV (see HT_turnon). Nothing is cut again for the
+// record: the stages are the ones cut_event checked, and the cutflow 
+// counts the event up to the first bit that's missing (RPVg:tuneCuts is 
+// off with records). Events vetoed at parton level (RPVg:partonVeto, which
+// then looks at every SR) pass no SR and have no record; they're in the 
+// header's # generated.
+//
+// Records of the same point (shards, runs for other SRs) can be added up:
+// efficiency = sum of weights / # generated. RPVgEvents.cc does that.
+//
+// Only written by the plain event loop of recast: not with the pipeline,
+// workers or batched cuts.
+
+#include <string>
+#include <vector>
+#include <iostream>                 // for screen output
+#include <fstream>                  // for file in/out
+#include <stdint.h>                 // for uint64_t etc.
+using namespace std;
+
+const int eventRecordBytes = 24;
+const int eventHeaderBytes = 72;
+const int eventFileVersion = 1;
+
+struct eventrecord{
+    // one event, see above
+    double weight;
+    float MET;
+    float HT;
+    uint16_t stages;
+    uint16_t regions;
+    uint8_t nJets;
+    uint8_t nbJets;
+    uint8_t nLeptons;
+    int8_t charge;
+};
+
+struct eventfile{
+    // the header: magic "RPVgEVTS", version, then these
+    int nStages;                    // # rows of the cutflow
+    int nRegions;                   // # SRs
+    int iSR;                        // the run's own SR
+    int shardIndex;                 // shard k ...
+    int shardCount;                 // ... of K
+    double mstop;
+    double mgluino;
+    long nGenerated;                // # events generated (incl. vetoed)
+    double sumwGenerated;           // ... sum of their weights
+    eventfile() : nStages(0), nRegions(0), iSR(0), shardIndex(0),
+        shardCount(1), mstop(0), mgluino(0), nGenerated(0),
+        sumwGenerated(0) {}
+};
+
+struct eventwriter{
+    // an open record file
+    ofstream stream;
+    eventfile header;
+    uint64_t random;                // stream for the turn on curves
+    long nRecords;
+};
+
+
+bool open_events(eventwriter&, string, eventfile&, uint64_t);
+// Inputs: writer, filename, header (# generated comes at the end), seed of
+//  the random stream
+// Output: TRUE if the file is open and the header written
+
+void write_event(eventwriter&, eventrecord&);
+
+bool close_events(eventwriter&, long, double);
+// Inputs: writer, # generated, sum of their weights (for the header)
+// Output: TRUE if all went well
+
+double event_uniform(eventwriter&);
+// Output: uniform in [0, 1) from the writer's stream
+
+bool read_events(string, eventfile&, vector<eventrecord>&);
+// Appends the records of a file; FALSE if it's not a record file
+
+double mask_sumw(vector<eventrecord>&, unsigned int, bool, double&);
+// Inputs: records, SRs (bit r: SR r), TRUE: events in all of them (the
+//  overlap), FALSE: in any of them (the union), sum of squares (output)
+// Output: sum of weights
+
+
+// END INCLUDE GUARD
+#endif // __FLIPEVENTS_H_INCLUDED__
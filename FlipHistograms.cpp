@@ -0,0 +1,141 @@
+/********************************************************************************
+*   FlipHistograms.cpp                                                          *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains functions for the cut stage histograms, see FlipHistograms.h      *
+*                                                                               *
+*   File format: '#' lines are comments (the stage labels are listed there),  *
+*   then one line per histogram:                                                *
+*       variable<TAB>stage<TAB>low<TAB>high<TAB>nBins<TAB>entries<TAB>         *
+*           underflow<TAB>bin 1<TAB>...<TAB>bin nBins<TAB>overflow             *
+********************************************************************************/
+
+#include "FlipHistograms.h"
+
+
+
+void init_histograms(histogramset& set, int nStage){
+    set.hist.clear();
+    set.hist.resize(nStage);
+    for (int iStage = 0; iStage < nStage; iStage++){
+        for (int iVar = 0; iVar < nHistVariables; iVar++){
+            histogram empty;
+            empty.low       = hist_low[iVar];
+            empty.high      = hist_high[iVar];
+            empty.nBins     = hist_bins[iVar];
+            empty.entries   = 0;
+            empty.sumw.assign(hist_bins[iVar] + 2, 0.0);
+            set.hist[iStage].push_back(empty);
+        } // end loop over variables
+    } // end loop over stages
+} // end init_histograms
+
+
+
+void fill_histogram(histogram& hist, double value, double weight){
+    int iBin;
+    if (value < hist.low) iBin = 0;
+    else if (value >= hist.high) iBin = hist.nBins + 1;
+    else iBin = 1 + int(hist.nBins * (value - hist.low) / (hist.high - hist.low));
+
+    hist.sumw[iBin] += weight;
+    hist.entries++;
+} // end fill_histogram
+
+
+
+bool add_histograms(histogramset& total, histogramset& set){
+    // Check everything first, so that a mismatch changes nothing
+
+    if (total.hist.size() != set.hist.size()) return false;
+    for (unsigned int iStage = 0; iStage < set.hist.size(); iStage++){
+        if (total.hist[iStage].size() != set.hist[iStage].size()) return false;
+        for (unsigned int iVar = 0; iVar < set.hist[iStage].size(); iVar++){
+            histogram& mine = total.hist[iStage][iVar];
+            histogram& theirs = set.hist[iStage][iVar];
+            if ( (mine.nBins != theirs.nBins) || (mine.low != theirs.low) ||
+                 (mine.high != theirs.high) ) return false;
+        }
+    }
+
+    for (unsigned int iStage = 0; iStage < set.hist.size(); iStage++){
+        for (unsigned int iVar = 0; iVar < set.hist[iStage].size(); iVar++){
+            histogram& mine = total.hist[iStage][iVar];
+            histogram& theirs = set.hist[iStage][iVar];
+            mine.entries += theirs.entries;
+            for (unsigned int iBin = 0; iBin < mine.sumw.size(); iBin++)
+                mine.sumw[iBin] += theirs.sumw[iBin];
+        }
+    }
+    return true;
+} // end add_histograms
+
+
+
+bool write_histograms(string filename, histogramset& set,
+    vector<cutcount>& counts){
+    // Writes the set to filename, overwriting what's there
+
+    ofstream outstream;
+    outstream.open(filename.c_str());
+    if (!outstream.is_open()) return false;
+    outstream.precision(8);
+
+    outstream << "# RPVg histograms" << '\n';
+    for (unsigned int iStage = 0; iStage < counts.size(); iStage++)
+        outstream << "# stage " << iStage << ": " << counts[iStage].label << '\n';
+
+    for (unsigned int iStage = 0; iStage < set.hist.size(); iStage++){
+        for (unsigned int iVar = 0; iVar < set.hist[iStage].size(); iVar++){
+            histogram& hist = set.hist[iStage][iVar];
+            outstream << hist_name[iVar] << '\t' << iStage << '\t'
+                      << hist.low << '\t' << hist.high << '\t'
+                      << hist.nBins << '\t' << hist.entries;
+            for (unsigned int iBin = 0; iBin < hist.sumw.size(); iBin++)
+                outstream << '\t' << hist.sumw[iBin];
+            outstream << '\n';
+        }
+    }
+
+    outstream.close();
+    return true;
+} // end write_histograms
+
+
+
+bool read_histograms(string filename, histogramset& set){
+    // Reads a file written by write_histograms
+
+    ifstream instream;
+    instream.open(filename.c_str());
+    if (!instream.is_open()) return false;
+
+    set.hist.clear();
+    string line;
+
+    while (getline(instream, line)){
+        if (line.empty() || line[0] == '#') continue;
+
+        stringstream linestream(line);
+        string name;
+        unsigned int iStage;
+        histogram hist;
+        linestream >> name >> iStage >> hist.low >> hist.high >> hist.nBins
+            >> hist.entries;
+        if (!linestream || hist.nBins < 1) return false;
+
+        hist.sumw.assign(hist.nBins + 2, 0.0);
+        for (int iBin = 0; iBin < hist.nBins + 2; iBin++)
+            linestream >> hist.sumw[iBin];
+        if (!linestream) return false;
+
+        // Stages and variables come in order
+        if (iStage == set.hist.size()) set.hist.resize(iStage + 1);
+        if (iStage + 1 != set.hist.size()) return false;
+        if (name != hist_name[set.hist[iStage].size() % nHistVariables])
+            return false;
+        set.hist[iStage].push_back(hist);
+    } // end loop over lines
+
+    instream.close();
+    return !set.hist.empty();
+} // end read_histograms
@@ -0,0 +1,75 @@
+// FlipHistograms.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPHISTOGRAMS_H_INCLUDED__
+#define __FLIPHISTOGRAMS_H_INCLUDED__
+
+// Kinematic histograms at every stage of the cutflow: instead of rerunning
+// with debug prints, look at what the events that made it to a stage look
+// like. Fixed binning (below), weighted with the event weights,
+// with an underflow and an overflow bin. Switched on with
+// RPVg:histograms = on; written next to the cutflow record as
+//      output.dat.300_800_SR8.shard0of1.hist
+// Every thread fills its own set; they are added up at the end. Shards
+// are added up by RPVgMerge like their cutflows.
+
+#include "FlipCutflow.h"            // for cutcount (stage labels)
+#include <string>
+#include <vector>
+using namespace std;
+
+// VARIABLES
+// ---------
+// Each stage has the objects as they were right after it, i.e. what the
+// next cut was looking at:
+// Leptons: all of them at 'Generated', then the ones left after the 
+//  kinematic cuts, the ID and the isolation
+// Jets: partons that pass the jet kinematic cuts; b quarks before tagging,
+//  the tagged ones from the b tagging stage on
+// Cone sum: hadronic pT in the isolation cone of each lepton (one entry per
+//  lepton), from the ID stage on: the leptons tried for isolation there, 
+//  the isolated ones after that
+enum histvariable { histMET, histHT, histLep1pT, histLep2pT, histnJets,
+    histnbJets, histConeSum, nHistVariables };
+const char* const hist_name[nHistVariables] =
+    { "MET", "HT", "lep1pT", "lep2pT", "nJets", "nbJets", "coneSum" };
+const int hist_bins[nHistVariables]     = { 50, 50, 50, 50, 16, 8, 50 };
+const double hist_low[nHistVariables]   = { 0., 0., 0., 0., -0.5, -0.5, 0. };
+const double hist_high[nHistVariables]  =
+    { 500., 2000., 500., 250., 15.5, 7.5, 25. };
+
+struct histogram{
+    // fixed binning; sumw[0] is underflow, sumw[nBins+1] overflow
+    double low;                     // lower edge of the first bin
+    double high;                    // upper edge of the last bin
+    int nBins;                      // # bins between low and high
+    int entries;                    // # times filled
+    vector<double> sumw;            // sum of weights in each bin
+};
+
+struct histogramset{
+    // one histogram per variable per stage: hist[stage][variable]
+    vector< vector<histogram> > hist;
+};
+
+
+void init_histograms(histogramset&, int);
+// Inputs: set, # stages. Empty histograms with the binning above
+
+void fill_histogram(histogram&, double, double);
+// Inputs: histogram, value, weight
+
+bool add_histograms(histogramset&, histogramset&);
+// Adds the second set to the first. FALSE (and no change) if the binning
+//  or # stages are different.
+
+bool write_histograms(string, histogramset&, vector<cutcount>&);
+// Inputs: filename, set, cutflow (for the stage labels)
+// Output: TRUE if file written
+
+bool read_histograms(string, histogramset&);
+// TRUE if a file written by write_histograms was read
+
+
+// END INCLUDE GUARD
+#endif // __FLIPHISTOGRAMS_H_INCLUDED__
@@ -0,0 +1,78 @@
+/********************************************************************************
+*   FlipLimit.cpp                                                               *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the sequential exclusion test, see FlipLimit.h                     *
+*                                                                               *
+*   At each look, z = (S - limit) / error. The chance that a point on the      *
+*   other side of the limit gives a z this far out is p = erfc(|z|/sqrt2)/2,   *
+*   and the confidence of the call is 1 - (# looks) x p.                       *
+********************************************************************************/
+
+#include "FlipLimit.h"
+
+
+
+void start_limit_test(limittest& test, double upperLimit, double luminosity,
+    double confidence, long firstLook, long nEvent, double openFraction){
+
+    test.upperLimit     = upperLimit;
+    test.luminosity     = luminosity;
+    test.openFraction   = (openFraction > 0.0) ? openFraction : 1.0;
+    test.alpha          = 1.0 - confidence;
+    test.nextLook       = (firstLook > 0) ? firstLook : 1;
+    test.decision       = limitUndecided;
+    test.confidence     = 0.0;
+    test.signal         = 0.0;
+    test.signalError    = 0.0;
+
+    // first, 2 first, 4 first, ... below nEvent, and nEvent itself
+    test.nLooks = 1;
+    for (long look = test.nextLook; look < nEvent; look *= 2) test.nLooks++;
+} // end start_limit_test
+
+
+
+bool limit_look(limittest& test, long nGenerated, double sumw, double sumw2,
+    double sigma, double sigmaErr){
+
+    while (test.nextLook <= nGenerated) test.nextLook *= 2;
+    if (nGenerated <= 0 || sigma <= 0.0) return false;
+
+    // # signal events per unit of (sum of weights): mb -> fb is 1e12. The
+    // weights have the decay BRs already, see FlipLimit.h
+    double scale = sigma / test.openFraction * 1e12 * test.luminosity 
+        / nGenerated;
+
+    // Statistical variance of sumw as in cut_error (FlipCutflow.cpp), but
+    // at least that of one more passing event: with a handful of passing
+    // events (or none) the spread of the weights says nothing yet.
+    double variance = sumw2 - sumw * sumw / nGenerated;
+    double oneEvent = (sumw > 0.0) ? sumw2 / sumw : 1.0;
+    if (variance < oneEvent * oneEvent) variance = oneEvent * oneEvent;
+
+    test.signal = scale * sumw;
+    double relErr = sigmaErr / sigma;
+    test.signalError = sqrt(scale * scale * variance
+        + test.signal * test.signal * relErr * relErr);
+
+    double z = (test.signal - test.upperLimit) / test.signalError;
+    double pValue = 0.5 * erfc(fabs(z) / sqrt(2.0));
+    test.confidence = 1.0 - test.nLooks * pValue;
+    if (test.confidence < 0.0) test.confidence = 0.0;
+
+    if (test.nLooks * pValue > test.alpha) return false;
+    test.decision = (z > 0) ? limitExcluded : limitAllowed;
+    return true;
+} // end limit_look
+
+
+
+double upper_limit(string limits, int iSR){
+    // e.g. "5.6, 7.1, 4.3" -> 7.1 for SR 1
+
+    stringstream limitstream(limits);
+    string limit;
+    for (int iField = 0; getline(limitstream, limit, ','); iField++)
+        if (iField == iSR) return atof(limit.c_str());
+    return 0.0;
+} // end upper_limit
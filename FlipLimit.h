@@ -0,0 +1,80 @@
+// FlipLimit.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPLIMIT_H_INCLUDED__
+#define __FLIPLIMIT_H_INCLUDED__
+
+// Early stop for points that are clearly excluded or clearly allowed. The
+// expected number of signal events in the SR is
+//      S = sigmaGen x luminosity x (sum of weights that passed) / # generated
+// and the point is excluded if S is above the upper limit on the number of
+// signal events in that SR (SUS-12-017 gives one per SR). A point far from
+// the limit doesn't need 20000 events to tell which side it's on.
+//
+// The weights already carry the branching ratios of the forced W decays 
+// (FlipWeights.h). Pythia 8 also multiplies sigmaGen by the open fraction
+// of the gluino pair, resOpenFrac(1000021, 1000021), which takes in the 
+// channels closed further down the chain (gluino -> top -> W). So that 
+// the BRs aren't counted twice, sigmaGen is divided by that fraction 
+// (openFraction below). The command file leaves the gluino and top decays
+// as they are, so all of it comes from the W. With TEMPLATE.cmnd it is 1:
+// oneChannel/addChannel give the W a new table with every channel open.
+//
+// The test looks at S and its uncertainty (statistical, plus the error on
+// sigmaGen) at 'first' generated events, then 2 x first, 4 x first, ... and
+// at the end of the run, and stops once S is above or below the limit at
+// the requested confidence. Since every look is another chance to be
+// wrong, each look is held to (1 - confidence) / (# looks) (Bonferroni).
+//
+// Settings (see addRecastSettings):
+//  RPVg:earlyStop = on, RPVg:upperLimits = the limits of the SRs in the
+//  order of fill_signalregions, comma separated, RPVg:luminosity (fb^-1),
+//  RPVg:stopConfidence, RPVg:stopFirstLook
+//
+// The decision and its confidence go into the cutflow record and output.dat.
+
+#include <string>
+#include <sstream>                  // for string stream
+#include <cmath>                    // for erfc, sqrt
+#include <cstdlib>                  // for atof
+using namespace std;
+
+enum limitdecision { limitUndecided, limitExcluded, limitAllowed };
+const char* const limit_decision_name[] =
+    { "undecided", "excluded", "allowed" };
+
+struct limittest{
+    // state of the sequential test for one run
+    double upperLimit;      // upper limit on the # signal events in the SR
+    double luminosity;      // integrated luminosity in fb^-1
+    double openFraction;    // taken out of the cross section (1: none)
+    double alpha;           // 1 - confidence: allowed chance of a wrong call
+    long nextLook;          // # generated events at the next look
+    int nLooks;             // # looks in all (for the Bonferroni correction)
+    int decision;           // see limitdecision
+    double confidence;      // confidence of the decision at the last look
+    double signal;          // expected # signal events at the last look
+    double signalError;     // ... and its uncertainty
+};
+
+
+void start_limit_test(limittest&, double, double, double, long, long, 
+    double = 1.0);
+// Inputs: test, upper limit (# events), luminosity (fb^-1), confidence,
+//  # events at the first look, # events in the run, open fraction that 
+//  Pythia put in the cross section (see above)
+
+bool limit_look(limittest&, long, double, double, double, double);
+// Inputs: test, # generated, sum of the weights that passed all cuts, sum
+//  of their squares, cross section and its error (mb, as Pythia's sigmaGen,
+//  before the open fraction is taken out)
+// Output: TRUE if the point is decided. Fills signal, signalError and
+//  confidence either way, and moves nextLook on.
+
+double upper_limit(string, int);
+// Inputs: the RPVg:upperLimits list, signal region #
+// Output: the limit for that SR, 0 if there's none
+
+
+// END INCLUDE GUARD
+#endif // __FLIPLIMIT_H_INCLUDED__
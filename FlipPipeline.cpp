@@ -0,0 +1,818 @@
+/********************************************************************************
+*   FlipPipeline.cpp                                                            *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the pipelined version of recast, see FlipPipeline.h                *
+*                                                                               *
+*   The ring: slot i of N starts with sequence i. A generator that sees        *
+*   sequence == position at the tail may claim it; once filled the slot gets   *
+*   sequence position+1, which is what the analysis threads look for at the     *
+*   head. Once analysed it gets position+N: free for the next round. All of    *
+*   the atomic operations are GCC's __sync builtins (full memory barriers).    *
+*   They work the same on memory shared with forked processes.                 *
+*                                                                               *
+*   Forked generators: the ring control, the counters, the packed slots and    *
+*   what each forked generator hands back at the end are all in one shared    *
+*   mapping, made before the fork (so it's at the same address everywhere).    *
+*   The forks happen before any thread is started.                              *
+********************************************************************************/
+
+#include "FlipPipeline.h"
+#include <sched.h>                  // for sched_yield
+#include <unistd.h>                 // for usleep, fork
+#include <sys/mman.h>               // for mmap
+#include <sys/wait.h>               // for waitpid
+#include <cstring>                  // for memset
+#include <cstdio>                   // for fflush
+#include <cstdlib>                  // for srand
+#include <cerrno>                   // for EINTR
+
+
+struct pipelinecounters{
+    // shared by all generators (in shared memory if some are forked)
+    volatile long nClaimed;         // # events the generators have started
+    volatile long nGenerated;       // # events generated (incl. vetoed)
+    volatile long nPassed;          // # events that passed all cuts
+    volatile long nOverflow;        // # events that didn't fit in a slot
+    volatile int nRunning;          // # generators that are still running
+                                    //  (forks: until reaped, see reap_forks)
+    volatile int aborted;           // too many errors, stop generating
+    volatile int lost;              // a forked generator died: stop
+};
+
+struct forkedresult{
+    // what a forked generator hands back (in shared memory): its veto's
+    //  counters. The veto's replica sums follow, nReplicas x (nStages+1).
+    volatile int finished;          // set last
+    int nVetoed;
+    double sumw;
+    double sumw2;
+    topologytally topologies;
+    long nReplicaEvents;
+};
+
+struct pipelinestate{
+    // shared by all of the threads of one recast_pipelined
+    eventring ring;
+    pipelinecounters* counters;     // local or in shared memory
+    int nEvent;                     // # events to generate
+    int batchSize;                  // # slots an analysis thread takes
+    int batchEvents;                // > 0: batched cuts, see FlipBatch.h
+    int nProfile;                   // # events to tune the cuts on (each)
+    Pythia8::ParticleData* particleData;    // to unpack events
+    bool histograms;                // fill cut stage histograms
+    bool topologies;                // sums per decay topology
+    bool replicas;                  // bootstrap replicas
+    uint64_t randomStream;          // efficiencies, see analyse_events
+    signalregion region;
+    vector<decaytable>* decays;
+    runstatus* status;
+    vector<pid_t> forks;            // forked generators (0: reaped) ...
+    char* results;                  // ... what they hand back ...
+    size_t resultBytes;             // ... one of this size each
+};
+
+struct generatorjob{
+    // the main Pythia object (main thread) or a forked copy of it
+    pipelinestate* state;
+    Pythia8::Pythia* pythia;
+    PartonVeto* veto;
+    bool isMain;                    // runs in the main thread: update status
+};
+
+struct analysisjob{
+    // one analysis thread
+    pipelinestate* state;
+    bool verbose;                   // report the tuned cut order
+    cuttally tally;                 // this thread's counts
+    histogramset histograms;        // ... and histograms
+    topologytally topologies;       // ... and sums per decay topology
+    replicatally replicas;          // ... and bootstrap replicas
+    eventbatch batch;               // ... and block of events (batched cuts)
+    ringslot unpacked;              // ... and a packed event, unpacked
+    uint64_t random;                // ... and random number state
+};
+
+
+
+void wait_turn(int& nWait){
+    // Spin politely: give up the CPU, and sleep if it takes a while
+
+    if (++nWait < 50) sched_yield();
+    else usleep(100);
+} // end wait_turn
+
+
+
+void init_ring(ringcontrol& ring, volatile long* sequence, int nSlot){
+    ring.nSlot = nSlot;
+    ring.sequence = sequence;
+    for (int iSlot = 0; iSlot < nSlot; iSlot++)
+        ring.sequence[iSlot] = iSlot;
+    ring.head = 0;
+    ring.tail = 0;
+    __sync_synchronize();
+} // end init_ring
+
+
+
+long ring_claim_push(ringcontrol& ring, int& nWait){
+    // Back-pressure: if the ring is full, wait a turn and say so
+
+    long nSlot = ring.nSlot;
+
+    for (;;){
+        long position = ring.tail;
+        long sequence = ring.sequence[position % nSlot];
+
+        if (sequence == position){
+            if (__sync_bool_compare_and_swap(&ring.tail, position, position+1))
+                return position;
+        }
+        else if (sequence < position){                      // ring is full
+            wait_turn(nWait);
+            return -1;
+        }
+        // else another generator got there first: try the next position
+    }
+} // end ring_claim_push
+
+
+
+void ring_push(ringcontrol& ring, long position){
+    __sync_synchronize();           // the contents first ...
+    ring.sequence[position % ring.nSlot] = position + 1;    // ... then the flag
+} // end ring_push
+
+
+
+int ring_claim_pop(ringcontrol& ring, int maxSlot, long& first){
+    // Take as many filled slots (up to maxSlot) as are ready in a row
+
+    long nSlot = ring.nSlot;
+    if (maxSlot > nSlot) maxSlot = nSlot;
+
+    for (;;){
+        long position = ring.head;
+        int nFilled = 0;
+        while ( (nFilled < maxSlot) &&
+            (ring.sequence[(position + nFilled) % nSlot] ==
+                position + nFilled + 1) ) nFilled++;
+
+        if (nFilled == 0){
+            if (ring.head == position) return 0;    // empty
+            continue;                               // someone else took it
+        }
+
+        if (__sync_bool_compare_and_swap(&ring.head, position,
+            position + nFilled)){
+            __sync_synchronize();
+            first = position;
+            return nFilled;
+        }
+    }
+} // end ring_claim_pop
+
+
+
+void ring_release(ringcontrol& ring, long first, int nClaimed){
+    long nSlot = ring.nSlot;
+    __sync_synchronize();           // done reading before we hand them back
+    for (long position = first; position < first + nClaimed; position++)
+        ring.sequence[position % nSlot] = position + nSlot;
+} // end ring_release
+
+
+
+bool ring_skip_hole(ringcontrol& ring){
+    // Only once no generator is left: a claimed slot at the head that was 
+    // never filled is skipped. FALSE if the ring is empty.
+
+    long position = ring.head;
+    if (position == ring.tail) return false;
+    if (ring.sequence[position % ring.nSlot] == position &&
+        __sync_bool_compare_and_swap(&ring.head, position, position + 1))
+        ring_release(ring, position, 1);
+    return true;                    // (or someone else took it)
+} // end ring_skip_hole
+
+
+
+int pack_particles(packedparticle* particles, int room, Pythia8::Event& event){
+    // The final state particles that fit; returns how many there are
+
+    int nFinal = 0;
+    for (int iPart = 0; iPart < event.size(); iPart++){
+        if (!event[iPart].isFinal()) continue;
+        if (nFinal < room){
+            packedparticle& particle = particles[nFinal];
+            particle.id     = event[iPart].id();
+            particle.status = event[iPart].status();
+            particle.px     = event[iPart].px();
+            particle.py     = event[iPart].py();
+            particle.pz     = event[iPart].pz();
+            particle.e      = event[iPart].e();
+            particle.m      = event[iPart].m();
+        }
+        nFinal++;
+    } // end loop over particles
+    return nFinal;
+} // end pack_particles
+
+
+
+bool pack_event(packedevent* slot, int maxParticles,
+    vector< pair<int,fastjet::PseudoJet> >& leptons, Pythia8::Event* event,
+    Pythia8::Event& process, double weight, int topology){
+    // Layout: see packedevent
+
+    packedlepton* packedLeptons = (packedlepton*)(slot + 1);
+    packedparticle* particles = (packedparticle*)(packedLeptons + maxPackedLeptons);
+    bool fits = true;
+
+    slot->weight    = weight;
+    slot->topology  = topology;
+    slot->nLeptons  = leptons.size();
+    if (slot->nLeptons > maxPackedLeptons){
+        slot->nLeptons = maxPackedLeptons;
+        fits = false;
+    }
+    for (int iLep = 0; iLep < slot->nLeptons; iLep++){
+        packedLeptons[iLep].id  = leptons[iLep].first;
+        packedLeptons[iLep].px  = leptons[iLep].second.px();
+        packedLeptons[iLep].py  = leptons[iLep].second.py();
+        packedLeptons[iLep].pz  = leptons[iLep].second.pz();
+        packedLeptons[iLep].e   = leptons[iLep].second.e();
+    }
+
+    int nProcess = pack_particles(particles, maxParticles, process);
+    if (nProcess > maxParticles){
+        nProcess = maxParticles;
+        fits = false;
+    }
+    slot->nProcess = nProcess;
+
+    slot->nEvent = 0;
+    if (event){
+        int room = maxParticles - nProcess;
+        slot->nEvent = pack_particles(particles + nProcess, room, *event);
+        if (slot->nEvent > room){
+            slot->nEvent = room;
+            fits = false;
+        }
+    }
+    return fits;
+} // end pack_event
+
+
+
+void unpack_event(packedevent* slot, ringslot& unpacked){
+    packedlepton* packedLeptons = (packedlepton*)(slot + 1);
+    packedparticle* particles = (packedparticle*)(packedLeptons + maxPackedLeptons);
+
+    unpacked.weight     = slot->weight;
+    unpacked.topology   = slot->topology;
+    unpacked.leptons.resize(slot->nLeptons);
+    for (int iLep = 0; iLep < slot->nLeptons; iLep++){
+        packedlepton& lepton = packedLeptons[iLep];
+        unpacked.leptons[iLep].first = lepton.id;
+        unpacked.leptons[iLep].second = fastjet::PseudoJet(lepton.px,
+            lepton.py, lepton.pz, lepton.e);
+    }
+
+    unpacked.process.clear();
+    for (int iPart = 0; iPart < slot->nProcess; iPart++){
+        packedparticle& p = particles[iPart];
+        unpacked.process.append(p.id, p.status, 0, 0, 0, 0, 0, 0,
+            p.px, p.py, p.pz, p.e, p.m);
+    }
+    unpacked.event.clear();
+    for (int iPart = slot->nProcess; iPart < slot->nProcess + slot->nEvent; 
+        iPart++){
+        packedparticle& p = particles[iPart];
+        unpacked.event.append(p.id, p.status, 0, 0, 0, 0, 0, 0,
+            p.px, p.py, p.pz, p.e, p.m);
+    }
+} // end unpack_event
+
+
+
+void* shared_memory(size_t bytes){
+    void* memory = mmap(0, bytes, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return 0;
+    memset(memory, 0, bytes);
+    return memory;
+} // end shared_memory
+
+
+
+void free_shared_memory(void* memory, size_t bytes){
+    if (memory) munmap(memory, bytes);
+} // end free_shared_memory
+
+
+
+size_t align_shared(size_t bytes){
+    // 16: enough for any type here
+    return (bytes + 15) / 16 * 16;
+} // end align_shared
+
+
+
+void reap_forks(pipelinestate& state, bool wait){
+    // A fork that dies can't say so: without this the analysis threads
+    // would wait for it forever. Only the main thread calls this.
+
+    for (unsigned int iFork = 0; iFork < state.forks.size(); iFork++){
+        if (state.forks[iFork] == 0) continue;
+        int forkStatus = 0;
+        pid_t pid;
+        do pid = waitpid(state.forks[iFork], &forkStatus, wait ? 0 : WNOHANG);
+        while (pid < 0 && errno == EINTR);
+        if (pid == 0) continue;                 // still running
+        state.forks[iFork] = 0;
+
+        forkedresult* result = 
+            (forkedresult*)(state.results + iFork * state.resultBytes);
+        if (!result->finished){
+            cout << endl << "ERROR: forked generator " << iFork 
+                << " died, its events are lost" << endl;
+            state.counters->lost = 1;
+        }
+        __sync_fetch_and_sub(&state.counters->nRunning, 1);
+    } // end loop over forks
+} // end reap_forks
+
+
+
+void* generate_events(void* input){
+    // The generator loop: the same bookkeeping as in recast, except that
+    // nEvent is shared by all generators
+
+    generatorjob& job = *(generatorjob*)input;
+    pipelinestate& state = *job.state;
+    ringcontrol& ring = *state.ring.control;
+    Pythia8::Pythia& pythia = *job.pythia;
+    PartonVeto* veto = job.veto;
+
+    int nAbort = pythia.mode("Main:timesAllowErrors");
+    int iAbort = 0;
+    int nVetoed = 0;
+    vector< pair<int,fastjet::PseudoJet> > leptons;     // to pack
+
+    while (!state.counters->aborted && !state.counters->lost &&
+        __sync_fetch_and_add(&state.counters->nClaimed, 1) < state.nEvent){
+
+        bool generated = pythia.next();
+
+        if (veto && veto->nVetoed > nVetoed){   // events we never saw
+            __sync_fetch_and_add(&state.counters->nClaimed, veto->nVetoed - nVetoed);
+            __sync_fetch_and_add(&state.counters->nGenerated, veto->nVetoed - nVetoed);
+            nVetoed = veto->nVetoed;
+        }
+
+        if (!generated){
+            if (job.isMain && state.status) update_status(*state.status,
+                state.counters->nGenerated, state.counters->nPassed, iAbort+1);
+            if (++iAbort < nAbort) continue;
+            cout << " Event generation aborted prematurely, owing to error!\n";
+            state.counters->aborted = 1;
+            break;
+        }
+
+        double weight = event_weight(pythia.info, pythia.process, state.decays);
+        int topology = state.topologies ? decay_topology(pythia.process) : 0;
+
+        // Copy what the cuts need. Without two leptons the lepton unit
+        // fails before it looks at the hadrons, so we skip the big copy.
+        // While the ring is full the main generator looks after the forks.
+        long position;
+        int nWait = 0;
+        while ((position = ring_claim_push(ring, nWait)) < 0){
+            if (job.isMain) reap_forks(state, false);
+            if (state.counters->aborted || state.counters->lost) break;
+        }
+        if (position < 0) break;
+        long iSlot = position % ring.nSlot;
+        if (state.ring.packed){
+            leptons.clear();
+            grabLeptons(pythia.event, leptons);
+            packedevent* slot = 
+                (packedevent*)(state.ring.packed + iSlot * state.ring.slotBytes);
+            if (!pack_event(slot, state.ring.maxParticles, leptons,
+                (leptons.size() >= 2) ? &pythia.event : 0, pythia.process,
+                weight, topology))
+                __sync_fetch_and_add(&state.counters->nOverflow, 1);
+        }
+        else{
+            ringslot& slot = state.ring.slots[iSlot];
+            slot.leptons.clear();
+            grabLeptons(pythia.event, slot.leptons);
+            slot.process = pythia.process;
+            if (slot.leptons.size() >= 2) slot.event = pythia.event;
+            slot.weight = weight;
+            slot.topology = topology;
+        }
+        ring_push(ring, position);
+
+        __sync_fetch_and_add(&state.counters->nGenerated, 1);
+        if (job.isMain && state.status) update_status(*state.status,
+            state.counters->nGenerated, state.counters->nPassed, iAbort);
+        if (job.isMain) reap_forks(state, false);
+    } // end loop over events
+
+    // A fork is counted out when it's reaped, dead or not
+    if (job.isMain) __sync_fetch_and_sub(&state.counters->nRunning, 1);
+    return 0;
+} // end generate_events
+
+
+
+void* analyse_events(void* input){
+    // Batches of events from the ring through the cut chain. The random
+    // numbers of the efficiencies start over for each event, from the
+    // stream and its position in the ring, so it doesn't matter which 
+    // thread gets it. Batched cuts draw from the thread's own state.
+
+    analysisjob& job = *(analysisjob*)input;
+    pipelinestate& state = *job.state;
+    ringcontrol& ring = *state.ring.control;
+    cutorder order(state.nProfile, job.verbose);
+    if (state.histograms) init_histograms(job.histograms, nCutStages);
+    histogramset* histograms = state.histograms ? &job.histograms : 0;
+    topologytally* topologies = state.topologies ? &job.topologies : 0;
+    replicatally* replicas = state.replicas ? &job.replicas : 0;
+    if (state.batchEvents > 0) init_batch(job.batch, state.batchEvents);
+    job.batch.randomState = &job.random;
+    if (state.ring.packed){
+        job.unpacked.event.init("unpacked event", state.particleData);
+        job.unpacked.process.init("unpacked process", state.particleData);
+    }
+    int nWait = 0;
+
+    for (;;){
+        long first;
+        int nClaimed = ring_claim_pop(ring, state.batchSize, first);
+
+        if (nClaimed == 0){
+            // All done if the generators had stopped before we looked. If
+            // one of them died, the slots it claimed are never filled:
+            // skip them, the events after them are still good.
+            bool finished = (state.counters->nRunning == 0);
+            __sync_synchronize();
+            nClaimed = ring_claim_pop(ring, state.batchSize, first);
+            if (nClaimed == 0 && finished){
+                if (state.counters->lost && ring_skip_hole(ring)) continue;
+                break;
+            }
+            if (nClaimed == 0){
+                wait_turn(nWait);
+                continue;
+            }
+        }
+        nWait = 0;
+
+        for (long position = first; position < first + nClaimed; position++){
+            long iSlot = position % ring.nSlot;
+            ringslot* slot = &job.unpacked;
+            if (state.ring.packed) unpack_event(
+                (packedevent*)(state.ring.packed + iSlot * state.ring.slotBytes),
+                job.unpacked);
+            else slot = &state.ring.slots[iSlot];
+
+            if (state.batchEvents > 0){
+                // Copied out of the slot, so it can go back right away
+                add_to_batch(job.batch, slot->leptons, &slot->event,
+                    slot->process, slot->weight, slot->topology);
+                if (!batch_full(job.batch)) continue;
+                int nPassed = job.tally.nPassed;
+                flush_batch(job.batch, state.region, job.tally, histograms,
+                    topologies, replicas);
+                __sync_fetch_and_add(&state.counters->nPassed, job.tally.nPassed - nPassed);
+                continue;
+            }
+
+            eventobjects objects;
+            objects.leptons     = slot->leptons;
+            objects.event       = &slot->event;
+            objects.process     = &slot->process;
+            objects.haveProcess = false;
+            objects.unitsApplied = 0;
+            objects.stagesPassed = 0;
+            objects.random      = &job.random;
+            objects.keepStages  = state.histograms;
+            objects.uMET        = -1.0;
+            objects.uHT         = -1.0;
+            job.random = state.randomStream 
+                ^ ((uint64_t)position * 0xD1B54A32D192ED03UL);
+
+            int reached = cut_event(objects, state.region, order);
+            tally_event(job.tally, reached, slot->weight, objects.tunedStop);
+            if (state.histograms) fill_event_histograms(job.histograms, 
+                objects, reached, slot->weight);
+            if (state.topologies) tally_topology(job.topologies, slot->topology,
+                reached == nCutStages, slot->weight);
+            if (state.replicas) tally_replicas(job.replicas, reached, 
+                slot->weight);
+            if (reached == nCutStages) __sync_fetch_and_add(&state.counters->nPassed, 1);
+        } // end loop over claimed slots
+
+        ring_release(ring, first, nClaimed);
+    }
+
+    int nPassed = job.tally.nPassed;        // what's left of the last block
+    flush_batch(job.batch, state.region, job.tally, histograms, topologies,
+        replicas);
+    __sync_fetch_and_add(&state.counters->nPassed, job.tally.nPassed - nPassed);
+    estimate_rows(job.tally, order);        // with this thread's profile
+
+    return 0;
+} // end analyse_events
+
+
+
+void run_forked_generator(generatorjob& job, int iFork, forkedresult& result,
+    double* replicaSums){
+    // In the forked process: generate, then hand the veto's counters back.
+    // Never returns.
+
+    // Its own counts from zero, and its own replica stream
+    PartonVeto* veto = job.veto;
+    stringstream name;
+    name << "fork" << iFork;
+    reset_veto(veto, name.str());
+
+    generate_events(&job);
+
+    if (veto){
+        result.nVetoed      = veto->nVetoed;
+        result.sumw         = veto->sumw;
+        result.sumw2        = veto->sumw2;
+        result.topologies   = veto->topologies;
+        result.nReplicaEvents = veto->replicas.nEvents;
+        pack_replicas(veto->replicas, replicaSums);
+    }
+    __sync_synchronize();
+    result.finished = 1;
+    cout.flush();
+    _exit(0);           // no destructors, no atexit: they're the parent's
+} // end run_forked_generator
+
+
+
+double recast_pipelined(
+    Pythia8::Pythia& pythia,                // main Pythia object
+    vector<cutcount> &counts,               // intermediate data (for checking)
+    int iSR,                                // Signal Region #
+    int nEvent,                             // # events, for all generators
+    pipelinesetup& setup,                   // threads, see header
+    const recastextras& extras              // optional extras, see recast
+    ){
+
+    vector<signalregion> signal_region;
+    fill_signalregions(signal_region);
+
+    pipelinestate state;
+    pipelinecounters localCounters;
+    state.counters      = &localCounters;
+    state.nEvent        = nEvent;
+    state.batchSize     = setup.batchSize;
+    state.batchEvents   = pythia.mode("RPVg:batchEvents");
+    state.nProfile      = 0;
+    state.particleData  = &pythia.particleData;
+    state.region        = signal_region[iSR];
+    state.decays        = extras.decays;
+    state.status        = extras.status;
+    state.histograms    = (extras.histograms != 0);
+    state.topologies    = (extras.topologies != 0);
+    state.replicas      = (extras.replicas != 0);
+
+    // The efficiencies don't use rand(), which the threads would share: 
+    // their own stream, new for every round since the positions start over
+    uint64_t stream = (setup.seed != 0) ? setup.seed : (uint64_t)time(0);
+    stringstream streamName;
+    streamName << "efficiencies" << setup.nRounds;
+    state.randomStream = replica_stream(stream, streamName.str());
+
+    // Each analysis thread tunes its own order on its share of tuneEvents
+    // (not with histograms or replicas, see tune_cut_order)
+    if (pythia.flag("RPVg:tuneCuts") && !state.histograms && !state.replicas)
+        state.nProfile = max(1, pythia.mode("RPVg:tuneEvents") / setup.nAnalysis);
+
+
+    // THE RING
+    // --------
+    // Copies of the events in this process, or packed events in shared
+    // memory: control, counters, sequences, slots, then one result per fork
+    //
+    int nForks = max(0, setup.nForks);
+    int nReplicaSums = 0;
+    if (extras.veto && extras.veto->replicas.nReplicas > 0)
+        nReplicaSums = extras.veto->replicas.nReplicas
+            * (extras.veto->replicas.nStages + 1);
+    size_t resultBytes = align_shared(sizeof(forkedresult)
+        + nReplicaSums * sizeof(double));
+    size_t sharedBytes = 0;
+    char* shared = 0;
+    state.ring.packed = 0;
+    state.ring.maxParticles = setup.maxParticles;
+    state.ring.slotBytes = align_shared(sizeof(packedevent)
+        + maxPackedLeptons * sizeof(packedlepton)
+        + setup.maxParticles * sizeof(packedparticle));
+
+    if (nForks > 0){
+        sharedBytes = align_shared(sizeof(ringcontrol)) 
+            + align_shared(sizeof(pipelinecounters))
+            + align_shared(setup.ringSize * sizeof(long))
+            + setup.ringSize * state.ring.slotBytes + nForks * resultBytes;
+        shared = (char*)shared_memory(sharedBytes);
+        if (!shared){
+            cout << endl << "ERROR: no shared memory for the forked generators,"
+                << " running without them" << endl;
+            nForks = 0;
+        }
+    }
+    
+    volatile long* sequence;
+    if (shared){
+        char* next = shared;
+        state.ring.control = (ringcontrol*)next;
+        next += align_shared(sizeof(ringcontrol));
+        state.counters = (pipelinecounters*)next;
+        next += align_shared(sizeof(pipelinecounters));
+        sequence = (volatile long*)next;
+        next += align_shared(setup.ringSize * sizeof(long));
+        state.ring.packed = next;
+    }
+    else{
+        state.ring.control = &state.ring.localControl;
+        state.ring.localSequence.resize(setup.ringSize);
+        state.ring.slots.resize(setup.ringSize);
+        sequence = &state.ring.localSequence[0];
+    }
+    init_ring(*state.ring.control, sequence, setup.ringSize);
+    
+    state.counters->nClaimed    = 0;
+    state.counters->nGenerated  = 0;
+    state.counters->nPassed     = 0;
+    state.counters->nOverflow   = 0;
+    state.counters->nRunning    = 1 + nForks;
+    state.counters->aborted     = 0;
+    state.counters->lost        = 0;
+    state.results               = 0;
+    state.resultBytes           = resultBytes;
+
+
+    // FORK THE GENERATORS
+    // -------------------
+    // Before any thread is started: a forked process only gets the thread
+    // that called fork
+    //
+    generatorjob mainjob;
+    mainjob.state   = &state;
+    mainjob.pythia  = &pythia;
+    mainjob.veto    = extras.veto;
+    mainjob.isMain  = true;
+
+    if (shared) state.results = state.ring.packed 
+        + setup.ringSize * state.ring.slotBytes;
+    vector<pid_t>& forks = state.forks;
+    cout.flush();
+    fflush(0);
+    for (int iFork = 0; iFork < nForks; iFork++){
+        pid_t pid = fork();
+        if (pid == 0){
+            reseed_generator(pythia, setup.seed, iFork, setup.nRounds);
+            generatorjob job = mainjob;
+            job.isMain = false;
+            forkedresult* result = 
+                (forkedresult*)(state.results + iFork * resultBytes);
+            run_forked_generator(job, iFork, *result, (double*)(result + 1));
+        }
+        if (pid < 0){
+            cout << endl << "ERROR: fork failed, " << iFork 
+                << " forked generators" << endl;
+            __sync_fetch_and_sub(&state.counters->nRunning, nForks - iFork);
+            break;
+        }
+        forks.push_back(pid);
+    }
+
+
+    // START THE THREADS
+    // -----------------
+    vector<analysisjob> analysis(setup.nAnalysis);
+    vector<pthread_t> analysisThreads(setup.nAnalysis);
+    for (int iThread = 0; iThread < setup.nAnalysis; iThread++){
+        analysis[iThread].state = &state;
+        analysis[iThread].verbose = (iThread == 0);
+        stringstream threadName;
+        threadName << "thread" << iThread;
+        analysis[iThread].random = replica_stream(state.randomStream, 
+            threadName.str());
+        if (extras.replicas){
+            // Own stream per thread and round (the total grows each round)
+            stringstream name;
+            name << "thread" << iThread << ":" << extras.replicas->nEvents;
+            init_replicas(analysis[iThread].replicas, extras.replicas->nReplicas,
+                nCutStages, replica_stream(extras.replicas->stream, name.str()));
+        }
+        pthread_create(&analysisThreads[iThread], 0, analyse_events,
+            &analysis[iThread]);
+    }
+
+    // The main Pythia object runs here (and reaps forks as it goes) ...
+    generate_events(&mainjob);
+    reap_forks(state, true);            // ... then waits for the rest
+
+    for (unsigned int iThread = 0; iThread < analysisThreads.size(); iThread++)
+        pthread_join(analysisThreads[iThread], 0);
+
+
+    // COMBINE
+    // -------
+    cuttally tally;
+    for (unsigned int iThread = 0; iThread < analysis.size(); iThread++)
+        add_tally(tally, analysis[iThread].tally);
+    
+    if (extras.histograms){
+        if (extras.histograms->hist.empty())
+            init_histograms(*extras.histograms, nCutStages);
+        for (unsigned int iThread = 0; iThread < analysis.size(); iThread++)
+            add_histograms(*extras.histograms, analysis[iThread].histograms);
+    }
+    if (extras.topologies)
+        for (unsigned int iThread = 0; iThread < analysis.size(); iThread++)
+            add_topologies(*extras.topologies, analysis[iThread].topologies);
+    if (extras.replicas)
+        for (unsigned int iThread = 0; iThread < analysis.size(); iThread++)
+            add_replicas(*extras.replicas, analysis[iThread].replicas);
+
+    int nVetoed = 0;
+    if (extras.veto){
+        nVetoed += extras.veto->nVetoed;
+        tally.nStage[cutGenerated] += extras.veto->nVetoed;
+        tally.sumw[cutGenerated] += extras.veto->sumw;
+        tally.sumw2[cutGenerated] += extras.veto->sumw2;
+        if (extras.topologies)
+            add_topologies(*extras.topologies, extras.veto->topologies);
+        if (extras.replicas)
+            add_replicas(*extras.replicas, extras.veto->replicas);
+    }
+    
+    // The vetoes of the forked generators: their counters came back in
+    // shared memory, replicas as [generated, sumw]
+    for (unsigned int iFork = 0; extras.veto && iFork < forks.size(); iFork++){
+        forkedresult* result = 
+            (forkedresult*)(state.results + iFork * resultBytes);
+        if (!result->finished) continue;
+        nVetoed += result->nVetoed;
+        tally.nStage[cutGenerated] += result->nVetoed;
+        tally.sumw[cutGenerated] += result->sumw;
+        tally.sumw2[cutGenerated] += result->sumw2;
+        if (extras.topologies)
+            add_topologies(*extras.topologies, result->topologies);
+        if (extras.replicas && nReplicaSums > 0){
+            replicatally replicas = extras.veto->replicas;
+            replicas.nEvents = result->nReplicaEvents;
+            unpack_replicas((double*)(result + 1), replicas);
+            add_replicas(*extras.replicas, replicas);
+        }
+    }
+    if (extras.veto)
+        cout << endl << " " << nVetoed << " events vetoed at parton level" << endl;
+    if (state.counters->nOverflow > 0)
+        cout << endl << "WARNING: " << state.counters->nOverflow << " events"
+            << " had more final state particles than RPVg:sharedParticles = "
+            << setup.maxParticles << ", the rest were dropped" << endl;
+
+    free_shared_memory(shared, sharedBytes);
+    setup.nRounds++;
+
+    fill_counts(counts, tally, signal_region[iSR]);
+
+    return tally.sumwPassed;
+} // end recast_pipelined
+
+
+
+long generator_seed(long seed, int iGenerator){
+    // Like shard_seed (FlipCutflow.h), different for each generator
+
+    if (seed == 0) seed = (long)time(0);
+    stringstream text;
+    text << seed << ":generator" << iGenerator;
+    return (long)(fnv1a(text.str()) % 900000000UL) + 1;
+} // end generator_seed
+
+
+
+void reseed_generator(Pythia8::Pythia& pythia, long seed, int iCopy, 
+    int nRounds){
+    // Only the random number generators: everything else init() set up
+    // stays as it is
+
+    long copySeed = generator_seed(seed, 1 + iCopy + 1000 * nRounds);
+    pythia.rndm.init(copySeed);
+    srand((unsigned)copySeed);
+} // end reseed_generator
@@ -0,0 +1,183 @@
+// FlipPipeline.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPPIPELINE_H_INCLUDED__
+#define __FLIPPIPELINE_H_INCLUDED__
+
+// Pipelined running: in recast, pythia.next() and the cuts take turns. Here
+// generators (the main Pythia object, and forked copies of it) copy what
+// the cuts need into a ring of preallocated slots, and analysis threads 
+// take batches of slots out of the ring and run the cut chain on them. When
+// the ring is full the generators wait, so memory stays flat however slow
+// the analysis is.
+//
+// The ring has no locks: generators and analysis threads claim slots by
+// compare-and-swap on a position counter, and each slot has a sequence
+// number that says whose turn it is (the bounded queue of D. Vyukov).
+//
+// Settings (see addRecastSettings):
+//  RPVg:analysisThreads = 0 runs the old loop in recast; > 0 runs this.
+//  RPVg:generators is the number of generators, main one included.
+//
+// Random numbers: the efficiencies don't draw from rand() here, which the
+// analysis threads would share. Each event gets its own splitmix64 stream
+// from RPVg:seed and its position in the ring, so a seeded run with one
+// generator gives the same result whatever the # analysis threads (but not
+// the same as recast, which uses rand()). With more generators the order
+// the events arrive in, and with batched cuts the blocks, depend on 
+// timing; the statistics are the same.
+//
+// Forked generators: Pythia 8.165 isn't thread safe, so the extra 
+// generators are not Pythia objects in threads of this process but forked
+// copies of the initialized main Pythia object. They share its memory
+// (settings, particle data, SLHA tables and PDF grids; copy on write: only
+// what a generator changes, its random numbers and event records, gets its
+// own pages) and are reseeded one by one. Their events come back packed, 
+// as plain arrays of the final state particles, through a ring in shared
+// memory (the main generator packs its events too); the analysis threads
+// unpack them. If a forked generator dies, the main one notices (it polls
+// with waitpid) and the run stops with the events made so far, minus the 
+// ones the dead generator never finished. Settings:
+//  RPVg:sharedParticles = N    room for N final state particles per event
+//                              (the rest are dropped and counted)
+
+#include "FlipApplyCuts.h"          // for the cut chain
+#include "FlipBatch.h"              // for the batched cuts
+#include <pthread.h>                // for threads
+using namespace std;
+
+struct ringcontrol{
+    // positions in the ring; in shared memory with forked generators
+    volatile long head;             // next position to take out
+    volatile long tail;             // next position to put in
+    long nSlot;                     // # slots
+    volatile long* sequence;        // whose turn each slot is, see .cpp
+};
+
+struct ringslot{
+    // one event on its way from a generator to an analysis thread
+    Pythia8::Event event;           // copy of pythia.event (only if needed)
+    Pythia8::Event process;         // copy of pythia.process
+    vector< pair<int,fastjet::PseudoJet> > leptons;     // from grabLeptons
+    double weight;                  // event weight, see event_weight
+    int topology;                   // decay topology (efficiency maps only)
+};
+
+struct packedparticle{
+    // a final state particle, as much of it as the cuts look at
+    int id;
+    int status;
+    double px, py, pz, e, m;
+};
+
+struct packedlepton{
+    // a lepton from grabLeptons
+    int id;
+    double px, py, pz, e;
+};
+
+struct packedevent{
+    // a slot of the shared ring: this, then maxPackedLeptons leptons, then
+    //  the particles (process first, then event)
+    double weight;                  // event weight, see event_weight
+    int topology;                   // decay topology (efficiency maps only)
+    int nLeptons;
+    int nProcess;                   // # final state particles of process ...
+    int nEvent;                     // ... and of event (0 if not needed)
+};
+
+const int maxPackedLeptons = 32;
+
+struct eventring{
+    // bounded ring of slots, shared by all threads. Holds either copies of
+    //  the Pythia events, or (forked generators) packed events in memory
+    //  that is shared with the forked processes, control included.
+    ringcontrol* control;
+    vector<ringslot> slots;         // copies of the events ...
+    char* packed;                   // ... or packed events, slotBytes each
+    size_t slotBytes;
+    int maxParticles;               // room in a packed slot
+    ringcontrol localControl;       // control and sequences of a ring that
+    vector<long> localSequence;     //  isn't shared
+};
+
+struct pipelinesetup{
+    // what recast_pipelined needs besides the main Pythia object
+    int nAnalysis;                          // # analysis threads
+    int ringSize;                           // # slots in the ring
+    int batchSize;                          // # slots taken out at once
+    int nForks;                             // # forked generators
+    int maxParticles;                       // ... room in a packed event
+    long seed;                              // ... their seeds come from this
+    int nRounds;                            // ... and the # earlier calls
+    pipelinesetup() : nAnalysis(1), ringSize(64), batchSize(8), nForks(0),
+        maxParticles(4000), seed(0), nRounds(0) {}
+};
+
+
+void init_ring(ringcontrol&, volatile long*, int);
+// Inputs: control, sequences (one per slot), # slots
+
+long ring_claim_push(ringcontrol&, int&);
+// Inputs: ring, # turns waited so far (0 to start with)
+// Claims a free slot for filling. If the ring is full it waits a turn.
+// Output: its position (the slot is position % nSlot), -1 if full
+
+void ring_push(ringcontrol&, long);
+// Hands the filled slot at this position to the analysis threads
+
+int ring_claim_pop(ringcontrol&, int, long&);
+// Inputs: ring, max # slots, first position (output)
+// Output: # filled slots claimed, starting at the first position. 0 if the
+//  ring is empty right now.
+
+void ring_release(ringcontrol&, long, int);
+// Inputs: ring, first position, # slots. Gives the slots back to the
+//  generators once they've been analysed.
+
+bool ring_skip_hole(ringcontrol&);
+// Skips the slot at the head if it was claimed but never filled (by a 
+//  generator that died). Only when no generator is running any more.
+// Output: FALSE if the ring is empty
+
+bool pack_event(packedevent*, int, vector< pair<int,fastjet::PseudoJet> >&,
+    Pythia8::Event*, Pythia8::Event&, double, int);
+// Inputs: slot, room for particles, leptons, pythia.event (or null if not
+//  needed), pythia.process, weight, topology
+// Output: FALSE if some particles didn't fit (the last ones are dropped)
+
+void unpack_event(packedevent*, ringslot&);
+// Unpacks a slot into copies of the events. The events of the ringslot
+//  have to be initialized with the particle data (for isVisible).
+
+void* shared_memory(size_t);
+// Output: that many bytes of zeroed memory that forked processes share
+//  with us, or null. Give it back with free_shared_memory.
+
+void free_shared_memory(void*, size_t);
+
+size_t align_shared(size_t);
+// Rounds a # bytes up, so that whatever comes after it in shared memory is
+//  aligned for any type
+
+
+double recast_pipelined(Pythia8::Pythia&, vector<cutcount>&, int, int,
+    pipelinesetup&, const recastextras& = recastextras());
+// Same as recast (see FlipApplyCuts.h), with the main Pythia object (and
+//  setup.nForks forked copies of it) generating and setup.nAnalysis threads
+//  doing the cuts. The main thread runs the main Pythia object and updates
+//  the status.
+
+long generator_seed(long, int);
+// Inputs: seed of the main Pythia object (0: time-based), generator #
+// Output: seed for the forked generator, in [1, 900000000]
+
+void reseed_generator(Pythia8::Pythia&, long, int, int);
+// Inputs: forked copy of the initialized Pythia object, seed of the main
+//  one (0: time-based), copy # (from 0), # earlier rounds
+// Reseeds its random numbers, and rand() for the efficiencies, with 
+//  generator_seed: every copy and round gets its own
+
+
+// END INCLUDE GUARD
+#endif // __FLIPPIPELINE_H_INCLUDED__
@@ -0,0 +1,519 @@
+/******************************************************************************** 
+*   FlipRunPoint.cpp                                                            *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains run_point: everything RPVgPoint does for one point, so that it    *
+*   can also be done by the workers of RPVgServer                               *
+*                                                                               *
+*   1.  Patch the templates with the masses of the point                       *
+*   2.  Look the run up in the result cache                                     *
+*   3.  Set up Pythia (seeds, forced decays, veto, pipeline) and initialize     *
+*   4.  Run recast, until the target precision if there is one (or until the  *
+*       point is clearly excluded or allowed, with the early stop)             *
+*   5.  Write output.dat, the cutflow record and histograms; clean up           *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipRunPoint.h"
+
+
+
+void start_veto_replicas(vector<PartonVeto*> vetoes, replicatally& replicas){
+    // Every veto gets its own stream, and a new one each round: the total
+    // has grown by then
+
+    for (unsigned int iVeto = 0; iVeto < vetoes.size(); iVeto++){
+        if (!vetoes[iVeto]) continue;
+        stringstream name;
+        name << "veto" << iVeto << ":" << replicas.nEvents;
+        init_replicas(vetoes[iVeto]->replicas, replicas.nReplicas, 
+            replicas.nStages, replica_stream(replicas.stream, name.str()));
+    }
+} // end start_veto_replicas
+
+
+
+int run_point(pointjob& job, cutflowrecord& record, Pythia8::Pythia* warm){
+
+    /****************************************************************************
+    * DEFINE AND INITIALIZE PARAMETERS                                          *
+    ****************************************************************************/
+
+    double startTime    = wallclock();          // for the timing file
+    string& mstop       = job.mstop;            // stop mass
+    string& mgluino     = job.mgluino;          // gluino mass
+    int iSR             = job.iSR;              // signal region
+    string& cmndtemp    = job.cmndtemp;         // template command file
+    string& spctemp     = job.spctemp;          // template spectrum file
+    string& outfile     = job.outfile;          // output filename
+    vector<string>& settings = job.settings;    // read after the cmnd file
+    vector<cutcount> counts;                // counts @ each cut w/ descriptions
+    vector<string> tempfiles;               // Intermediate files to be deleted
+
+    // Intermediate files, e.g. TEMP.job3.spc for tag ".job3"
+    // ---------------------------------------------------------
+    string cmndrun      = "CommandRun" + job.tag + ".cmnd"; // cmnd file for run
+    string spcint       = "TEMP" + job.tag + ".spc";        // intermediate spc
+    string spcRun       = "spcRun" + job.tag + ".spc";      // spc file for run
+    //
+    string cmndspc      = "SLHA:file = ";       // line to change in cmnd file
+    string cmndspcnew   = cmndspc + spcRun;     // ... replace with this
+    //
+    string blockmass    = "BLOCK MASS";         // BLOCK MASS tag
+    string blockdiv     = "BLOCK";              // BLOCK divider tag
+    string gluinoID     = "1000021";            // Gluino PDG code
+    string stopID       = "1000006";            // Stop PDG code
+
+    tempfiles.push_back(cmndrun);
+    tempfiles.push_back(spcint);
+    tempfiles.push_back(spcRun);
+
+
+
+    /****************************************************************************
+    * UPDATE SPECTRUM ACCORDING TO PARAMETER SPACE POINT                        *
+    * --------------------------------------------------                        *
+    * This part of the code uses commands from FlipCommandFileFixer to generate *
+    * new command and spectrum files with the desired stop and gluino masses,   *
+    * as defined above.                                                         *
+    *                                                                           *
+    ****************************************************************************/
+
+    // Lines for updating the spectrum
+    // --------------------------------
+    string gluinoNew    = "   1000021   " + mgluino;    // line replacement
+    string stopNew      = "   1000006   " + mstop;      // line replacement
+    
+    // Make sure command file is using the same spc file that we're creating
+    // ---------------------------------------------------------------------
+    if(!FixCommand(cmndtemp, cmndrun, cmndspc, cmndspcnew)) 
+        cout << endl << " ERROR in FixCommand, setting " << cmndspcnew << endl;
+
+    // Using template spectrum, set gluino mass. Save to intermediate spectrum
+    // -----------------------------------------------------------------------
+    if(!FixSpectrum(spctemp, spcint, blockmass, blockdiv, gluinoID, gluinoNew))
+        cout << endl << "ERROR: FixSpectrum, setting mass " << gluinoNew << endl;
+    
+    // Using intermediate spectrum, set stop mass. Save to final spectrum
+    // -------------------------------------------------------------------
+    if(!FixSpectrum(spcint, spcRun, blockmass, blockdiv, stopID, stopNew))
+        cout << endl << "ERROR: FixSpectrum, setting mass " << stopNew << endl;
+    
+    // Any other entries (e.g. from RPVgScan), in place
+    // ------------------------------------------------
+    for (unsigned int iEntry = 0; iEntry < job.spectrum.size(); iEntry++)
+        if(!FixSLHA(spcRun, job.spectrum[iEntry].first, 
+            job.spectrum[iEntry].second))
+            cout << endl << "ERROR: FixSLHA, no entry " 
+                << job.spectrum[iEntry].first << endl;
+
+
+
+    /****************************************************************************
+    * RESULT CACHE                                                              *
+    * ------------                                                              *
+    * If this exact run (spectrum, settings, SR, seeds, # events, cuts) has     *
+    * been done before, report the stored result and skip Pythia altogether.    *
+    * See FlipCache.h for what goes into the key and for the policy settings.   *
+    *                                                                           *
+    ****************************************************************************/
+
+    vector<string> effective = effective_settings(cmndrun, settings);
+    cachepolicy cache = cache_policy(effective);
+    string cachekey = cache_key(effective, spcRun, iSR);
+    bool saveCutflow = 
+        (atoi(effective_setting(effective, "RPVg:shardCount", "1").c_str()) > 1)
+        || effective_flag(effective, "RPVg:writeCutflow", false);
+    
+    // A cached result has no per-event records (FlipEvents.h)
+    bool eventRecord = effective_flag(effective, "RPVg:eventRecord", false);
+    
+    if (!eventRecord && cache_lookup(cache, cachekey, record)){
+        cout << endl << "Found in cache: " << cache.directory << "/" 
+            << cachekey << ".cut" << endl;
+        if (record.shardCount == 1 && !outfile.empty()) 
+            write_result(outfile, record);
+        read_count(record.counts);
+        read_replicas(record);
+        cout << endl;
+        if (saveCutflow && !outfile.empty()){
+            string cutfile = cutflow_filename(outfile, mstop, mgluino, iSR, 
+                record.shardIndex, record.shardCount);
+            if (!write_cutflow(cutfile, record))
+                cout << "ERROR writing cutflow to " << cutfile << endl;
+        }
+        RemoveFiles(tempfiles);
+        return 0;
+    }
+
+
+
+    /****************************************************************************
+    * DEFINE AND INITIALIZE PYTHIA OBJECT FOR SHOWERING                         *
+    * -------------------------------------------------                         *
+    * Here we create the Pythia object and initialize according to whether we   *
+    * are calculating signal or background.                                     *
+    *                                                                           *
+    * SIGNAL:   input cmndrun (generated cmnd file which inputs generated       *
+    *           spectrum file) and initialize.                                  *
+    * BCKGRND:  Do not use SUSY info above. Instead, initialize on an LHE file  *
+    *           generated by MadGraph.                                          *
+    *                                                                           *
+    * Pick either SIGNAL or BACKGROUND, but don't initialize both on the same   *
+    * Pythia object! Instead, define two objects:                               *
+    *   Pythia8::Pythia pythiasignal;                                           *
+    *   Pythia8::Pythia pythiabackground;                                       *
+    *                                                                           *
+    ****************************************************************************/
+
+    // SIGNAL INITIALIZATION
+    // ---------------------
+    Pythia8::Pythia* pythiaPtr = warm;          // Declare Pythia object
+    if (!warm){
+        pythiaPtr = new Pythia8::Pythia;
+        addRecastSettings(*pythiaPtr);          // Declare RPVg:... settings
+    }
+    Pythia8::Pythia& pythia = *pythiaPtr;
+    vector<decaytable> decays(1);               // Default W decays, for the
+    snapshot_decays(pythia.particleData, 24, decays[0]);   // forced decays
+    pythia.readFile(cmndrun);                   // Read in command file
+    for (unsigned int iSet = 0; iSet < settings.size(); iSet++)
+        pythia.readString(settings[iSet]);      // ... and command line
+
+    int nEvent = pythia.mode("Main:numberOfEvents");
+
+
+    // SHARDS AND SEEDS
+    // ----------------
+    // Shard k of K generates its share of nEvent with a seed that only 
+    // depends on the point and k, and writes its cutflow to a file instead 
+    // of output.dat. Combine the shards with RPVgMerge. A single unseeded
+    // run (the default) keeps the time-based seeds.
+    //
+    int shardIndex  = pythia.mode("RPVg:shardIndex");
+    int shardCount  = pythia.mode("RPVg:shardCount");
+    long seed       = pythia.mode("RPVg:seed");
+    if (shardIndex >= shardCount){
+        cout << endl << "ERROR: shard " << shardIndex << " of " << shardCount 
+            << " does not exist" << endl;
+        if (!warm) delete pythiaPtr;
+        RemoveFiles(tempfiles);
+        return 1;
+    }
+    nEvent = shard_events(nEvent, shardIndex, shardCount);
+    //
+    if ((seed != 0) || (shardCount > 1)){
+        seed = shard_seed(seed, mstop, mgluino, iSR, shardIndex);
+        stringstream seedstring;
+        seedstring << "Random:seed = " << seed;
+        pythia.readString("Random:setSeed = on");
+        pythia.readString(seedstring.str());
+        srand((unsigned)seed);                  // for the efficiencies
+    }
+    
+    // FORCED DECAYS
+    // -------------
+    // The command file forces the W to decay leptonically (for stats). Each
+    // event gets the weight BR(true)/BR(forced) of the W decays it actually
+    // has, see FlipWeights.h. This replaces the old overall factor 
+    // 0.10608 = 0.3257^2, which assumed exactly two W's. With RPVg:decayBias
+    // W -> tau nu is suppressed further, and the weights make up for it.
+    //
+    if (pythia.flag("RPVg:decayBias"))
+        bias_decays(pythia.particleData, 24, pythia.parm("RPVg:decayBiasFactor"));
+    if (!finish_decay_weights(pythia.particleData, decays[0]))
+        cout << endl << "ERROR: finish_decay_weights, W weights are off" << endl;
+    
+    // PARTON LEVEL VETO
+    // -----------------
+    // Skip shower & hadronization of events that can't pass this SR's cuts
+    // (any SR's, when every event is recorded)
+    //
+    vector<signalregion> signal_region;
+    fill_signalregions(signal_region);
+    vector<signalregion> vetoregions(1, signal_region[iSR]);
+    if (eventRecord) vetoregions = signal_region;
+    PartonVeto partonveto(vetoregions, &decays);
+    PartonVeto* veto = 0;
+    if (pythia.flag("RPVg:partonVeto")){
+        veto = &partonveto;
+        pythia.setUserHooksPtr(veto);
+    }
+    
+    pythia.init();
+    
+    // PIPELINE
+    // --------
+    // With RPVg:analysisThreads > 0 generation and cuts run in separate 
+    // threads, see FlipPipeline.h. Each extra generator is a forked copy of
+    // this one that shares its memory, with its own seed (Pythia itself 
+    // isn't thread safe).
+    //
+    pipelinesetup pipeline;
+    pipeline.nAnalysis  = pythia.mode("RPVg:analysisThreads");
+    pipeline.ringSize   = pythia.mode("RPVg:ringSize");
+    pipeline.batchSize  = pythia.mode("RPVg:batchSize");
+    pipeline.seed       = seed;
+    if (pipeline.nAnalysis > 0){
+        pipeline.nForks         = pythia.mode("RPVg:generators") - 1;
+        pipeline.maxParticles   = pythia.mode("RPVg:sharedParticles");
+    }
+
+
+    // WORKERS
+    // -------
+    // Without the pipeline, RPVg:workers > 1 forks that many copies of the
+    // initialized Pythia object, each with its share of the events, see
+    // FlipWorkers.h
+    //
+    workersetup workers;
+    if (pipeline.nAnalysis == 0) workers.nWorkers = pythia.mode("RPVg:workers");
+    workers.seed = seed;
+
+
+    double initSeconds = wallclock() - startTime;
+
+
+    // LIVE STATUS RECORD
+    // ------------------
+    // Summarize all running points on this node with ./status.sh
+    //
+    runstatus status;
+    status.mstop    = mstop;
+    status.mgluino  = mgluino;
+    status.iSR      = iSR;
+    status.nEvent   = nEvent;
+    string statusdir = "";
+    if (pythia.flag("RPVg:status")) statusdir = pythia.word("RPVg:statusDir");
+    start_status(status, statusdir, pythia.parm("RPVg:statusInterval"));
+
+    
+    // EARLY STOP
+    // ----------
+    // With RPVg:earlyStop, stop as soon as the point is clearly excluded or
+    // allowed, see FlipLimit.h. Pipelined and forked runs only decide at the
+    // end.
+    //
+    limittest limit;
+    bool testLimit = pythia.flag("RPVg:earlyStop");
+    double upperLimit = upper_limit(pythia.word("RPVg:upperLimits"), iSR);
+    if (testLimit && upperLimit <= 0.0){
+        cout << endl << "ERROR: no RPVg:upperLimits for SR " << iSR 
+            << ", no early stop" << endl;
+        testLimit = false;
+    }
+    if (testLimit) start_limit_test(limit, upperLimit, 
+        pythia.parm("RPVg:luminosity"), pythia.parm("RPVg:stopConfidence"),
+        pythia.mode("RPVg:stopFirstLook"), nEvent, 
+        pythia.particleData.resOpenFrac(1000021, 1000021));
+
+
+
+    /****************************************************************************
+    *   THIS PART DOES THE CALCULATION                                          *
+    *****************************************************************************/
+
+    recastextras extras;
+    extras.status   = &status;
+    extras.veto     = veto;
+    extras.decays   = &decays;
+    histogramset histograms;
+    if (pythia.flag("RPVg:histograms")) extras.histograms = &histograms;
+    topologytally topologies;
+    if (pythia.flag("RPVg:effMap")) extras.topologies = &topologies;
+    if (testLimit) extras.limit = &limit;
+    
+    // BOOTSTRAP
+    // ---------
+    // With RPVg:bootstrap = R, every event gets R Poisson replica weights, 
+    // see FlipBootstrap.h. They don't use rand(), so the result is the same.
+    //
+    replicatally replicas;
+    vector<PartonVeto*> vetoes(1, veto);
+    if (pythia.mode("RPVg:bootstrap") > 0){
+        uint64_t stream = (seed != 0) ? seed : (uint64_t)time(0);
+        init_replicas(replicas, pythia.mode("RPVg:bootstrap"), nCutStages,
+            replica_stream(stream, "bootstrap"));
+        start_veto_replicas(vetoes, replicas);
+        extras.replicas = &replicas;
+    }
+    
+    // PER-EVENT RECORDS
+    // -----------------
+    // With RPVg:eventRecord, every event that gets to the cuts is written
+    // next to the cutflow, see FlipEvents.h. Only from the plain event loop.
+    //
+    eventwriter events;
+    if (eventRecord && !outfile.empty()){
+        if ((pipeline.nAnalysis > 0) || (workers.nWorkers > 1) || 
+            (pythia.mode("RPVg:batchEvents") > 0))
+            cout << endl << "ERROR: no event record with the pipeline, workers"
+                << " or batched cuts" << endl;
+        else {
+            eventfile header;
+            header.nStages      = nCutStages;
+            header.nRegions     = signal_region.size();
+            header.iSR          = iSR;
+            header.shardIndex   = shardIndex;
+            header.shardCount   = shardCount;
+            header.mstop        = atof(mstop.c_str());
+            header.mgluino      = atof(mgluino.c_str());
+            string eventfilename = cutflow_filename(outfile, mstop, mgluino, 
+                iSR, shardIndex, shardCount) + ".events";
+            uint64_t stream = (seed != 0) ? seed : (uint64_t)time(0);
+            if (open_events(events, eventfilename, header, 
+                replica_stream(stream, "events")))
+                extras.events = &events;
+            else cout << endl << "ERROR opening " << eventfilename << endl;
+        }
+    }
+    
+    double result;
+    if (pipeline.nAnalysis > 0) 
+        result = recast_pipelined(pythia, counts, iSR, nEvent, pipeline, extras);
+    else if (workers.nWorkers > 1)
+        result = recast_forked(pythia, counts, iSR, nEvent, workers, extras);
+    else
+        result = recast(pythia, counts, iSR, nEvent, extras);
+    
+    // With the veto, Pythia may have generated a few more than nEvent; with
+    // an early stop (or a worker that died), fewer
+    bool stopped = testLimit && (limit.decision != limitUndecided);
+    bool counted = veto || stopped || (workers.nWorkers > 1);
+    int nGenerated = nEvent;
+    if (counted) nGenerated = counts[0].count;
+    
+    // TARGET PRECISION
+    // ----------------
+    // With RPVg:targetPrecision > 0, the same (initialized) Pythia objects 
+    // generate rounds of nEvent more events until the relative uncertainty
+    // of the result is below the target, or until RPVg:maxEvents. A point
+    // that's already decided doesn't need more.
+    //
+    double target = pythia.parm("RPVg:targetPrecision");
+    extras.limit = 0;
+    while ((target > 0.0) && !stopped &&
+        (nGenerated + nEvent <= pythia.mode("RPVg:maxEvents"))){
+        double error = cut_error(counts.back(), counts[0].count);
+        if ((result > 0.0) && (error < target * result)) break;
+        
+        for (unsigned int iVeto = 0; iVeto < vetoes.size(); iVeto++){
+            stringstream name;                  // recast counts from zero
+            name << "veto" << iVeto << ":" << replicas.nEvents;
+            reset_veto(vetoes[iVeto], name.str());
+        }
+        
+        vector<cutcount> more;
+        if (pipeline.nAnalysis > 0) 
+            result += recast_pipelined(pythia, more, iSR, nEvent, pipeline, 
+                extras);
+        else if (workers.nWorkers > 1)
+            result += recast_forked(pythia, more, iSR, nEvent, workers, extras);
+        else
+            result += recast(pythia, more, iSR, nEvent, extras);
+        for (unsigned int iCut = 0; iCut < counts.size(); iCut++){
+            counts[iCut].count += more[iCut].count;
+            counts[iCut].sumw  += more[iCut].sumw;
+            counts[iCut].sumw2 += more[iCut].sumw2;
+        }
+        nGenerated += (counted ? more[0].count : nEvent);
+    }
+    
+    if (extras.events && !close_events(events, nGenerated, counts[0].sumw))
+        cout << "ERROR writing event record" << endl;
+    
+    // The last look of the early stop test is at the very end
+    if (testLimit && !stopped)
+        limit_look(limit, nGenerated, counts.back().sumw, counts.back().sumw2,
+            pythia.info.sigmaGen(), pythia.info.sigmaErr());
+    
+    record.mstop        = mstop;
+    record.mgluino      = mgluino;
+    record.iSR          = iSR;
+    record.shardIndex   = shardIndex;
+    record.shardCount   = shardCount;
+    record.seed         = seed;
+    record.nEvent       = nGenerated;
+    record.result       = result;
+    record.counts       = counts;
+    record.replicas     = replicas;
+    record.decision     = "";
+    if (testLimit){
+        record.decision     = limit_decision_name[limit.decision];
+        record.confidence   = limit.confidence;
+        record.signal       = limit.signal;
+        record.upperLimit   = limit.upperLimit;
+    }
+    cache_store(cache, cachekey, record);
+    
+    // Run time, to schedule scans (see FlipSchedule.h); not for cache hits
+    if (pythia.flag("RPVg:timing")){
+        runtiming timing;
+        timing.mstop        = atof(mstop.c_str());
+        timing.mgluino      = atof(mgluino.c_str());
+        timing.iSR          = iSR;
+        timing.nEvents      = counts[0].count;
+        timing.initSeconds  = initSeconds;
+        timing.eventSeconds = wallclock() - startTime - initSeconds;
+        if (!append_timing(pythia.word("RPVg:timingFile"), timing))
+            cout << "ERROR adding to timing file " 
+                << pythia.word("RPVg:timingFile") << endl;
+    }
+    
+    if (shardCount == 1 && !outfile.empty()) write_result(outfile, record);
+        // 
+        // The result already includes the forced decay weights (and the
+        // weights of biased sampling), i.e. it's the number of events that
+        // would have passed without forcing (or bias).
+        //
+        // NOTE: technically, instead of nEvent, one should use the data from
+        //  the counts vector since this 'total generated events' number 
+        //  accounts for any aborted events. It shouldn't be a big difference
+        //  since we abort the entire run if too many events fail.
+
+    // // IF YOU WANT VERBOSE SCREEN OUTPUT:
+    // cout << "STOP: " << mstop << endl;
+    // cout << "GLUINO: " << mgluino << endl;
+    // cout << "Signal Region " << iSR << endl; 
+    read_count(counts); // gives intermediate steps
+    read_replicas(record);
+    cout << endl;
+    
+    // Save the full cutflow for RPVgMerge
+    if ( ((shardCount > 1) || pythia.flag("RPVg:writeCutflow")) && 
+        !outfile.empty() ){
+        string cutfile = cutflow_filename(outfile, mstop, mgluino, iSR, 
+            shardIndex, shardCount);
+        if (!write_cutflow(cutfile, record))
+            cout << "ERROR writing cutflow to " << cutfile << endl;
+    }
+    
+    // Histograms at each cut stage, next to the cutflow
+    if (extras.histograms && !outfile.empty()){
+        string histfile = cutflow_filename(outfile, mstop, mgluino, iSR, 
+            shardIndex, shardCount) + ".hist";
+        if (!write_histograms(histfile, histograms, counts))
+            cout << "ERROR writing histograms to " << histfile << endl;
+    }
+    
+    // Efficiency map, see FlipEffMap.h
+    if (extras.topologies && !append_effmap(pythia.word("RPVg:effMapFile"), 
+        atof(mstop.c_str()), atof(mgluino.c_str()), iSR, topologies))
+        cout << "ERROR adding to efficiency map " 
+            << pythia.word("RPVg:effMapFile") << endl;
+
+
+
+    /****************************************************************************
+    *   CLEAN UP: close filestreams, etc.                                       *
+    *****************************************************************************/
+    
+    finish_status(status);
+    if (!warm) delete pythiaPtr;
+
+
+    // REMOVE TEMPORARY FILES
+    // ----------------------        
+    RemoveFiles(tempfiles);
+    
+    return 0;
+} // end run_point
@@ -0,0 +1,51 @@
+// FlipRunPoint.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPRUNPOINT_H_INCLUDED__
+#define __FLIPRUNPOINT_H_INCLUDED__
+
+// One run of one point, from the templates to output.dat. This used to be
+// the body of RPVgPoint; RPVgServer's workers run it too.
+
+#include "FlipCommandFileFixer.h"   // to update command file
+#include "FlipCuts.h"               // all of my functions
+#include "FlipApplyCuts.h"          // all of my functions
+#include "FlipStatus.h"             // live progress record
+#include "FlipCutflow.h"            // cutflow records for sharded runs
+#include "FlipCache.h"              // results of earlier runs
+#include "FlipPipeline.h"           // threaded generation and cuts
+#include "FlipWorkers.h"            // forked worker processes
+#include "FlipSchedule.h"           // run times, for scheduling scans
+#include "Pythia.h"                 // Include Pythia headers
+#include <vector>                   // for vectors
+#include <sstream>                  // for string stream
+#include <fstream>                  // for file in/out
+using namespace std;
+
+struct pointjob{
+    // what to run, i.e. the RPVgPoint command line
+    string mstop;                   // stop mass
+    string mgluino;                 // gluino mass
+    int iSR;                        // signal region #
+    string cmndtemp;                // template command file
+    string spctemp;                 // template spectrum file
+    string outfile;                 // output file ("": only fill the record)
+    vector<string> settings;        // Pythia settings after the command file
+    vector< pair<string,string> > spectrum; // more spectrum entries to set:
+                                    //  (entry, value), see FixSLHA
+    string tag;                     // in the intermediate file names, so that
+                                    //  jobs in the same directory don't clash
+};
+
+int run_point(pointjob&, cutflowrecord&, Pythia8::Pythia* = 0);
+// Inputs: job, record to fill, Pythia object to use (optional)
+// Output: 0 if all went well (like main)
+//
+// Without a Pythia object, run_point makes its own. Otherwise the object
+// must be fresh apart from addRecastSettings(), e.g. a copy of a "warm"
+// object in a forked process: constructing Pythia (reading the XML
+// settings database) is what it saves.
+
+
+// END INCLUDE GUARD
+#endif // __FLIPRUNPOINT_H_INCLUDED__
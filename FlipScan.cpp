@@ -0,0 +1,289 @@
+/********************************************************************************
+*   FlipScan.cpp                                                                *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the scan file reader and the sampling, see FlipScan.h              *
+*                                                                               *
+*   Sobol: Bratley & Fox's Gray code construction, with the primitive          *
+*   polynomials and initial direction numbers of S. Joe and F. Kuo             *
+*   (new-joe-kuo-6.21201) for dimensions 2 ... 16; dimension 1 is the         *
+*   van der Corput sequence.                                                    *
+********************************************************************************/
+
+#include "FlipScan.h"
+#include <algorithm>                // for transform, swap
+
+
+// Joe & Kuo: degree s and coefficients a of the polynomial, initial m_i
+const int sobol_degree[nSobolDimensions - 1] =
+    { 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6 };
+const int sobol_poly[nSobolDimensions - 1] =
+    { 0, 1, 1, 2, 1, 4, 2, 4, 7, 11, 13, 14, 1, 13, 16 };
+const int sobol_m[nSobolDimensions - 1][6] = {
+    { 1 }, { 1, 3 }, { 1, 3, 1 }, { 1, 1, 1 }, { 1, 1, 3, 3 },
+    { 1, 3, 5, 13 }, { 1, 1, 5, 5, 17 }, { 1, 1, 5, 5, 5 },
+    { 1, 1, 7, 11, 19 }, { 1, 1, 5, 1, 1 }, { 1, 1, 1, 3, 11 },
+    { 1, 3, 5, 5, 31 }, { 1, 3, 3, 9, 7, 49 }, { 1, 1, 1, 15, 21, 21 },
+    { 1, 3, 1, 13, 27, 49 } };
+
+
+
+string trim_scan(string text){
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+} // end trim_scan
+
+
+
+bool read_scan(string filename, scanspec& spec){
+    // key = value lines, '!' starts a comment
+
+    spec.sampling   = "grid";
+    spec.nPoints    = 16;
+    spec.seed       = 0;
+    spec.regions.clear();
+    spec.cmndtemp   = "TEMPLATE.cmnd";
+    spec.spctemp    = "TEMPLATE.spc";
+    spec.output     = "scan.dat";
+    spec.mstop      = "300";
+    spec.mgluino    = "800";
+    spec.nWorkers   = 1;
+    spec.timing     = "";                   // default: [output].timing
+    spec.settings.clear();
+    spec.dimensions.clear();
+    int steps       = 5;
+
+    ifstream instream;
+    instream.open(filename.c_str());
+    if (!instream.is_open()){
+        cout << "ERROR: can't open scan file " << filename << endl;
+        return false;
+    }
+
+    string line;
+    vector<string> dimensionlines;
+    while (getline(instream, line)){
+        size_t comment = line.find('!');
+        if (comment != string::npos) line = line.substr(0, comment);
+        size_t equals = line.find('=');
+        if (equals == string::npos){
+            if (!trim_scan(line).empty())
+                cout << "ERROR: can't read scan line '" << line << "'" << endl;
+            continue;
+        }
+        string key = trim_scan(line.substr(0, equals));
+        string value = trim_scan(line.substr(equals + 1));
+        transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+        if      (key == "sampling") spec.sampling   = value;
+        else if (key == "points")   spec.nPoints    = atoi(value.c_str());
+        else if (key == "seed")     spec.seed       = atol(value.c_str());
+        else if (key == "steps")    steps           = atoi(value.c_str());
+        else if (key == "cmnd")     spec.cmndtemp   = value;
+        else if (key == "spc")      spec.spctemp    = value;
+        else if (key == "output")   spec.output     = value;
+        else if (key == "mstop")    spec.mstop      = value;
+        else if (key == "mgluino")  spec.mgluino    = value;
+        else if (key == "workers")  spec.nWorkers   = atoi(value.c_str());
+        else if (key == "timing")   spec.timing     = value;
+        else if (key == "setting")  spec.settings.push_back(value);
+        else if (key == "dimension") dimensionlines.push_back(value);
+        else if (key == "regions"){
+            stringstream regionstream(value);
+            string region;
+            while (getline(regionstream, region, ','))
+                spec.regions.push_back(atoi(region.c_str()));
+        }
+        else cout << "ERROR: unknown scan key '" << key << "'" << endl;
+    } // end loop over lines
+    instream.close();
+
+    // Dimensions last, so that 'steps' can come anywhere
+    for (unsigned int iDim = 0; iDim < dimensionlines.size(); iDim++){
+        stringstream fields(dimensionlines[iDim]);
+        scandimension dimension;
+        dimension.steps = steps;
+        dimension.logarithmic = false;
+        if (!(fields >> dimension.name >> dimension.low >> dimension.high)){
+            cout << "ERROR: can't read dimension '" << dimensionlines[iDim]
+                << "'" << endl;
+            return false;
+        }
+        string option;
+        while (fields >> option){
+            if (option == "log") dimension.logarithmic = true;
+            else dimension.steps = atoi(option.c_str());
+        }
+        if ( (dimension.steps < 1) || (dimension.logarithmic &&
+            (dimension.low <= 0 || dimension.high <= 0)) ){
+            cout << "ERROR: bad range for " << dimension.name << endl;
+            return false;
+        }
+        spec.dimensions.push_back(dimension);
+    } // end loop over dimensions
+
+    if (spec.regions.empty()) spec.regions.push_back(8);
+    if (spec.timing.empty()) spec.timing = spec.output + ".timing";
+    if (spec.dimensions.empty()){
+        cout << "ERROR: nothing to scan in " << filename << endl;
+        return false;
+    }
+    if ( (spec.sampling != "grid") && (spec.sampling != "sobol") &&
+         (spec.sampling != "lhs") ){
+        cout << "ERROR: unknown sampling " << spec.sampling << endl;
+        return false;
+    }
+    if ( (spec.sampling == "sobol") &&
+         (int(spec.dimensions.size()) > nSobolDimensions) ){
+        cout << "ERROR: at most " << nSobolDimensions << " Sobol dimensions"
+            << endl;
+        return false;
+    }
+    if (spec.nPoints < 1){
+        cout << "ERROR: # points must be positive" << endl;
+        return false;
+    }
+    if (spec.nWorkers < 1){
+        cout << "ERROR: # workers must be positive" << endl;
+        return false;
+    }
+    return true;
+} // end read_scan
+
+
+
+vector< vector<double> > scan_points(scanspec& spec){
+    // Points in the unit cube, then stretched to the ranges
+
+    vector< vector<double> > points;
+    int nDim = spec.dimensions.size();
+    if (spec.sampling == "grid"){
+        vector<int> steps;
+        for (int iDim = 0; iDim < nDim; iDim++)
+            steps.push_back(spec.dimensions[iDim].steps);
+        grid_points(steps, points);
+    }
+    else if (spec.sampling == "sobol") sobol_points(spec.nPoints, nDim, points);
+    else lhs_points(spec.nPoints, nDim, spec.seed, points);
+
+    for (unsigned int iPoint = 0; iPoint < points.size(); iPoint++){
+        for (int iDim = 0; iDim < nDim; iDim++){
+            scandimension& dimension = spec.dimensions[iDim];
+            double u = points[iPoint][iDim];
+            if (dimension.logarithmic)
+                points[iPoint][iDim] = dimension.low *
+                    exp(u * log(dimension.high / dimension.low));
+            else
+                points[iPoint][iDim] = dimension.low +
+                    u * (dimension.high - dimension.low);
+        }
+    } // end loop over points
+
+    return points;
+} // end scan_points
+
+
+
+bool is_setting(scandimension& dimension){
+    // Pythia settings have a ':' (PhaseSpace:mHatMin), SLHA entries a '/'
+    return (dimension.name.find(':') != string::npos) &&
+           (dimension.name.find('/') == string::npos);
+} // end is_setting
+
+
+
+string scan_value(double value){
+    stringstream text;
+    text << value;
+    return text.str();
+} // end scan_value
+
+
+
+void grid_points(vector<int>& steps, vector< vector<double> >& points){
+    // Every combination; the last dimension changes fastest
+
+    points.clear();
+    int nPoints = 1;
+    for (unsigned int iDim = 0; iDim < steps.size(); iDim++) nPoints *= steps[iDim];
+
+    for (int iPoint = 0; iPoint < nPoints; iPoint++){
+        vector<double> point(steps.size());
+        int rest = iPoint;
+        for (int iDim = steps.size() - 1; iDim >= 0; iDim--){
+            int iStep = rest % steps[iDim];
+            rest /= steps[iDim];
+            point[iDim] = (steps[iDim] > 1) ? double(iStep) / (steps[iDim] - 1)
+                : 0.0;
+        }
+        points.push_back(point);
+    } // end loop over points
+} // end grid_points
+
+
+
+void sobol_points(int nPoints, int nDim, vector< vector<double> >& points){
+    // 32 bit direction numbers V[i] = v_i x 2^32, i = 1 ... 32
+
+    vector< vector<uint64_t> > direction(nDim, vector<uint64_t>(33, 0));
+    for (int iDim = 0; iDim < nDim; iDim++){
+        vector<uint64_t>& V = direction[iDim];
+        if (iDim == 0){
+            for (int i = 1; i <= 32; i++) V[i] = (uint64_t)1 << (32 - i);
+            continue;
+        }
+        int s = sobol_degree[iDim - 1];
+        int a = sobol_poly[iDim - 1];
+        for (int i = 1; i <= s; i++)
+            V[i] = (uint64_t)sobol_m[iDim - 1][i - 1] << (32 - i);
+        for (int i = s + 1; i <= 32; i++){
+            V[i] = V[i - s] ^ (V[i - s] >> s);
+            for (int k = 1; k < s; k++)
+                if ((a >> (s - 1 - k)) & 1) V[i] ^= V[i - k];
+        }
+    } // end loop over dimensions
+
+    // Gray code: point n differs from point n-1 in the direction of the
+    // lowest zero bit of n-1
+    points.clear();
+    vector<uint64_t> x(nDim, 0);
+    points.push_back(vector<double>(nDim, 0.0));
+    for (int iPoint = 1; iPoint < nPoints; iPoint++){
+        int c = 1;
+        for (unsigned int value = iPoint - 1; value & 1; value >>= 1) c++;
+        vector<double> point(nDim);
+        for (int iDim = 0; iDim < nDim; iDim++){
+            x[iDim] ^= direction[iDim][c];
+            point[iDim] = double(x[iDim]) / 4294967296.0;
+        }
+        points.push_back(point);
+    } // end loop over points
+} // end sobol_points
+
+
+
+double lcg_uniform(uint64_t& state){
+    // Knuth's MMIX generator; the top 53 bits as a double in [0, 1)
+    state = state * 6364136223846793005UL + 1442695040888963407UL;
+    return double(state >> 11) / 9007199254740992.0;
+} // end lcg_uniform
+
+
+
+void lhs_points(int nPoints, int nDim, uint64_t seed,
+    vector< vector<double> >& points){
+    // One point in each of the nPoints slices of every dimension
+
+    points.assign(nPoints, vector<double>(nDim, 0.0));
+    uint64_t state = seed;
+    for (int iDim = 0; iDim < nDim; iDim++){
+        vector<int> slice(nPoints);
+        for (int iPoint = 0; iPoint < nPoints; iPoint++) slice[iPoint] = iPoint;
+        for (int iPoint = nPoints - 1; iPoint > 0; iPoint--)    // shuffle
+            swap(slice[iPoint],
+                slice[int(lcg_uniform(state) * (iPoint + 1))]);
+        for (int iPoint = 0; iPoint < nPoints; iPoint++)
+            points[iPoint][iDim] = (slice[iPoint] + lcg_uniform(state)) / nPoints;
+    } // end loop over dimensions
+} // end lhs_points
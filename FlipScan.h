@@ -0,0 +1,102 @@
+// FlipScan.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPSCAN_H_INCLUDED__
+#define __FLIPSCAN_H_INCLUDED__
+
+// Scans over any number of parameters: SLHA entries (masses, RPV couplings,
+// widths, BRs; see FixSLHA in FlipCommandFileFixer.h) or Pythia settings.
+// A scan file looks like a command file, e.g.
+//
+//      sampling    = sobol                 ! grid, sobol or lhs
+//      points      = 64                    ! # points (sobol, lhs)
+//      regions     = 3,8                   ! every point runs these SRs
+//      dimension   = MASS/1000006      200     600
+//      dimension   = MASS/1000021      600     1200
+//      dimension   = RVLAMUDD/3/1/2    1e-3    1       log
+//      dimension   = PhaseSpace:pTHatMin   0   200     3
+//
+// A dimension is a name, a range and optionally the # of grid values and
+// 'log' (uniform in the log of the value). Other keys: steps (default #
+// grid values, 5), seed (Latin hypercube, and the Pythia seeds if not 0),
+// cmnd, spc, output, mstop and mgluino (if they're not scanned),
+// setting (any number; Pythia settings for every point), workers (# runs
+// at once, longest first, see FlipSchedule.h) and timing (the timing file
+// the run times are predicted from and the scan's runs append to, as 
+// RPVg:timingFile; default [output].timing).
+//
+// Sampling: 'grid' is every combination (the last dimension changes
+// fastest, like scan.sh); 'sobol' is the start of a Sobol sequence (fills
+// the space evenly for any # points, best for powers of two); 'lhs' is a
+// Latin hypercube (each dimension is cut in # points slices, one point in
+// each). See RPVgScan.cc for running a scan.
+
+#include <string>
+#include <vector>
+#include <sstream>                  // for string stream
+#include <iostream>                 // for screen output
+#include <fstream>                  // for file in/out
+#include <cstdlib>                  // for atoi, atof
+#include <cmath>                    // for log, exp
+#include <stdint.h>                 // for uint64_t
+using namespace std;
+
+const int nSobolDimensions = 16;    // direction numbers we have, see .cpp
+
+struct scandimension{
+    // one parameter of the scan
+    string name;                    // SLHA entry (e.g. MASS/1000006) or
+                                    //  Pythia setting (e.g. PhaseSpace:mHatMin)
+    double low;                     // range
+    double high;
+    int steps;                      // # values on a grid
+    bool logarithmic;               // sample log(value) uniformly
+};
+
+struct scanspec{
+    // everything in a scan file
+    string sampling;                // grid, sobol or lhs
+    int nPoints;                    // # points (sobol and lhs)
+    long seed;                      // Latin hypercube & Pythia seeds
+    vector<int> regions;            // SRs to run at every point
+    string cmndtemp;                // template command file
+    string spctemp;                 // template spectrum file
+    string output;                  // results: one row per point per SR
+    string mstop;                   // stop mass if not scanned
+    string mgluino;                 // gluino mass if not scanned
+    int nWorkers;                   // # runs at once
+    string timing;                  // timing file, for the run times
+    vector<string> settings;        // Pythia settings for every point
+    vector<scandimension> dimensions;
+};
+
+
+bool read_scan(string, scanspec&);
+// TRUE if the scan file was read and makes sense; complains otherwise
+
+vector< vector<double> > scan_points(scanspec&);
+// Output: values of the parameters, one vector per point, in the order of
+//  the dimensions
+
+bool is_setting(scandimension&);
+// TRUE if the dimension is a Pythia setting rather than an SLHA entry
+
+string scan_value(double);
+// A value as it goes into file names and output, e.g. 437.5
+
+
+// SAMPLING IN THE UNIT CUBE
+// -------------------------
+
+void grid_points(vector<int>&, vector< vector<double> >&);
+// Inputs: # values in each dimension, points (output)
+
+void sobol_points(int, int, vector< vector<double> >&);
+// Inputs: # points, # dimensions (up to nSobolDimensions), points (output)
+
+void lhs_points(int, int, uint64_t, vector< vector<double> >&);
+// Inputs: # points, # dimensions, seed, points (output)
+
+
+// END INCLUDE GUARD
+#endif // __FLIPSCAN_H_INCLUDED__
@@ -0,0 +1,191 @@
+/********************************************************************************
+*   FlipSchedule.cpp                                                            *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the run time model and longest first scheduling, see             *
+*   FlipSchedule.h                                                              *
+*                                                                               *
+*   File format: '#' lines are comments, then one line per run:                *
+*       mstop  mgluino  SR  #generated  init (s)  events (s)                    *
+********************************************************************************/
+
+#include "FlipSchedule.h"
+#include "FlipCutflow.h"            // for append_locked
+#include <cmath>                    // for log, exp, fabs
+#include <algorithm>                // for sort
+
+
+
+bool append_timing(string filename, runtiming& timing){
+    // One locked append: the workers of a scan finish at the same time
+
+    stringstream outstream;
+    outstream << timing.mstop << "\t" << timing.mgluino << "\t" << timing.iSR
+        << "\t" << timing.nEvents << "\t" << timing.initSeconds << "\t"
+        << timing.eventSeconds << '\n';
+    return append_locked(filename, outstream.str(), 
+        "# mstop\tmgluino\tSR\tgenerated\tinit (s)\tevents (s)\n");
+} // end append_timing
+
+
+
+bool read_timings(string filename, vector<runtiming>& timings){
+    ifstream instream(filename.c_str());
+    if (!instream.is_open()) return false;
+
+    string line;
+    while (getline(instream, line)){
+        if (line.empty() || line[0] == '#') continue;
+        stringstream linestream(line);
+        runtiming timing;
+        if (linestream >> timing.mstop >> timing.mgluino >> timing.iSR
+            >> timing.nEvents >> timing.initSeconds >> timing.eventSeconds)
+            timings.push_back(timing);
+    } // end loop over lines
+
+    instream.close();
+    return true;
+} // end read_timings
+
+
+
+bool solve3(double matrix[3][3], double vector3[3], double solution[3]){
+    // Gaussian elimination with partial pivoting; FALSE if (nearly) singular
+
+    double a[3][4];
+    for (int i = 0; i < 3; i++){
+        for (int j = 0; j < 3; j++) a[i][j] = matrix[i][j];
+        a[i][3] = vector3[i];
+    }
+    double scale = fabs(a[0][0]) + fabs(a[1][1]) + fabs(a[2][2]);
+
+    for (int col = 0; col < 3; col++){
+        int pivot = col;
+        for (int row = col + 1; row < 3; row++)
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) pivot = row;
+        if (fabs(a[pivot][col]) <= 1e-9 * scale) return false;
+        for (int j = 0; j < 4; j++) swap(a[col][j], a[pivot][j]);
+        for (int row = col + 1; row < 3; row++){
+            double factor = a[row][col] / a[col][col];
+            for (int j = col; j < 4; j++) a[row][j] -= factor * a[col][j];
+        }
+    } // end elimination
+
+    for (int row = 2; row >= 0; row--){
+        double sum = a[row][3];
+        for (int j = row + 1; j < 3; j++) sum -= a[row][j] * solution[j];
+        solution[row] = sum / a[row][row];
+    }
+    return true;
+} // end solve3
+
+
+
+void fit_costs(vector<runtiming>& timings, costmodel& model){
+    // Least squares for log(seconds per event), see header
+
+    model = costmodel();
+    vector<double> x1, x2, y;
+    vector<int> regions;
+    for (unsigned int iRun = 0; iRun < timings.size(); iRun++){
+        runtiming& timing = timings[iRun];
+        if (timing.nEvents <= 0 || timing.eventSeconds <= 0.0) continue;
+        x1.push_back(timing.mstop / 1000.0);
+        x2.push_back(timing.mgluino / 1000.0);
+        y.push_back(log(timing.eventSeconds / timing.nEvents));
+        regions.push_back(timing.iSR);
+        model.initSeconds += timing.initSeconds;
+    } // end loop over runs
+    int nRuns = y.size();
+    if (nRuns == 0) return;
+    model.nRuns = nRuns;
+    model.initSeconds /= nRuns;
+
+    // Normal equations for c0 + c1 x1 + c2 x2
+    double matrix[3][3] = {{0,0,0},{0,0,0},{0,0,0}};
+    double vector3[3] = {0,0,0};
+    for (int iRun = 0; iRun < nRuns; iRun++){
+        double x[3] = {1.0, x1[iRun], x2[iRun]};
+        for (int i = 0; i < 3; i++){
+            for (int j = 0; j < 3; j++) matrix[i][j] += x[i] * x[j];
+            vector3[i] += x[i] * y[iRun];
+        }
+    }
+    if (nRuns < 4 || !solve3(matrix, vector3, model.coefficient)){
+        model.coefficient[0] = vector3[0] / nRuns;     // the mean
+        model.coefficient[1] = model.coefficient[2] = 0.0;
+    }
+
+    // What's left is put down to the SR
+    vector<double> sum, count;
+    for (int iRun = 0; iRun < nRuns; iRun++){
+        int iSR = regions[iRun];
+        if (iSR < 0) continue;
+        if (iSR >= int(sum.size())){
+            sum.resize(iSR + 1, 0.0);
+            count.resize(iSR + 1, 0.0);
+        }
+        sum[iSR] += y[iRun] - model.coefficient[0]
+            - model.coefficient[1] * x1[iRun] - model.coefficient[2] * x2[iRun];
+        count[iSR]++;
+    }
+    model.srOffset.assign(sum.size(), 0.0);
+    for (unsigned int iSR = 0; iSR < sum.size(); iSR++)
+        if (count[iSR] > 0) model.srOffset[iSR] = sum[iSR] / count[iSR];
+} // end fit_costs
+
+
+
+double predict_cost(costmodel& model, double mstop, double mgluino, int iSR,
+    int nEvents){
+    if (model.nRuns == 0) return 0.0;
+
+    double logTime = model.coefficient[0] + model.coefficient[1] * mstop / 1000.0
+        + model.coefficient[2] * mgluino / 1000.0;
+    if (iSR >= 0 && iSR < int(model.srOffset.size()))
+        logTime += model.srOffset[iSR];
+    return model.initSeconds + nEvents * exp(logTime);
+} // end predict_cost
+
+
+
+bool longer_job(const pair<double,int>& a, const pair<double,int>& b){
+    // longest first; ties in the original order
+    if (a.first != b.first) return a.first > b.first;
+    return a.second < b.second;
+} // end longer_job
+
+
+
+double longest_first(vector<double>& costs, int nWorkers, vector<int>& order,
+    vector<int>& worker){
+    // LPT: sort, then each job to the worker with the least work so far
+
+    vector< pair<double,int> > jobs;
+    for (unsigned int iJob = 0; iJob < costs.size(); iJob++)
+        jobs.push_back(make_pair(costs[iJob], int(iJob)));
+    sort(jobs.begin(), jobs.end(), longer_job);
+
+    if (nWorkers < 1) nWorkers = 1;
+    vector<double> load(nWorkers, 0.0);
+    order.clear();
+    worker.assign(costs.size(), 0);
+    for (unsigned int iJob = 0; iJob < jobs.size(); iJob++){
+        int iWorker = min_element(load.begin(), load.end()) - load.begin();
+        load[iWorker] += jobs[iJob].first;
+        order.push_back(jobs[iJob].second);
+        worker[jobs[iJob].second] = iWorker;
+    }
+    return *max_element(load.begin(), load.end());
+} // end longest_first
+
+
+
+double makespan(vector<double>& costs, int nWorkers){
+    // The same greedy hand out, in the given order
+
+    if (nWorkers < 1) nWorkers = 1;
+    vector<double> load(nWorkers, 0.0);
+    for (unsigned int iJob = 0; iJob < costs.size(); iJob++)
+        *min_element(load.begin(), load.end()) += costs[iJob];
+    return *max_element(load.begin(), load.end());
+} // end makespan
@@ -0,0 +1,88 @@
+// FlipSchedule.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPSCHEDULE_H_INCLUDED__
+#define __FLIPSCHEDULE_H_INCLUDED__
+
+// Scheduling scan points by their expected run time. Points don't all take
+// the same time: heavier gluinos give busier events (more hadrons in the
+// isolation cones), the veto and the SR change how much gets showered. Run
+// in scan order, the slowest points often start last and one worker is
+// left with the tail of the scan.
+//
+// With RPVg:timing every run_point appends its timing to a file 
+// (RPVg:timingFile), under a lock (append_locked, FlipCutflow.h):
+//      mstop  mgluino  SR  #generated  init (s)  events (s)
+// and fit_costs learns from those rows
+//      time = init + #events x exp(c0 + c1 mstop + c2 mgluino + d_SR)
+// (least squares for the log of the time per event; d_SR is the mean
+// residual of each SR, init the mean start-up time). With fewer than four
+// rows, or masses that don't vary, only c0 is fitted.
+//
+// longest_first then orders the jobs by predicted time, longest first, and
+// hands each to the worker that is free first (LPT). The predicted
+// makespan, the time until the last worker is done, comes back with it.
+// RPVgScan uses this for its worker pool and for plans for a batch system.
+//
+// Settings (see addRecastSettings):
+//  RPVg:timing     = off  append the timing of every run ...
+//  RPVg:timingFile = timing.dat   ... to this file
+// RPVgScan switches them on for its runs, with the scan's own timing file.
+//
+// The model knows nothing about threads or the machine: use timing rows
+// from runs like the ones you're scheduling.
+
+#include <string>
+#include <vector>
+#include <sstream>                  // for string stream
+#include <iostream>                 // for screen output
+#include <fstream>                  // for file in/out
+using namespace std;
+
+struct runtiming{
+    // one row of the timing file
+    double mstop;
+    double mgluino;
+    int iSR;
+    int nEvents;                    // # events generated
+    double initSeconds;             // patching, Pythia init
+    double eventSeconds;            // the event loop(s)
+};
+
+struct costmodel{
+    // run time model fitted by fit_costs, see above
+    int nRuns;                      // # timing rows used (0: no model)
+    double initSeconds;             // mean start-up time
+    double coefficient[3];          // c0, c1 (per TeV stop), c2 (per TeV gluino)
+    vector<double> srOffset;        // d_SR, indexed by SR
+    costmodel() : nRuns(0), initSeconds(0.0) {
+        coefficient[0] = coefficient[1] = coefficient[2] = 0.0;
+    }
+};
+
+
+bool append_timing(string, runtiming&);
+// Appends one row (and a header if the file is new); TRUE if written
+
+bool read_timings(string, vector<runtiming>&);
+// Reads every row of a timing file; FALSE if there's no such file
+
+void fit_costs(vector<runtiming>&, costmodel&);
+// Inputs: timing rows, model (output)
+
+double predict_cost(costmodel&, double, double, int, int);
+// Inputs: model, mstop, mgluino, SR, # events
+// Output: predicted seconds; 0 if the model has no data
+
+double longest_first(vector<double>&, int, vector<int>&, vector<int>&);
+// Inputs: predicted time of each job, # workers, order (output: jobs
+//  longest first), worker (output: worker of each job)
+// Output: predicted makespan
+
+double makespan(vector<double>&, int);
+// Inputs: predicted time of each job, # workers
+// Output: predicted makespan if the jobs are handed out in this order
+
+
+// END INCLUDE GUARD
+#endif // __FLIPSCHEDULE_H_INCLUDED__
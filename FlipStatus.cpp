@@ -0,0 +1,157 @@
+/******************************************************************************** 
+*   FlipStatus.cpp                                                              *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains functions for publishing the progress of a running point           *
+*                                                                               *
+*   The status file is rewritten every few seconds by writing a temporary file  *
+*   and renaming it, so a reader never sees a half-written record. The format  *
+*   is one 'key = value' pair per line, see write_status below.                 *
+********************************************************************************/
+
+#include "FlipStatus.h"
+#include <cstdio>                   // for rename, remove
+#include <sys/time.h>               // for gettimeofday
+#include <time.h>                   // for clock_gettime
+#include <sys/resource.h>           // for getrusage
+#include <sys/stat.h>               // for mkdir
+#include <unistd.h>                 // for getpid, gethostname
+
+
+
+double wallclock(){
+    // seconds since the epoch, microsecond resolution
+    
+    struct timeval now;
+    gettimeofday(&now, 0);
+    return now.tv_sec + 1.0e-6 * now.tv_usec;
+} // end wallclock
+
+
+
+double monotonic(){
+    // seconds on a clock that never jumps, nanosecond resolution: for
+    // timing short stretches of code, not for dates
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + 1.0e-9 * now.tv_nsec;
+} // end monotonic
+
+
+
+double cputime(){
+    // user + system CPU seconds used so far by this process
+    
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + 1.0e-6 * usage.ru_utime.tv_usec
+         + usage.ru_stime.tv_sec + 1.0e-6 * usage.ru_stime.tv_usec;
+} // end cputime
+
+
+
+long peakRSS(){
+    // peak resident set size in kB
+    
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // OS X reports bytes
+#else
+    return usage.ru_maxrss;         // Linux reports kB
+#endif
+} // end peakRSS
+
+
+
+void start_status(runstatus& status, string directory, double interval){
+    // Fill in the bookkeeping and write the first record
+    
+    status.nGenerated   = 0;
+    status.nPassed      = 0;
+    status.nAbort       = 0;
+    status.interval     = interval;
+    status.startTime    = wallclock();
+    status.lastWrite    = status.startTime;
+    status.filename     = "";
+    
+    if (directory.empty()) return;  // status switched off
+    mkdir(directory.c_str(), 0777); // fine if it already exists
+    
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+    
+    stringstream name;
+    name << directory << "/" << host << "." << getpid() << ".status";
+    status.filename = name.str();
+    
+    write_status(status, "running");
+} // end start_status
+
+
+
+void update_status(runstatus& status, int nGenerated, int nPassed, int nAbort){
+    // Keep the counters current; only touch the disk every 'interval' seconds
+    
+    status.nGenerated   = nGenerated;
+    status.nPassed      = nPassed;
+    status.nAbort       = nAbort;
+    
+    if (status.filename.empty()) return;
+    
+    double now = wallclock();
+    if (now - status.lastWrite < status.interval) return;
+    
+    status.lastWrite = now;
+    write_status(status, "running");
+} // end update_status
+
+
+
+void finish_status(runstatus& status){
+    // The run is over: the aggregator only lists active runs
+    
+    if (status.filename.empty()) return;
+    remove(status.filename.c_str());
+} // end finish_status
+
+
+
+void write_status(runstatus& status, string state){
+    // Write the record to a temporary file, then move it into place
+    
+    if (status.filename.empty()) return;
+    
+    double now      = wallclock();
+    double elapsed  = now - status.startTime;
+    double rate     = 0.0;                  // events per second
+    double eta      = -1.0;                 // seconds left, -1 if unknown
+    
+    if (elapsed > 0) rate = status.nGenerated / elapsed;
+    if (rate > 0) eta = (status.nEvent - status.nGenerated) / rate;
+    
+    string tempfile = status.filename + ".tmp";
+    ofstream outstream;
+    outstream.open(tempfile.c_str());
+    outstream.setf(ios::fixed);
+    outstream.precision(1);
+    
+    outstream << "pid = "       << getpid()             << '\n'
+              << "state = "     << state                << '\n'
+              << "mstop = "     << status.mstop         << '\n'
+              << "mgluino = "   << status.mgluino       << '\n'
+              << "SR = "        << status.iSR           << '\n'
+              << "requested = " << status.nEvent        << '\n'
+              << "generated = " << status.nGenerated    << '\n'
+              << "passed = "    << status.nPassed       << '\n'
+              << "aborts = "    << status.nAbort        << '\n'
+              << "rate = "      << rate                 << '\n'
+              << "eta = "       << eta                  << '\n'
+              << "elapsed = "   << elapsed              << '\n'
+              << "cpu = "       << cputime()            << '\n'
+              << "rss = "       << peakRSS()            << '\n'
+              << "updated = "   << now                  << '\n';
+    outstream.close();
+    
+    rename(tempfile.c_str(), status.filename.c_str());
+} // end write_status
@@ -0,0 +1,59 @@
+// FlipStatus.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPSTATUS_H_INCLUDED__
+#define __FLIPSTATUS_H_INCLUDED__
+
+// Live progress records for running scan points. Each RPVgPoint run keeps a
+// small key = value file up to date in a node-local directory; status.sh
+// reads every file in that directory and prints one line per run.
+
+#include <string>                           
+#include <sstream>                          // for string stream
+#include <iostream>                         // for screen output
+#include <fstream>                          // for file in/out
+using namespace std;
+
+struct runstatus{
+    // everything that goes into one status record
+    string filename;        // status file, empty if status is switched off
+    string mstop;           // stop mass (as passed on the command line)
+    string mgluino;         // gluino mass
+    int iSR;                // signal region #
+    int nEvent;             // # events requested
+    int nGenerated;         // # events generated so far
+    int nPassed;            // # events that passed all cuts so far
+    int nAbort;             // # pythia.next() failures so far
+    double interval;        // seconds between updates of the file
+    double startTime;       // wall clock at start of run
+    double lastWrite;       // wall clock at last update of the file
+};
+
+
+double wallclock();         // wall clock time in seconds (microsecond res.)
+double monotonic();         // monotonic clock in seconds (nanosecond res.)
+double cputime();           // user + system CPU time of this process
+long peakRSS();             // peak resident set size of this process in kB
+
+void start_status(runstatus&,   // record to set up
+    string,                     // status directory (created if missing)
+    double);                    // seconds between updates
+// Sets up the record and writes it for the first time. The masses, iSR and
+// nEvent should already be filled in. Does nothing if the directory string
+// is empty, so that the rest of the code can call update_status blindly.
+
+void update_status(runstatus&, int, int, int);
+// Inputs: # generated, # passed, # aborts. Rewrites the status file if
+// more than 'interval' seconds have passed since the last write. Cheap
+// enough to call once per event.
+
+void finish_status(runstatus&);
+// Removes the status file at the end of a run.
+
+void write_status(runstatus&, string);
+// Writes the record unconditionally; second argument is the run state
+// ("running" or "done").
+
+
+// END INCLUDE GUARD
+#endif // __FLIPSTATUS_H_INCLUDED__
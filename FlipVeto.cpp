@@ -0,0 +1,79 @@
+/******************************************************************************** 
+*   FlipVeto.cpp                                                                *
+*   Code for RPVg project, Oct 2026                                             *
+*   Parton level veto of events that can't pass the cuts, see FlipVeto.h       *
+********************************************************************************/
+
+#include "FlipVeto.h"
+#include "FlipApplyCuts.h"          // for grabProcess
+
+
+
+PartonVeto::PartonVeto(vector<signalregion>& regions, 
+    vector<decaytable>* decaysIn){
+    // An event is kept if it could pass ANY of the regions
+    
+    nVetoed     = 0;
+    sumw        = 0.0;
+    sumw2       = 0.0;
+    decays      = decaysIn;
+    minJets     = 0;
+    minbPartons = 0;
+    
+    for (unsigned int iSR = 0; iSR < regions.size(); iSR++){
+        unsigned int nb = regions[iSR].minbJets;
+        if (nb < 2) nb = 2;                 // '>1 bjets tagged' cut
+        
+        if (iSR == 0 || regions[iSR].minJets < minJets) 
+            minJets = regions[iSR].minJets;
+        if (iSR == 0 || nb < minbPartons) 
+            minbPartons = nb;
+    } // end loop over signal regions
+} // end PartonVeto
+
+
+
+bool PartonVeto::doVetoProcessLevel(Pythia8::Event& process){
+    // TRUE if the event should be thrown away
+    
+    fastjet::PseudoJet METvec (0.0, 0.0, 0.0, 0.0);
+    vector< pair<int, fastjet::PseudoJet> > partons;
+    vector< pair<int, fastjet::PseudoJet> > bpartons;
+    
+    // Same objects as recast sees
+    grabProcess(process, METvec, partons, bpartons);
+    
+    unsigned int nb = 0;
+    for (unsigned int iPar = 0; iPar < bpartons.size(); iPar++)
+        if (bpartons[iPar].second.pt() >= 40) nb++;   // b tag efficiency > 0
+    
+    apply_chain<jetchain>(partons);
+    bool veto = (nb < minbPartons) || (partons.size() < minJets);
+    
+    if (veto){
+        // The hard process (and its bias weight) is known by now
+        double weight = event_weight(*infoPtr, process, decays);
+        nVetoed++;
+        sumw += weight;
+        sumw2 += weight*weight;
+        tally_topology(topologies, decay_topology(process), false, weight);
+        tally_replicas(replicas, 1, weight);    // only in 'Generated'
+    }
+    return veto;
+} // end doVetoProcessLevel
+
+
+
+void reset_veto(PartonVeto* veto, string what){
+    // Before every recast that gets the veto after the first
+    
+    if (!veto) return;
+    veto->nVetoed = 0;
+    veto->sumw = 0.0;
+    veto->sumw2 = 0.0;
+    veto->topologies = topologytally();
+    
+    replicatally& replicas = veto->replicas;
+    if (replicas.nReplicas > 0) init_replicas(replicas, replicas.nReplicas,
+        replicas.nStages, replica_stream(replicas.stream, what));
+} // end reset_veto
@@ -0,0 +1,58 @@
+// FlipVeto.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPVETO_H_INCLUDED__
+#define __FLIPVETO_H_INCLUDED__
+
+// Parton level veto: throws away events that can't possibly pass the signal
+// region cuts right after the hard process and resonance decays, before
+// Pythia spends time on the shower, MPI and hadronization.
+//
+// Only cuts that we apply to pythia.process anyway are used, so the veto
+// never removes an event that could have passed:
+//  * b tagging is applied to the b partons, with zero efficiency below
+//    40 GeV, so we need max(2, minbJets) b partons with pT > 40 GeV.
+//  * jets are partons that pass jet_kinematic_cut, so we need minJets.
+// MET and HT have turn-on curves with long tails, and leptons come from 
+// pythia.event (e.g. from b decays), so these are left alone.
+//
+// Vetoed events are never returned by pythia.next(), so recast adds 
+// nVetoed (and the sum of their weights) to the generated events. Reset
+// all of the counters (including topologies) before running recast again,
+// and give the replicas a new stream: reset_veto.
+
+#include "Pythia.h"                         // Include Pythia headers
+#include "FlipCuts.h"                       // for signal regions, cuts
+#include "FlipWeights.h"                    // for forced decay weights
+using namespace std;
+
+class PartonVeto : public Pythia8::UserHooks {
+public:
+    PartonVeto(vector<signalregion>&,       // the regions we care about
+        vector<decaytable>* = 0);           // forced decays to reweight
+    
+    virtual bool canVetoProcessLevel() { return true; }
+    virtual bool doVetoProcessLevel(Pythia8::Event&);
+    
+    int nVetoed;                            // # events vetoed so far
+    double sumw;                            // ... sum of their weights
+    double sumw2;                           // ... and of squared weights
+    topologytally topologies;               // ... per decay topology
+    replicatally replicas;                  // ... bootstrap replicas, if
+                                            //  initialized (FlipBootstrap.h)
+    
+private:
+    unsigned int minJets;                   // loosest jet requirement
+    unsigned int minbPartons;               // loosest b requirement
+    vector<decaytable>* decays;             // forced decays (or null)
+};
+
+
+void reset_veto(PartonVeto*, string);
+// Inputs: veto (null: nothing to do), what the new replica stream is for
+// Counts from zero: vetoed events, their weights, topologies and, if they
+//  were initialized, the replicas (with a stream from theirs and the name)
+
+
+// END INCLUDE GUARD
+#endif // __FLIPVETO_H_INCLUDED__
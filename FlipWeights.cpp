@@ -0,0 +1,189 @@
+/******************************************************************************** 
+*   FlipWeights.cpp                                                             *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains functions for reweighting forced decays, see FlipWeights.h        *
+********************************************************************************/
+
+#include "FlipWeights.h"
+
+
+
+vector<int> channel_products(Pythia8::DecayChannel& channel){
+    // sorted |PDG codes| of the decay products, so W+ and W- look the same
+    
+    vector<int> products;
+    for (int iProd = 0; iProd < channel.multiplicity(); iProd++)
+        products.push_back(abs(channel.product(iProd)));
+    sort(products.begin(), products.end());
+    return products;
+} // end channel_products
+
+
+
+void snapshot_decays(Pythia8::ParticleData& particleData, int id, 
+    decaytable& table){
+    // Copy the channels and BRs as they are now
+    
+    Pythia8::ParticleDataEntry* entry = particleData.particleDataEntryPtr(id);
+    
+    table.id = id;
+    table.products.clear();
+    table.trueBR.clear();
+    
+    double sumBR = 0.0;
+    for (int iChan = 0; iChan < entry->sizeChannels(); iChan++){
+        table.products.push_back(channel_products(entry->channel(iChan)));
+        table.trueBR.push_back(entry->channel(iChan).bRatio());
+        sumBR += entry->channel(iChan).bRatio();
+    } // end loop over channels
+    
+    // Pythia normalizes at init, so do the same
+    for (unsigned int iChan = 0; iChan < table.trueBR.size(); iChan++)
+        table.trueBR[iChan] /= sumBR;
+} // end snapshot_decays
+
+
+
+void bias_decays(Pythia8::ParticleData& particleData, int id, double factor){
+    // Suppress the channels without a prompt e or mu
+    
+    Pythia8::ParticleDataEntry* entry = particleData.particleDataEntryPtr(id);
+    
+    for (int iChan = 0; iChan < entry->sizeChannels(); iChan++){
+        vector<int> products = channel_products(entry->channel(iChan));
+        bool prompt = false;
+        for (unsigned int iProd = 0; iProd < products.size(); iProd++)
+            if (products[iProd] == 11 || products[iProd] == 13) prompt = true;
+        
+        if (!prompt) entry->channel(iChan).bRatio(
+            factor * entry->channel(iChan).bRatio());
+    } // end loop over channels
+} // end bias_decays
+
+
+
+bool finish_decay_weights(Pythia8::ParticleData& particleData, 
+    decaytable& table){
+    // weight = true BR / used BR, separately for the particle (onMode 1, 2)
+    // and the antiparticle (onMode 1, 3)
+    
+    Pythia8::ParticleDataEntry* entry 
+        = particleData.particleDataEntryPtr(table.id);
+    
+    int nChan = table.products.size();
+    vector<double> used(nChan, 0.0);
+    vector<double> usedbar(nChan, 0.0);
+    double sumUsed = 0.0;
+    double sumUsedbar = 0.0;
+    bool success = true;
+    
+    for (int iChan = 0; iChan < entry->sizeChannels(); iChan++){
+        int onMode = entry->channel(iChan).onMode();
+        double BR = entry->channel(iChan).bRatio();
+        if (onMode == 0 || BR <= 0) continue;
+        
+        // find the same channel in the true table
+        vector<int> products = channel_products(entry->channel(iChan));
+        int iTrue = -1;
+        for (int jChan = 0; jChan < nChan; jChan++)
+            if (table.products[jChan] == products) iTrue = jChan;
+        
+        if (iTrue < 0){
+            cout << endl << "ERROR: finish_decay_weights, channel " << iChan 
+                 << " of " << table.id << " is not in the default table" << endl;
+            success = false;
+            continue;
+        }
+        
+        if (onMode == 1 || onMode == 2){
+            used[iTrue] += BR;
+            sumUsed += BR;
+        }
+        if (onMode == 1 || onMode == 3){
+            usedbar[iTrue] += BR;
+            sumUsedbar += BR;
+        }
+    } // end loop over channels in use
+    
+    table.weight.assign(nChan, 1.0);
+    table.weightbar.assign(nChan, 1.0);
+    for (int iChan = 0; iChan < nChan; iChan++){
+        if (used[iChan] > 0) 
+            table.weight[iChan] = table.trueBR[iChan] * sumUsed / used[iChan];
+        if (usedbar[iChan] > 0) 
+            table.weightbar[iChan] 
+                = table.trueBR[iChan] * sumUsedbar / usedbar[iChan];
+    } // end loop over channels
+    
+    return success;
+} // end finish_decay_weights
+
+
+
+double decay_weight(Pythia8::Event& process, vector<decaytable>& tables){
+    // Look at each particle that decayed in the hard process
+    
+    double weight = 1.0;
+    
+    for (int iPart = 0; iPart < process.size(); iPart++){
+        int daughter1 = process[iPart].daughter1();
+        int daughter2 = process[iPart].daughter2();
+        if (daughter1 <= 0 || daughter2 < daughter1) continue;
+        
+        for (unsigned int iTab = 0; iTab < tables.size(); iTab++){
+            if (abs(process[iPart].id()) != tables[iTab].id) continue;
+            
+            vector<int> products;
+            for (int iDau = daughter1; iDau <= daughter2; iDau++)
+                products.push_back(abs(process[iDau].id()));
+            sort(products.begin(), products.end());
+            
+            for (unsigned int iChan = 0; iChan < tables[iTab].products.size(); 
+                iChan++){
+                if (tables[iTab].products[iChan] != products) continue;
+                if (process[iPart].id() > 0) 
+                    weight *= tables[iTab].weight[iChan];
+                else weight *= tables[iTab].weightbar[iChan];
+            } // end loop over channels
+        } // end loop over tables
+    } // end loop over process particles
+    
+    return weight;
+} // end decay_weight
+
+
+
+double event_weight(Pythia8::Info& info, Pythia8::Event& process, 
+    vector<decaytable>* tables){
+    // Biased hard process (info.weight()) and forced decays are independent
+    
+    double weight = info.weight();
+    if (tables) weight *= decay_weight(process, *tables);
+    return weight;
+} // end event_weight
+
+
+
+int decay_topology(Pythia8::Event& process){
+    // Charges of the W's and what they decayed to
+    
+    int nW = 0, charge = 0, nLepton = 0, nTau = 0;
+    for (int iPart = 0; iPart < process.size(); iPart++){
+        if (abs(process[iPart].id()) != 24) continue;
+        int daughter1 = process[iPart].daughter1();
+        int daughter2 = process[iPart].daughter2();
+        if (daughter1 <= 0 || daughter2 < daughter1) continue;
+        
+        nW++;
+        charge += (process[iPart].id() > 0) ? 1 : -1;
+        for (int iDau = daughter1; iDau <= daughter2; iDau++){
+            int id = abs(process[iDau].id());
+            if (id == 11 || id == 13) nLepton++;
+            if (id == 15) nTau++;
+        }
+    } // end loop over process particles
+    
+    if (nW != 2 || nLepton + nTau != 2) return topoOther;
+    int first = (charge == 0) ? topoOSll : topoSSll;
+    return first + nTau;        // ll, lt, tt
+} // end decay_topology
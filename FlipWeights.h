@@ -0,0 +1,68 @@
+// FlipWeights.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPWEIGHTS_H_INCLUDED__
+#define __FLIPWEIGHTS_H_INCLUDED__
+
+// Per-event weights for forced decays. The command file forces the W to 
+// decay leptonically (for statistics). Instead of an overall factor we give
+// each event the weight
+//      product over decaying W's of  BR(true) / BR(used)
+// for the channel each W actually took, where BR(true) is Pythia's default
+// table and BR(used) is the table after the command file. This is exact for 
+// any number of W's and for any set of allowed channels, so we can also bias
+// the channels on purpose (bias_decays) and undo it exactly.
+//
+// Pythia can bias the hard process the same way, e.g. towards high pT-hat
+// with PhaseSpace:bias2Selection, and then gives each event a weight of its
+// own (pythia.info.weight(), 1 without bias, average 1 with it). The event
+// weight in the cutflow is the product of the two, see event_weight.
+
+#include "Pythia.h"                         // Include Pythia headers
+#include "FlipEffMap.h"                     // for the decay topologies
+#include <vector>                           // for vectors
+#include <algorithm>                        // for sort
+#include <iostream>                         // for screen output
+using namespace std;
+
+struct decaytable{
+    // Channels of one particle: true BR and weight for particle/antiparticle
+    int id;                                 // PDG code, e.g. 24
+    vector< vector<int> > products;         // sorted |PDG codes| per channel
+    vector<double> trueBR;                  // default branching ratio
+    vector<double> weight;                  // trueBR / BR used (particle)
+    vector<double> weightbar;               // trueBR / BR used (antiparticle)
+};
+
+
+void snapshot_decays(Pythia8::ParticleData&, int, decaytable&);
+// Stores the current (default) channels of particle id as the true BRs.
+// Call this BEFORE pythia.readFile() changes the decay table.
+
+void bias_decays(Pythia8::ParticleData&, int, double);
+// Biased decays: multiplies the BR of every open channel of particle id
+// without an electron or muon by the factor (e.g. 0.2 for W -> tau nu), so
+// more events have prompt e/mu. Call after readFile, before init.
+
+bool finish_decay_weights(Pythia8::ParticleData&, decaytable&);
+// Compares the channels in use to the true ones and fills in the weights.
+// FALSE if an open channel has no counterpart in the true table. Call after
+// readFile (and bias_decays), before init.
+
+double decay_weight(Pythia8::Event&, vector<decaytable>&);
+// Weight of an event: product over decayed particles in pythia.process
+// whose decays are in the tables. 1 if there are none.
+
+double event_weight(Pythia8::Info&, Pythia8::Event&, vector<decaytable>*);
+// Inputs: pythia.info, pythia.process, forced decays (or null)
+// Output: Pythia's event weight times the forced decay weight
+
+int decay_topology(Pythia8::Event&);
+// Topology of the W decays in pythia.process, see FlipEffMap.h
+
+vector<int> channel_products(Pythia8::DecayChannel&);
+// sorted |PDG codes| of the decay products of a channel
+
+
+// END INCLUDE GUARD
+#endif // __FLIPWEIGHTS_H_INCLUDED__
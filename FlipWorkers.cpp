@@ -0,0 +1,255 @@
+/********************************************************************************
+*   FlipWorkers.cpp                                                             *
+*   Code for RPVg project, Oct 2026                                             *
+*   Contains the forked worker processes, see FlipWorkers.h                     *
+*                                                                               *
+*   Shared memory: one block per worker, a workerresult followed by the        *
+*   bootstrap replicas (generated, then sumw) and the packed histograms.       *
+*   The block is mapped before the fork, so it's at the same address in the    *
+*   parent and every worker.                                                    *
+********************************************************************************/
+
+#include "FlipWorkers.h"
+#include <unistd.h>                 // for fork, _exit
+#include <sys/wait.h>               // for waitpid
+#include <cstdio>                   // for fflush
+
+
+struct workerresult{
+    // what one worker hands back (in shared memory)
+    volatile int finished;          // set last
+    double result;                  // return value of recast
+    int nStage[nCutStages];         // the cutflow
+    double sumw[nCutStages];
+    double sumw2[nCutStages];
+    topologytally topologies;       // with RPVg:effMap
+    long nReplicaEvents;            // with RPVg:bootstrap
+};
+
+struct workerlayout{
+    // sizes of a worker's block
+    int nReplicaSums;               // # doubles of replicas
+    int nHistogramValues;           // # doubles of histograms
+    size_t blockBytes;
+};
+
+
+
+int histogram_size(histogramset& set){
+    int nValues = 0;
+    for (unsigned int iStage = 0; iStage < set.hist.size(); iStage++)
+        for (unsigned int iVar = 0; iVar < set.hist[iStage].size(); iVar++)
+            nValues += 1 + set.hist[iStage][iVar].sumw.size();
+    return nValues;
+} // end histogram_size
+
+
+
+void pack_histograms(histogramset& set, double* values){
+    for (unsigned int iStage = 0; iStage < set.hist.size(); iStage++){
+        for (unsigned int iVar = 0; iVar < set.hist[iStage].size(); iVar++){
+            histogram& hist = set.hist[iStage][iVar];
+            *values++ = hist.entries;
+            for (unsigned int iBin = 0; iBin < hist.sumw.size(); iBin++)
+                *values++ = hist.sumw[iBin];
+        }
+    }
+} // end pack_histograms
+
+
+
+void unpack_histograms(double* values, histogramset& set){
+    for (unsigned int iStage = 0; iStage < set.hist.size(); iStage++){
+        for (unsigned int iVar = 0; iVar < set.hist[iStage].size(); iVar++){
+            histogram& hist = set.hist[iStage][iVar];
+            hist.entries = (int)*values++;
+            for (unsigned int iBin = 0; iBin < hist.sumw.size(); iBin++)
+                hist.sumw[iBin] = *values++;
+        }
+    }
+} // end unpack_histograms
+
+
+
+void run_worker(Pythia8::Pythia& pythia, int iSR, int nEvent, int iWorker,
+    workersetup& setup, const recastextras& extras, workerlayout& layout,
+    char* block){
+    // One worker's share: reseed, recast, write the block
+
+    reseed_generator(pythia, setup.seed, iWorker, setup.nRounds);
+
+    // Its own tallies from zero: the ones in extras are the parent's totals
+    recastextras mine = extras;
+    mine.limit = 0;                         // decided at the end
+    runstatus status;
+    mine.status = 0;
+    if (extras.status && iWorker == 0){
+        status = *extras.status;
+        status.nEvent = nEvent;
+        mine.status = &status;
+    }
+    histogramset histograms;
+    if (extras.histograms) mine.histograms = &histograms;
+    topologytally topologies;
+    if (extras.topologies) mine.topologies = &topologies;
+    replicatally replicas;
+    if (extras.replicas){
+        stringstream name;
+        name << "worker" << iWorker << ":" << extras.replicas->nEvents;
+        init_replicas(replicas, extras.replicas->nReplicas, nCutStages,
+            replica_stream(extras.replicas->stream, name.str()));
+        mine.replicas = &replicas;
+    }
+    stringstream name;
+    name << "worker" << iWorker;
+    reset_veto(extras.veto, name.str());
+
+    // One cut profile (RPVg:profileFile) for the run: worker 0's
+    string profileFile = pythia.word("RPVg:profileFile");
+    if (iWorker != 0) pythia.settings.word("RPVg:profileFile", "");
+
+    vector<cutcount> counts;
+    double result = recast(pythia, counts, iSR, nEvent, mine);
+    pythia.settings.word("RPVg:profileFile", profileFile);  // if run here
+
+    workerresult& out = *(workerresult*)block;
+    out.result = result;
+    for (int iStage = 0; iStage < nCutStages; iStage++){
+        out.nStage[iStage] = counts[iStage].count;
+        out.sumw[iStage]   = counts[iStage].sumw;
+        out.sumw2[iStage]  = counts[iStage].sumw2;
+    }
+    out.topologies = topologies;
+    out.nReplicaEvents = replicas.nEvents;
+    double* values = (double*)(block + align_shared(sizeof(workerresult)));
+    if (layout.nReplicaSums > 0) pack_replicas(replicas, values);
+    if (layout.nHistogramValues > 0)
+        pack_histograms(histograms, values + layout.nReplicaSums);
+
+    __sync_synchronize();
+    out.finished = 1;
+    cout.flush();
+} // end run_worker
+
+
+
+double recast_forked(
+    Pythia8::Pythia& pythia,                // initialized Pythia object
+    vector<cutcount> &counts,               // intermediate data (for checking)
+    int iSR,                                // Signal Region #
+    int nEvent,                             // # events, for all workers
+    workersetup& setup,                     // # workers, seeds
+    const recastextras& extras              // optional extras, see recast
+    ){
+
+    vector<signalregion> signal_region;
+    fill_signalregions(signal_region);
+    int nWorkers = max(1, setup.nWorkers);
+
+    // THE SHARED BLOCKS
+    // -----------------
+    workerlayout layout;
+    layout.nReplicaSums = 0;
+    if (extras.replicas)
+        layout.nReplicaSums = extras.replicas->nReplicas * (nCutStages + 1);
+    histogramset binning;
+    if (extras.histograms) init_histograms(binning, nCutStages);
+    layout.nHistogramValues = histogram_size(binning);
+    layout.blockBytes = align_shared(sizeof(workerresult)) + align_shared(
+        (layout.nReplicaSums + layout.nHistogramValues) * sizeof(double));
+
+    size_t sharedBytes = nWorkers * layout.blockBytes;
+    char* shared = (char*)shared_memory(sharedBytes);
+    if (!shared){
+        cout << endl << "ERROR: no shared memory for the workers, running"
+            << " recast in this process" << endl;
+        return recast(pythia, counts, iSR, nEvent, extras);
+    }
+
+
+    // FORK THE WORKERS
+    // ----------------
+    // Each takes nEvent / nWorkers events, the first ones one more. A worker
+    // that can't be forked is run here, once the others are going.
+    //
+    vector<int> share(nWorkers, nEvent / nWorkers);
+    for (int iWorker = 0; iWorker < nEvent % nWorkers; iWorker++)
+        share[iWorker]++;
+
+    vector<pid_t> workers(nWorkers, 0);
+    vector<int> here;
+    cout.flush();
+    fflush(0);
+    for (int iWorker = 0; iWorker < nWorkers; iWorker++){
+        pid_t pid = fork();
+        if (pid == 0){
+            run_worker(pythia, iSR, share[iWorker], iWorker, setup, extras,
+                layout, shared + iWorker * layout.blockBytes);
+            _exit(0);       // no destructors, no atexit: they're the parent's
+        }
+        if (pid < 0) here.push_back(iWorker);
+        workers[iWorker] = pid;
+    }
+    if (!here.empty())
+        cout << endl << "ERROR: fork failed, " << here.size()
+            << " of the workers run in this process" << endl;
+    for (unsigned int iHere = 0; iHere < here.size(); iHere++)
+        run_worker(pythia, iSR, share[here[iHere]], here[iHere], setup, extras,
+            layout, shared + here[iHere] * layout.blockBytes);
+
+    for (int iWorker = 0; iWorker < nWorkers; iWorker++){
+        if (workers[iWorker] <= 0) continue;
+        int workerStatus = 0;
+        waitpid(workers[iWorker], &workerStatus, 0);
+    }
+
+
+    // COMBINE
+    // -------
+    cuttally tally;
+    double result = 0.0;
+    histogramset histograms = binning;
+    for (int iWorker = 0; iWorker < nWorkers; iWorker++){
+        char* block = shared + iWorker * layout.blockBytes;
+        workerresult& out = *(workerresult*)block;
+        if (!out.finished){
+            cout << endl << "ERROR: worker " << iWorker << " died, its "
+                << share[iWorker] << " events are lost" << endl;
+            continue;
+        }
+
+        result += out.result;
+        for (int iStage = 0; iStage < nCutStages; iStage++){
+            tally.nStage[iStage] += out.nStage[iStage];
+            tally.sumw[iStage]   += out.sumw[iStage];
+            tally.sumw2[iStage]  += out.sumw2[iStage];
+        }
+        if (extras.topologies)
+            add_topologies(*extras.topologies, out.topologies);
+
+        double* values = (double*)(block + align_shared(sizeof(workerresult)));
+        if (extras.replicas){
+            replicatally replicas;
+            replicas.nReplicas = extras.replicas->nReplicas;
+            replicas.nStages = nCutStages;
+            replicas.nEvents = out.nReplicaEvents;
+            unpack_replicas(values, replicas);
+            add_replicas(*extras.replicas, replicas);
+        }
+        if (extras.histograms){
+            unpack_histograms(values + layout.nReplicaSums, histograms);
+            if (extras.histograms->hist.empty())
+                init_histograms(*extras.histograms, nCutStages);
+            add_histograms(*extras.histograms, histograms);
+        }
+    } // end loop over workers
+    tally.nPassed = tally.nStage[nCutStages-1];
+    tally.sumwPassed = result;
+
+    free_shared_memory(shared, sharedBytes);
+    setup.nRounds++;
+
+    fill_counts(counts, tally, signal_region[iSR]);
+
+    return result;
+} // end recast_forked
@@ -0,0 +1,59 @@
+// FlipWorkers.h
+// Oct 2026
+// INCLUDE GUARD
+#ifndef __FLIPWORKERS_H_INCLUDED__
+#define __FLIPWORKERS_H_INCLUDED__
+
+// Worker processes: Pythia 8.165 isn't made for several objects (or
+// threads) in one process, but one point can still use every core. With
+// RPVg:workers = N the spectrum is patched and Pythia initialized once, as
+// always, and then N worker processes are forked from it. They share the
+// initialized object copy on write, are reseeded one by one (Pythia and
+// rand(), for the efficiencies), and each runs the usual recast on its
+// share of the events. What they count comes back through shared memory
+// and is added up into one cutflow, one result row.
+//
+// Each worker brings back: its cutflow, the veto's counts, and whichever
+// of histograms, topologies and bootstrap replicas the run keeps. The
+// early stop only decides at the end (like the pipelined mode), and the
+// status record and the cut profile (RPVg:profileFile) follow worker 0.
+//
+// Settings (see addRecastSettings):
+//  RPVg:workers = 1    # worker processes; 1 runs recast in this process.
+//                      Only without RPVg:analysisThreads.
+//
+// With fixed seeds the run is reproducible for a given # workers, but not
+// the same events as with another #.
+
+#include "FlipApplyCuts.h"          // for recast
+#include "FlipPipeline.h"           // for shared memory and seeds
+using namespace std;
+
+struct workersetup{
+    // what recast_forked needs besides the Pythia object
+    int nWorkers;                   // # worker processes
+    long seed;                      // their seeds come from this ...
+    int nRounds;                    // ... and the # earlier calls
+    workersetup() : nWorkers(1), seed(0), nRounds(0) {}
+};
+
+
+double recast_forked(Pythia8::Pythia&, vector<cutcount>&, int, int,
+    workersetup&, const recastextras& = recastextras());
+// Same as recast (see FlipApplyCuts.h), with the events shared out over
+//  setup.nWorkers forked copies of the initialized Pythia object. The
+//  Pythia object itself doesn't generate. A worker that dies is reported
+//  and its events are missing from the cutflow.
+
+int histogram_size(histogramset&);
+// Output: # doubles that pack_histograms writes for this binning
+
+void pack_histograms(histogramset&, double*);
+// Writes entries and bin contents of every histogram, in order
+
+void unpack_histograms(double*, histogramset&);
+// Inputs: packed values, set with the same binning (output)
+
+
+// END INCLUDE GUARD
+#endif // __FLIPWORKERS_H_INCLUDED__
@@ -0,0 +1,423 @@
+/********************************************************************************
+*   RPVgBench.cc                                                                *
+*   Benchmark of whole runs on a pinned scan, Oct 2026                          *
+*                                                                               *
+*   Usage:  ./RPVgBench [compare | record] [baseline] [tolerance] [settings]   *
+*   e.g.    make bench                          (compare with bench.dat, or    *
+*                                                record it if there's none)    *
+*           ./RPVgBench record                  (new baseline)                 *
+*           ./RPVgBench compare bench.dat 0.2   (20% slack on the timing)      *
+*                                                                               *
+*   A few mass points, every SR, fixed seeds and the TEMPLATE files, each run  *
+*   through run_point like RPVgPoint, one at a time in a forked process (so    *
+*   every run has its own peak memory). For each run we keep:                  *
+*       the # events, the start-up time and the event loop time (from the     *
+*       timing file, see FlipSchedule.h), the time spent in each cut unit     *
+*       (RPVg:profileFile, see write_profile), the peak RSS, and the cutflow. *
+*   'record' writes them to the baseline file; 'compare' (the default) checks  *
+*   them against it, or records it first if there is no baseline file yet:     *
+*       - the cutflows must be the same, count for count (same seeds, same    *
+*         events): any difference means the physics changed;                   *
+*       - events/s, start-up time, the time per event of each cut unit and    *
+*         the peak memory, over the runs that are in both, may be worse by    *
+*         at most the tolerance (default 10%).                                 *
+*   Exit status 1 if anything is flagged. Extra arguments are Pythia settings  *
+*   read after the pinned ones, e.g. "RPVg:tuneCuts = on".                     *
+*                                                                               *
+*   Pythia's output goes to bench.log. Compare on the same machine as the      *
+*   baseline, with nothing else running.                                        *
+********************************************************************************/
+
+#include "FlipRunPoint.h"           // does all the work
+#include <vector>                   // for vectors
+#include <map>                      // for the baseline runs
+#include <cmath>                    // for fabs
+#include <cstdio>                   // for freopen, remove
+#include <unistd.h>                 // for fork
+#include <sys/wait.h>               // for wait4
+#include <sys/resource.h>           // for rusage
+using namespace std;
+
+
+// THE PINNED SCAN
+// ---------------
+// Change these and the baseline has to be recorded again
+const int nBenchPoints = 3;
+const char* const bench_mstop[nBenchPoints]     = { "300", "400", "500" };
+const char* const bench_mgluino[nBenchPoints]   = { "800", "1000", "1200" };
+const int nBenchRegions = 9;
+const char* const bench_settings[] = {
+    "Main:numberOfEvents = 2000",
+    "RPVg:seed = 20121201",
+    "RPVg:cache = off",                     // always run
+    "RPVg:status = off",
+    "RPVg:earlyStop = off",
+    "RPVg:targetPrecision = 0",
+    "RPVg:analysisThreads = 0",             // not reproducible event by event
+    "RPVg:workers = 1",
+    "RPVg:shardCount = 1",
+    "RPVg:timing = on",                     // how we get the times
+    "RPVg:timingFile = bench.timing" };
+const int nBenchSettings = sizeof(bench_settings) / sizeof(bench_settings[0]);
+
+
+struct benchrun{
+    // one run of the benchmark, or of the baseline
+    string mstop;
+    string mgluino;
+    int iSR;
+    int nEvents;                    // # events generated
+    double initSeconds;             // patching, Pythia init
+    double eventSeconds;            // the event loop
+    long rss;                       // peak RSS in kB
+    cutprofile units;               // time in each cut unit (nTried 0: none)
+    vector<cutcount> counts;        // the cutflow
+};
+
+
+
+string bench_key(benchrun& run){
+    stringstream key;
+    key << run.mstop << "_" << run.mgluino << "_SR" << run.iSR;
+    return key.str();
+} // end bench_key
+
+
+
+bool write_bench(string filename, vector<benchrun>& runs){
+    ofstream outstream(filename.c_str());
+    if (!outstream.is_open()) return false;
+
+    outstream << "# RPVg benchmark baseline, see RPVgBench.cc" << endl
+        << "# mstop\tmgluino\tSR\tgenerated\tinit (s)\tevents (s)\tRSS (kB)"
+        << "\t# rows\t(count, sumw) of each row\t# units\t(tried, seconds) of"
+        << " each unit" << endl;
+    outstream.precision(12);
+    for (unsigned int iRun = 0; iRun < runs.size(); iRun++){
+        benchrun& run = runs[iRun];
+        outstream << run.mstop << "\t" << run.mgluino << "\t" << run.iSR
+            << "\t" << run.nEvents << "\t" << run.initSeconds << "\t"
+            << run.eventSeconds << "\t" << run.rss << "\t" << run.counts.size();
+        for (unsigned int iCut = 0; iCut < run.counts.size(); iCut++)
+            outstream << "\t" << run.counts[iCut].count << "\t"
+                << run.counts[iCut].sumw;
+        outstream << "\t" << nCutUnits;
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++)
+            outstream << "\t" << run.units.nTried[iUnit] << "\t" 
+                << run.units.cost[iUnit];
+        outstream << endl;
+    }
+    outstream.close();
+    return true;
+} // end write_bench
+
+
+
+bool read_bench(string filename, vector<benchrun>& runs){
+    ifstream instream(filename.c_str());
+    if (!instream.is_open()) return false;
+
+    string line;
+    while (getline(instream, line)){
+        if (line.empty() || line[0] == '#') continue;
+        stringstream linestream(line);
+        benchrun run;
+        int nRows = 0;
+        if (!(linestream >> run.mstop >> run.mgluino >> run.iSR >> run.nEvents
+            >> run.initSeconds >> run.eventSeconds >> run.rss >> nRows))
+            continue;
+        run.counts.resize(nRows);
+        for (int iCut = 0; iCut < nRows; iCut++)
+            linestream >> run.counts[iCut].count >> run.counts[iCut].sumw;
+        if (linestream.fail()) continue;
+
+        // The unit times, if the baseline has them
+        int nUnits = 0;
+        if ((linestream >> nUnits) && nUnits == nCutUnits){
+            for (int iUnit = 0; iUnit < nUnits; iUnit++)
+                linestream >> run.units.nTried[iUnit] >> run.units.cost[iUnit];
+            if (linestream.fail()) run.units = cutprofile();
+        }
+        runs.push_back(run);
+    } // end loop over lines
+
+    instream.close();
+    return true;
+} // end read_bench
+
+
+
+bool run_bench(string mstop, string mgluino, int iSR, vector<string>& extra,
+    benchrun& run){
+    // One run in a forked process; its cutflow and unit times come back
+    // in files
+
+    run.mstop = mstop;
+    run.mgluino = mgluino;
+    run.iSR = iSR;
+    run.nEvents = 0;
+    run.initSeconds = run.eventSeconds = 0.0;
+    run.rss = 0;
+    run.units = cutprofile();
+    run.counts.clear();
+    string cutflowfile = "bench." + bench_key(run) + ".cutflow";
+    string profilefile = "bench." + bench_key(run) + ".profile";
+
+    cout.flush();
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        if (!freopen("bench.log", "a", stdout)) _exit(1);
+        pointjob job;
+        job.mstop       = mstop;
+        job.mgluino     = mgluino;
+        job.iSR         = iSR;
+        job.cmndtemp    = "TEMPLATE.cmnd";
+        job.spctemp     = "TEMPLATE.spc";
+        job.outfile     = "";
+        job.tag         = ".bench";
+        for (int iSet = 0; iSet < nBenchSettings; iSet++)
+            job.settings.push_back(bench_settings[iSet]);
+        job.settings.push_back("RPVg:profileFile = " + profilefile);
+        job.settings.insert(job.settings.end(), extra.begin(), extra.end());
+        cutflowrecord record;
+        int status = run_point(job, record);
+        if (status == 0 && !write_cutflow(cutflowfile, record)) status = 1;
+        cout.flush();
+        fflush(stdout);
+        _exit(status);
+    }
+    if (pid < 0) return false;
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) return false;
+    run.rss = usage.ru_maxrss;              // kB on Linux
+
+    cutflowrecord record;
+    bool done = WIFEXITED(status) && WEXITSTATUS(status) == 0
+        && read_cutflow(cutflowfile, record);
+    remove(cutflowfile.c_str());
+    if (!read_profile(profilefile, run.units))  // e.g. batched: no times
+        run.units = cutprofile();
+    remove(profilefile.c_str());
+    if (!done) return false;
+    run.counts = record.counts;
+    run.nEvents = record.nEvent;
+    return true;
+} // end run_bench
+
+
+
+bool same_cutflow(benchrun& run, benchrun& base){
+    // Count for count, and the weights to the digits we keep; prints what
+    // differs
+
+    bool same = (run.counts.size() == base.counts.size());
+    if (!same) cout << "    CUTFLOW CHANGED: " << run.counts.size() << " rows ("
+        << base.counts.size() << " in the baseline)" << endl;
+    for (unsigned int iCut = 0; same && iCut < run.counts.size(); iCut++){
+        cutcount& now = run.counts[iCut];
+        cutcount& then = base.counts[iCut];
+        double scale = max(1.0, fabs(then.sumw));
+        if (now.count == then.count && fabs(now.sumw - then.sumw) < 1e-8 * scale)
+            continue;
+        cout << "    CUTFLOW CHANGED: " << now.label << " " << now.count << "  "
+            << now.sumw << " (baseline " << then.count << "  " << then.sumw
+            << ")" << endl;
+        same = false;
+    }
+    return same;
+} // end same_cutflow
+
+
+
+bool within(string what, double now, double then, double tolerance,
+    bool higherIsBetter){
+    // Prints the comparison; FALSE if it's worse than the tolerance
+
+    double change = (then > 0) ? now / then - 1.0 : 0.0;
+    bool worse = higherIsBetter ? (change < -tolerance) : (change > tolerance);
+    cout << "  " << what << ": " << now << " (baseline " << then << ", "
+        << (change >= 0 ? "+" : "") << 100 * change << "%)";
+    if (worse) cout << "  <-- REGRESSION";
+    cout << endl;
+    return !worse;
+} // end within
+
+
+
+int main(int argc, char *argv[]) {
+
+    string mode = (argc > 1) ? argv[1] : "compare";
+    string baseline = (argc > 2) ? argv[2] : "bench.dat";
+    double tolerance = (argc > 3) ? atof(argv[3]) : 0.10;
+    vector<string> extra;
+    for (int iArg = 4; iArg < argc; iArg++) extra.push_back(argv[iArg]);
+    if (mode != "compare" && mode != "record"){
+        cout << "Usage: ./RPVgBench [compare | record] [baseline] [tolerance]"
+            << " [settings]" << endl;
+        return 1;
+    }
+
+    vector<benchrun> base;
+    if (mode == "compare" && !read_bench(baseline, base)){
+        cout << "No baseline " << baseline << ": recording one, compare"
+            << " against it next time" << endl;
+        mode = "record";
+    }
+
+
+    // RUN THE SCAN
+    // ------------
+    remove("bench.timing");
+    remove("bench.log");
+    vector<benchrun> runs;
+    int status = 0;
+    double startTime = wallclock();
+    for (int iPoint = 0; iPoint < nBenchPoints; iPoint++)
+        for (int iSR = 0; iSR < nBenchRegions; iSR++){
+            benchrun run;
+            if (!run_bench(bench_mstop[iPoint], bench_mgluino[iPoint], iSR,
+                extra, run)){
+                cout << "ERROR: " << bench_key(run) << " failed, see bench.log"
+                    << endl;
+                status = 1;
+                continue;
+            }
+            runs.push_back(run);
+            cout << bench_key(run) << ": " << run.nEvents << " events" << endl;
+        }
+
+    // The times come from the timing file, one row per run in this order
+    vector<runtiming> timings;
+    read_timings("bench.timing", timings);
+    remove("bench.timing");
+    if (timings.size() != runs.size()){
+        cout << "ERROR: " << timings.size() << " rows in the timing file for "
+            << runs.size() << " runs" << endl;
+        status = 1;
+    }
+    for (unsigned int iRun = 0; iRun < runs.size() && iRun < timings.size();
+        iRun++){
+        runs[iRun].initSeconds  = timings[iRun].initSeconds;
+        runs[iRun].eventSeconds = timings[iRun].eventSeconds;
+    }
+
+    double nEvents = 0, initSeconds = 0, eventSeconds = 0;
+    long rss = 0;
+    cutprofile units;
+    for (unsigned int iRun = 0; iRun < runs.size(); iRun++){
+        nEvents         += runs[iRun].nEvents;
+        initSeconds     += runs[iRun].initSeconds;
+        eventSeconds    += runs[iRun].eventSeconds;
+        rss = max(rss, runs[iRun].rss);
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+            units.nTried[iUnit] += runs[iRun].units.nTried[iUnit];
+            units.cost[iUnit]   += runs[iRun].units.cost[iUnit];
+        }
+    }
+    cout << endl << "RPVgBench: " << runs.size() << " runs in "
+        << wallclock() - startTime << " s, " << nEvents / max(eventSeconds, 1e-9)
+        << " events/s, " << initSeconds << " s start-up, peak RSS " << rss
+        << " kB" << endl << "cut units (us/try):";
+    for (int iUnit = 0; iUnit < nCutUnits; iUnit++)
+        if (units.nTried[iUnit] > 0) cout << "  " << cut_unit_name[iUnit] << " "
+            << 1e6 * units.cost[iUnit] / units.nTried[iUnit];
+    cout << endl;
+
+    if (mode == "record"){
+        if (status != 0){
+            cout << "ERROR: not all runs went through, baseline not written"
+                << endl;
+            return 1;
+        }
+        if (!write_bench(baseline, runs)){
+            cout << "ERROR: can't write " << baseline << endl;
+            return 1;
+        }
+        cout << "Baseline written to " << baseline << endl;
+        return 0;
+    }
+
+
+    // COMPARE
+    // -------
+    // Cutflows run by run; the timing and memory only over runs that are in 
+    // both (and the unit times over those that have them in both)
+    //
+    map<string, int> inBase;
+    for (unsigned int iRun = 0; iRun < base.size(); iRun++)
+        inBase[bench_key(base[iRun])] = iRun;
+
+    double baseEvents = 0, baseInit = 0, baseSeconds = 0;
+    double nowEvents = 0, nowInit = 0, nowSeconds = 0;
+    long baseRSS = 0, nowRSS = 0;
+    cutprofile baseUnits, nowUnits;
+    int nChanged = 0, nCompared = 0;
+    int nNew = 0;                   // runs with no baseline
+    map<string, int> inRuns;
+    for (unsigned int iRun = 0; iRun < runs.size(); iRun++){
+        benchrun& run = runs[iRun];
+        inRuns[bench_key(run)] = iRun;
+        if (inBase.find(bench_key(run)) == inBase.end()){
+            cout << bench_key(run) << ": not in the baseline" << endl;
+            nNew++;
+            continue;
+        }
+        nCompared++;
+        benchrun& then = base[inBase[bench_key(run)]];
+        if (!same_cutflow(run, then)){
+            cout << bench_key(run) << ": cutflow differs from the baseline"
+                << endl;
+            nChanged++;
+        }
+        nowEvents   += run.nEvents;
+        nowInit     += run.initSeconds;
+        nowSeconds  += run.eventSeconds;
+        baseEvents  += then.nEvents;
+        baseInit    += then.initSeconds;
+        baseSeconds += then.eventSeconds;
+        baseRSS = max(baseRSS, then.rss);
+        nowRSS  = max(nowRSS, run.rss);
+        for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+            if (run.units.nTried[iUnit] == 0 || then.units.nTried[iUnit] == 0)
+                continue;
+            nowUnits.nTried[iUnit]  += run.units.nTried[iUnit];
+            nowUnits.cost[iUnit]    += run.units.cost[iUnit];
+            baseUnits.nTried[iUnit] += then.units.nTried[iUnit];
+            baseUnits.cost[iUnit]   += then.units.cost[iUnit];
+        }
+    }
+    int nGone = 0;                  // baseline runs that weren't run now
+    for (map<string, int>::iterator key = inBase.begin(); key != inBase.end();
+        key++){
+        if (inRuns.find(key->first) != inRuns.end()) continue;
+        cout << key->first << ": in the baseline, not run" << endl;
+        nGone++;
+    }
+
+    cout << endl << "Compared with " << baseline << " (tolerance "
+        << 100 * tolerance << "%):" << endl;
+    bool fine = true;
+    fine &= within("events/s", nowEvents / max(nowSeconds, 1e-9),
+        baseEvents / max(baseSeconds, 1e-9), tolerance, true);
+    fine &= within("start-up (s)", nowInit, baseInit, tolerance, false);
+    fine &= within("peak RSS (kB)", nowRSS, baseRSS, tolerance, false);
+    for (int iUnit = 0; iUnit < nCutUnits; iUnit++){
+        if (nowUnits.nTried[iUnit] == 0) continue;
+        fine &= within(string("cut unit ") + cut_unit_name[iUnit] + " (us/try)",
+            1e6 * nowUnits.cost[iUnit] / nowUnits.nTried[iUnit],
+            1e6 * baseUnits.cost[iUnit] / baseUnits.nTried[iUnit], tolerance,
+            false);
+    }
+    cout << "  cutflows: " << nChanged << " of " << nCompared 
+        << " runs changed";
+    if (nNew > 0) cout << ", " << nNew << " runs not in the baseline";
+    if (nGone > 0) cout << ", " << nGone << " baseline runs not run";
+    cout << endl;
+
+    if (!fine || nChanged > 0 || nNew > 0 || nGone > 0) status = 1;
+    cout << (status == 0 ? "OK" : "FLAGGED: see above") << endl;
+    return status;
+} // end main
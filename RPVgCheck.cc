@@ -0,0 +1,404 @@
+/********************************************************************************
+*   RPVgCheck.cc                                                                *
+*   Checks of the code that doesn't need Pythia, Oct 2026                       *
+*                                                                               *
+*   Usage:  ./RPVgCheck                 (or: make check)                        *
+*                                                                               *
+*   Each check prints one line, 'ok' or 'FAILED', with what it checked:        *
+*       - cutflow records: write_cutflow / read_cutflow round trip, and       *
+*         merge_cutflow of the shards of a point (FlipCutflow.h)               *
+*       - the cache: FNV-1a, cache keys and the seed policy (FlipCache.h)      *
+*       - sampling: grid, Sobol and Latin hypercube points (FlipScan.h)        *
+*       - scheduling: the run time model and longest first (FlipSchedule.h)    *
+*   Exit status 1 if anything failed. Scratch files are check.* in the        *
+*   working directory, removed at the end.                                     *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipCutflow.h"            // cutflow records
+#include "FlipCache.h"              // cache keys
+#include "FlipScan.h"               // sampling of scans
+#include "FlipSchedule.h"           // run times and LPT
+#include <vector>                   // for vectors
+#include <cmath>                    // for fabs
+#include <cstdio>                   // for remove
+using namespace std;
+
+
+int nFailed = 0;                    // # checks that failed so far
+
+
+
+void check(string what, bool ok){
+    cout << (ok ? "  ok      " : "  FAILED  ") << what << endl;
+    if (!ok) nFailed++;
+} // end check
+
+
+
+bool close_to(double a, double b){
+    return fabs(a - b) <= 1e-9 * max(1.0, fabs(b));
+} // end close_to
+
+
+
+cutflowrecord check_record(int shardIndex, int shardCount, int nEvent){
+    // A record like RPVgPoint writes, with made up counts
+
+    cutflowrecord record;
+    record.mstop        = "300";
+    record.mgluino      = "800";
+    record.iSR          = 8;
+    record.shardIndex   = shardIndex;
+    record.shardCount   = shardCount;
+    record.seed         = 1000 + shardIndex;
+    record.nEvent       = nEvent;
+    record.decision     = "";
+    record.confidence   = record.signal = record.upperLimit = 0.0;
+    const char* const labels[3] = { "Generated", "Kinematic\tcuts", "Passed" };
+    for (int iCut = 0; iCut < 3; iCut++){
+        cutcount cut;
+        cut.label   = labels[iCut];             // a tab: rest of the line
+        cut.count   = nEvent >> iCut;
+        cut.sumw    = 0.25 * cut.count + 0.125;
+        cut.sumw2   = 0.0625 * cut.count;
+        record.counts.push_back(cut);
+    }
+    record.result = record.counts[2].sumw;
+    return record;
+} // end check_record
+
+
+
+void check_cutflows(){
+    // FlipCutflow.h
+
+    cutflowrecord written = check_record(1, 4, 1000);
+    written.decision    = "excluded";
+    written.confidence  = 0.97;
+    written.signal      = 12.5;
+    written.upperLimit  = 4.25;
+    init_replicas(written.replicas, 3, written.counts.size(), 77);
+    written.replicas.nEvents = 1000;
+    for (unsigned int iSum = 0; iSum < written.replicas.sumw.size(); iSum++)
+        written.replicas.sumw[iSum] = 0.5 * iSum;
+    for (int iReplica = 0; iReplica < 3; iReplica++)
+        written.replicas.generated[iReplica] = 999 + iReplica;
+
+    cutflowrecord read;
+    bool same = write_cutflow("check.cutflow", written)
+        && read_cutflow("check.cutflow", read)
+        && read.mstop == written.mstop && read.mgluino == written.mgluino
+        && read.iSR == written.iSR && read.shardIndex == written.shardIndex
+        && read.shardCount == written.shardCount && read.seed == written.seed
+        && read.nEvent == written.nEvent && close_to(read.result, written.result)
+        && read.decision == written.decision
+        && close_to(read.confidence, written.confidence)
+        && read.counts.size() == written.counts.size();
+    for (unsigned int iCut = 0; same && iCut < read.counts.size(); iCut++)
+        same = (read.counts[iCut].label == written.counts[iCut].label)
+            && (read.counts[iCut].count == written.counts[iCut].count)
+            && close_to(read.counts[iCut].sumw, written.counts[iCut].sumw)
+            && close_to(read.counts[iCut].sumw2, written.counts[iCut].sumw2);
+    check("write_cutflow / read_cutflow: same record back", same);
+
+    same = (read.replicas.nReplicas == 3)
+        && (read.replicas.sumw.size() == written.replicas.sumw.size());
+    for (unsigned int iSum = 0; same && iSum < read.replicas.sumw.size(); iSum++)
+        same = close_to(read.replicas.sumw[iSum], written.replicas.sumw[iSum]);
+    check("write_cutflow / read_cutflow: same replicas back", same);
+
+    // A file that was cut short (the last cut line lost) isn't a record
+    ifstream instream("check.cutflow");
+    vector<string> lines;
+    string line;
+    while (getline(instream, line)) lines.push_back(line);
+    instream.close();
+    ofstream outstream("check.cutflow");
+    for (unsigned int iLine = 0; iLine < lines.size(); iLine++)
+        if (lines[iLine].substr(0, 4) != "cut\t" || 
+            lines[iLine].find("Passed") == string::npos)
+            outstream << lines[iLine] << '\n';
+    outstream.close();
+    check("read_cutflow: refuses a file with fewer cuts than 'stages'",
+        !read_cutflow("check.cutflow", read));
+
+
+    // MERGE
+    // -----
+    // Shards of the same point add up; other points and cuts are refused
+    int nShards = 3, nTotal = 1001;
+    cutflowrecord total;
+    int nEvents = 0;
+    bool merged = true;
+    for (int iShard = 0; iShard < nShards; iShard++){
+        int nShard = shard_events(nTotal, iShard, nShards);
+        nEvents += nShard;
+        cutflowrecord shard = check_record(iShard, nShards, nShard);
+        if (iShard == 0) total = shard;
+        else merged = merged && merge_cutflow(total, shard);
+    }
+    check("shard_events: the shards add up to the total", nEvents == nTotal);
+
+    double sumw = 0.0;
+    int count = 0;
+    for (int iShard = 0; iShard < nShards; iShard++){
+        cutflowrecord shard = check_record(iShard, nShards,
+            shard_events(nTotal, iShard, nShards));
+        sumw += shard.counts[1].sumw;
+        count += shard.counts[1].count;
+    }
+    check("merge_cutflow: counts, weights and events add up", merged
+        && total.nEvent == nTotal && total.counts[1].count == count
+        && close_to(total.counts[1].sumw, sumw));
+
+    cutflowrecord other = check_record(0, 1, 10);
+    other.mgluino = "900";
+    cutflowrecord before = total;
+    bool refused = !merge_cutflow(total, other)
+        && total.counts[0].count == before.counts[0].count;
+    other = check_record(0, 1, 10);
+    other.counts.pop_back();
+    refused = refused && !merge_cutflow(total, other);
+    check("merge_cutflow: refuses other points and other cuts", refused);
+
+    remove("check.cutflow");
+} // end check_cutflows
+
+
+
+string check_key(vector<string> settings, string spcfile, int iSR){
+    // The cache key of a run of check.cmnd with these settings
+    
+    vector<string> lines = effective_settings("check.cmnd", settings);
+    return cache_key(lines, spcfile, iSR);
+} // end check_key
+
+
+
+void check_cache(){
+    // FlipCache.h (and fnv1a in FlipCutflow.h)
+
+    // Test vectors of the 64 bit FNV-1a
+    check("fnv1a: published test vectors", 
+        fnv1a("") == 14695981039346656037UL && 
+        fnv1a("a") == 0xaf63dc4c8601ec8cUL &&
+        fnv1a("foobar") == 0x85944171f73967e8UL &&
+        fnv1a("bar", fnv1a("foo")) == fnv1a("foobar"));
+
+    ofstream cmnd("check.cmnd");
+    cmnd << "! check command file" << '\n'
+         << "Main:numberOfEvents = 1000     ! events" << '\n'
+         << "SLHA:file = check.spc" << '\n';
+    cmnd.close();
+    ofstream spc("check.spc");
+    spc << "BLOCK MASS" << '\n' << "   1000006     3.00000000E+02" << '\n';
+    spc.close();
+    ofstream copy("check.copy.spc");
+    copy << "BLOCK MASS" << '\n' << "   1000006     3.00000000E+02" << '\n';
+    copy.close();
+
+    vector<string> settings;
+    settings.push_back("RPVg:seed = 5");
+    string key = check_key(settings, "check.spc", 8);
+    check("cache_key: 16 hex digits, the same for the same run", 
+        key.size() == 16 && key.find_first_not_of("0123456789abcdef") 
+        == string::npos && key == check_key(settings, "check.spc", 8));
+
+    vector<string> same = settings;
+    same[0] = "rpvg:SEED=5   ! comment";
+    same.push_back("RPVg:cache = on");
+    same.push_back("RPVg:status = off");
+    same.push_back("RPVg:timing = on");
+    check("cache_key: ignores case, spaces, comments and run-only settings",
+        key == check_key(same, "check.spc", 8)
+        && key == check_key(settings, "check.copy.spc", 8));
+
+    vector<string> other = settings;
+    other.push_back("Main:numberOfEvents = 2000");
+    bool differs = (key != check_key(settings, "check.spc", 7))
+        && (key != check_key(other, "check.spc", 8));
+    other = settings;
+    other[0] = "RPVg:seed = 6";
+    differs = differs && (key != check_key(other, "check.spc", 8));
+    ofstream changed("check.copy.spc", ios::app);
+    changed << "   1000021     8.00000000E+02" << '\n';
+    changed.close();
+    differs = differs && (key != check_key(settings, "check.copy.spc", 8));
+    check("cache_key: differs for another SR, setting, seed or spectrum",
+        differs);
+
+    vector<string> lines = effective_settings("check.cmnd", settings);
+    vector<string> none;
+    vector<string> unseeded = effective_settings("check.cmnd", none);
+    check("cache_policy: only RPVg:seed runs are cached",
+        cache_policy(lines).use && !cache_policy(unseeded).use);
+
+    remove("check.cmnd");
+    remove("check.spc");
+    remove("check.copy.spc");
+} // end check_cache
+
+
+
+bool stratified(vector< vector<double> >& points, int iDim, int nSlices){
+    // TRUE if each of the nSlices slices of dimension iDim has as many
+    // points (and every point is in [0, 1))
+
+    vector<int> nInSlice(nSlices, 0);
+    for (unsigned int iPoint = 0; iPoint < points.size(); iPoint++){
+        double x = points[iPoint][iDim];
+        if (x < 0.0 || x >= 1.0) return false;
+        nInSlice[int(x * nSlices)]++;
+    }
+    for (int iSlice = 0; iSlice < nSlices; iSlice++)
+        if (nInSlice[iSlice] * nSlices != int(points.size())) return false;
+    return true;
+} // end stratified
+
+
+
+void check_sampling(){
+    // FlipScan.h
+
+    // GRID
+    vector<int> steps(2);
+    steps[0] = 3;
+    steps[1] = 4;
+    vector< vector<double> > points;
+    grid_points(steps, points);
+    check("grid_points: every combination, ends included, the last"
+        " dimension fastest", points.size() == 12 
+        && points[0][0] == 0.0 && points[0][1] == 0.0
+        && points[1][0] == 0.0 && close_to(points[1][1], 1.0 / 3)
+        && points[4][0] == 0.5 && points[4][1] == 0.0
+        && points[11][0] == 1.0 && points[11][1] == 1.0);
+
+    // SOBOL
+    // The first points of the first two dimensions (Joe & Kuo)
+    const double first[8][2] = { {0, 0}, {0.5, 0.5}, {0.75, 0.25}, 
+        {0.25, 0.75}, {0.375, 0.375}, {0.875, 0.875}, {0.625, 0.125}, 
+        {0.125, 0.625} };
+    sobol_points(8, 2, points);
+    bool known = (points.size() == 8);
+    for (int iPoint = 0; known && iPoint < 8; iPoint++)
+        known = (points[iPoint][0] == first[iPoint][0]) 
+            && (points[iPoint][1] == first[iPoint][1]);
+    check("sobol_points: the first points of the sequence", known);
+
+    // The first 2^m points put one point in each of 2^m slices of every 
+    // dimension, and (first two dimensions) in each 2^a x 2^(m-a) box
+    int m = 6, nPoints = 1 << m;
+    sobol_points(nPoints, nSobolDimensions, points);
+    bool even = (int(points.size()) == nPoints);
+    for (int iDim = 0; even && iDim < nSobolDimensions; iDim++)
+        even = stratified(points, iDim, nPoints);
+    for (int a = 0; even && a <= m; a++){
+        vector<int> nInBox(nPoints, 0);
+        for (int iPoint = 0; iPoint < nPoints; iPoint++)
+            nInBox[(int(points[iPoint][0] * (1 << a)) << (m - a))
+                + int(points[iPoint][1] * (1 << (m - a)))]++;
+        for (int iBox = 0; even && iBox < nPoints; iBox++)
+            even = (nInBox[iBox] == 1);
+    }
+    check("sobol_points: one point per slice of every dimension, per box of"
+        " the first two", even);
+
+    // LATIN HYPERCUBE
+    lhs_points(50, 3, 17, points);
+    bool latin = (points.size() == 50);
+    for (int iDim = 0; latin && iDim < 3; iDim++)
+        latin = stratified(points, iDim, 50);
+    check("lhs_points: one point per slice of every dimension", latin);
+
+    vector< vector<double> > again, other;
+    lhs_points(50, 3, 17, again);
+    lhs_points(50, 3, 18, other);
+    check("lhs_points: the same for the same seed, not for another",
+        points == again && points != other);
+} // end check_sampling
+
+
+
+void check_schedule(){
+    // FlipSchedule.h
+
+    // THE RUN TIME MODEL
+    // Timing rows (through the timing file) from an exact model, every 
+    // SR at every mass point: the fit has to give the model back
+    const double c0 = -7.0, c1 = 0.5, c2 = 1.5, dSR[2] = { 0.3, -0.3 };
+    remove("check.timing");
+    bool written = true;
+    for (int iStop = 0; iStop < 3; iStop++)
+        for (int iGluino = 0; iGluino < 3; iGluino++)
+            for (int iSR = 0; iSR < 2; iSR++){
+                runtiming timing;
+                timing.mstop        = 300 + 100 * iStop;
+                timing.mgluino      = 800 + 200 * iGluino;
+                timing.iSR          = iSR;
+                timing.nEvents      = 1000 * (1 + iSR);
+                timing.initSeconds  = 2.0;
+                timing.eventSeconds = timing.nEvents * exp(c0 
+                    + c1 * timing.mstop / 1000 + c2 * timing.mgluino / 1000 
+                    + dSR[iSR]);
+                written = written && append_timing("check.timing", timing);
+            }
+    vector<runtiming> timings;
+    bool read = written && read_timings("check.timing", timings)
+        && timings.size() == 18;
+    check("append_timing / read_timings: every row back", read);
+    remove("check.timing");
+
+    costmodel model;
+    fit_costs(timings, model);
+    double predicted = predict_cost(model, 450, 900, 1, 5000);
+    double exact = 2.0 + 5000 * exp(c0 + c1 * 0.45 + c2 * 0.9 + dSR[1]);
+    check("fit_costs: an exact model comes back", model.nRuns == 18
+        && fabs(model.coefficient[1] - c1) < 1e-3 
+        && fabs(model.coefficient[2] - c2) < 1e-3
+        && fabs(predicted / exact - 1.0) < 1e-3);
+    costmodel empty;
+    check("predict_cost: 0 without a model", 
+        predict_cost(empty, 450, 900, 1, 5000) == 0.0);
+
+    // LONGEST FIRST
+    const double jobCosts[7] = { 1, 1, 1, 1, 2, 2, 4 };
+    vector<double> costs(jobCosts, jobCosts + 7);
+    vector<int> order, worker;
+    double span = longest_first(costs, 2, order, worker);
+    bool sorted = (order.size() == 7) && (worker.size() == 7);
+    for (unsigned int iJob = 1; sorted && iJob < order.size(); iJob++)
+        sorted = costs[order[iJob-1]] > costs[order[iJob]] || 
+            (costs[order[iJob-1]] == costs[order[iJob]] 
+             && order[iJob-1] < order[iJob]);
+    check("longest_first: longest first, ties in scan order", sorted);
+
+    vector<double> load(2, 0.0);
+    for (unsigned int iJob = 0; iJob < costs.size(); iJob++)
+        load[worker[iJob]] += costs[iJob];
+    vector<double> inOrder;
+    for (unsigned int iJob = 0; iJob < order.size(); iJob++)
+        inOrder.push_back(costs[order[iJob]]);
+    check("longest_first: the makespan of its own assignment",
+        span == max(load[0], load[1]) && span == makespan(inOrder, 2));
+
+    // 12 / 2 is the best possible, and LPT finds it here; scan order
+    // leaves the 4 to the end
+    check("longest_first: the best makespan here, better than scan order",
+        span == 6.0 && makespan(costs, 2) == 8.0);
+} // end check_schedule
+
+
+
+int main() {
+
+    cout << endl << "RPVgCheck" << endl;
+    check_cutflows();
+    check_cache();
+    check_sampling();
+    check_schedule();
+
+    cout << endl << (nFailed == 0 ? "All checks passed" : "FAILED: see above")
+         << endl;
+    return (nFailed == 0) ? 0 : 1;
+} // end main
@@ -0,0 +1,103 @@
+/********************************************************************************
+*   RPVgEffMap.cc                                                               *
+*   Estimates a yield from an efficiency map, without Pythia, Oct 2026         *
+*                                                                               *
+*   Usage:  ./RPVgEffMap [map] [mstop] [mgluino] [SR] [sigma (fb)]             *
+*                        [luminosity (fb^-1)] [SS fraction]                     *
+*                        [BR(W -> e or mu)] [BR(W -> tau)]                      *
+*   e.g.    ./RPVgEffMap effmap.dat 350 850 8 120 10.5                          *
+*                                                                               *
+*   The map is made by runs with RPVg:effMap = on (see FlipEffMap.h). For      *
+*   each decay topology this prints the fraction of the model's events in it  *
+*   and the efficiency interpolated from the map, then the total efficiency   *
+*   and (with a cross section) the expected # of signal events. The defaults  *
+*   are the model of the runs: half of the top pairs same sign (Majorana       *
+*   gluinos), Pythia's W branching ratios.                                      *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipEffMap.h"             // efficiency maps
+#include <cstdlib>                  // for atof
+using namespace std;
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 5){
+        cout << "Usage: ./RPVgEffMap [map] [mstop] [mgluino] [SR] [sigma (fb)]"
+             << " [luminosity (fb^-1)] [SS fraction] [BR(W -> e or mu)]"
+             << " [BR(W -> tau)]" << endl;
+        return 1;
+    }
+
+    string mapfile      = argv[1];
+    double mstop        = atof(argv[2]);
+    double mgluino      = atof(argv[3]);
+    int iSR             = atoi(argv[4]);
+    double sigma        = 0.0;          // fb; 0: efficiencies only
+    double luminosity   = 10.5;         // fb^-1, as RPVg:luminosity
+    double fractionSS   = 0.5;          // Majorana gluinos
+    double BRlepton     = 0.2171;       // W -> e nu, mu nu
+    double BRtau        = 0.1086;       // W -> tau nu
+    if (argc > 5) sigma         = atof(argv[5]);
+    if (argc > 6) luminosity    = atof(argv[6]);
+    if (argc > 7) fractionSS    = atof(argv[7]);
+    if (argc > 8) BRlepton      = atof(argv[8]);
+    if (argc > 9) BRtau         = atof(argv[9]);
+
+    effmap emap;
+    if (!read_effmap(mapfile, emap)){
+        cout << "ERROR: can't read efficiency map " << mapfile << endl;
+        return 1;
+    }
+
+    double fractions[nTopologies];
+    model_fractions(fractionSS, BRlepton, BRtau, fractions);
+
+
+    // EFFICIENCY OF EACH TOPOLOGY
+    // ---------------------------
+    cout << endl << "mstop " << mstop << ", mgluino " << mgluino << ", SR "
+         << iSR << endl << endl;
+    cout << "topology\tfraction\tefficiency" << endl;
+
+    double efficiency = 0.0, variance = 0.0;
+    bool allInside = true;
+    for (int iTopo = 0; iTopo < nTopologies; iTopo++){
+        double error;
+        bool inside;
+        double topoEfficiency = map_efficiency(emap, mstop, mgluino, iSR, iTopo,
+            &error, &inside);
+
+        bool inMap = false;
+        for (unsigned int iEntry = 0; iEntry < emap.entries.size(); iEntry++)
+            if (emap.entries[iEntry].iSR == iSR &&
+                emap.entries[iEntry].topology == iTopo) inMap = true;
+
+        cout << topology_name[iTopo] << "\t\t" << fractions[iTopo] << "\t";
+        if (!inMap) cout << "not in map, taken as 0" << endl;
+        else {
+            cout << topoEfficiency << " +- " << error
+                 << (inside ? "" : "  (not between grid points)") << endl;
+            if (!inside && fractions[iTopo] > 0) allInside = false;
+        }
+
+        efficiency += fractions[iTopo] * topoEfficiency;
+        variance += fractions[iTopo] * fractions[iTopo] * error * error;
+    } // end loop over topologies
+
+
+    // TOTAL
+    // -----
+    cout << endl << "efficiency:\t" << efficiency << " +- " << sqrt(variance)
+         << endl;
+    if (sigma > 0)
+        cout << "yield:\t\t" << sigma * luminosity * efficiency << " +- "
+             << sigma * luminosity * sqrt(variance) << "  (" << sigma
+             << " fb, " << luminosity << " fb^-1)" << endl;
+    if (!allInside)
+        cout << "NOTE: some efficiencies are from the nearest map points, not"
+             << " from a grid around this point" << endl;
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/********************************************************************************
+*   RPVgEvents.cc                                                               *
+*   Combines signal regions from per-event records, without Pythia, Oct 2026   *
+*                                                                               *
+*   Usage:  ./RPVgEvents [record files] [union a,b,...] [overlap a,b,...]      *
+*                        [best limits]                                          *
+*   e.g.    ./RPVgEvents output.dat.300_800_SR*.events union 7,8 best         *
+*               "5.6, 7.1, 4.3, 3.9, 6.2, 5.0, 4.4, 3.6, 3.0"                   *
+*                                                                               *
+*   The records are written by runs with RPVg:eventRecord = on (see           *
+*   FlipEvents.h). Records of the same mass point are added up (shards, runs  *
+*   for other SRs). For each point this prints the efficiency of every SR,    *
+*   the correlations between the SRs (of passing, weighted), and then:        *
+*       union a,b,...       efficiency of passing any of these SRs             *
+*       overlap a,b,...     efficiency of passing all of them                  *
+*       best limits         the SR with the largest efficiency / upper limit  *
+*                           (limits as RPVg:upperLimits, one per SR)           *
+*   The best SR is picked on the same events it's evaluated on: for a         *
+*   result, pick it on one sample and quote it from another.                   *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipEvents.h"             // per-event records
+#include "FlipLimit.h"              // for upper_limit
+#include <map>
+#include <iomanip>                  // for setprecision
+#include <cmath>                    // for sqrt
+#include <cstdlib>                  // for atoi
+using namespace std;
+
+struct pointrecords{
+    // everything read for one mass point
+    int nRegions;
+    int nFiles;
+    long nGenerated;
+    double sumwGenerated;
+    vector<eventrecord> records;
+    pointrecords() : nRegions(0), nFiles(0), nGenerated(0), sumwGenerated(0) {}
+};
+
+
+
+unsigned int region_mask(string regions){
+    // "7,8" -> bits 7 and 8
+    unsigned int mask = 0;
+    stringstream regionstream(regions);
+    string region;
+    while (getline(regionstream, region, ','))
+        mask |= 1u << atoi(region.c_str());
+    return mask;
+} // end region_mask
+
+
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2){
+        cout << "Usage: ./RPVgEvents [record files] [union a,b,...]"
+             << " [overlap a,b,...] [best limits]" << endl;
+        return 1;
+    }
+
+    // READ THE RECORDS
+    // ----------------
+    // Files up to the first keyword, grouped by mass point
+    map< pair<double,double>, pointrecords > points;
+    int iArg = 1;
+    for (; iArg < argc; iArg++){
+        string arg = argv[iArg];
+        if (arg == "union" || arg == "overlap" || arg == "best") break;
+
+        eventfile header;
+        vector<eventrecord> records;
+        if (!read_events(arg, header, records)){
+            cout << "ERROR: " << arg << " is not an event record" << endl;
+            continue;
+        }
+        pointrecords& point = points[make_pair(header.mstop, header.mgluino)];
+        if (point.nFiles > 0 && point.nRegions != header.nRegions){
+            cout << "ERROR: " << arg << " has " << header.nRegions
+                 << " SRs, not " << point.nRegions << "; skipped" << endl;
+            continue;
+        }
+        if (header.nGenerated == 0)
+            cout << "ERROR: " << arg << " wasn't closed (run still going or"
+                 << " died?); skipped" << endl;
+        if (header.nGenerated == 0) continue;
+
+        point.nRegions = header.nRegions;
+        point.nFiles++;
+        point.nGenerated += header.nGenerated;
+        point.sumwGenerated += header.sumwGenerated;
+        point.records.insert(point.records.end(), records.begin(),
+            records.end());
+    } // end loop over files
+    if (points.empty()){
+        cout << "ERROR: no event records" << endl;
+        return 1;
+    }
+
+    map< pair<double,double>, pointrecords >::iterator iPoint;
+    for (iPoint = points.begin(); iPoint != points.end(); iPoint++){
+        pointrecords& point = iPoint->second;
+        double nGenerated = point.nGenerated;
+        int nRegions = min(point.nRegions, 16);
+
+        cout << endl << "mstop " << iPoint->first.first << ", mgluino "
+             << iPoint->first.second << ": " << point.nFiles << " files, "
+             << point.nGenerated << " events generated, "
+             << point.records.size() << " recorded" << endl << endl;
+
+
+        // EFFICIENCY OF EACH SR
+        // ---------------------
+        vector<double> efficiency(nRegions), error(nRegions);
+        cout << "SR\tefficiency" << endl;
+        for (int iSR = 0; iSR < nRegions; iSR++){
+            double sumw2;
+            double sumw = mask_sumw(point.records, 1u << iSR, true, sumw2);
+            efficiency[iSR] = sumw / nGenerated;
+            error[iSR] = sqrt(sumw2) / nGenerated;
+            cout << iSR << "\t" << efficiency[iSR] << " +- " << error[iSR]
+                 << endl;
+        }
+
+
+        // CORRELATIONS
+        // ------------
+        // Between passing SR r and passing SR s, with the events weighted:
+        //  (p_rs - p_r p_s) / sqrt(p_r (1 - p_r) p_s (1 - p_s))
+        vector<double> fraction(nRegions);
+        for (int iSR = 0; iSR < nRegions; iSR++)
+            fraction[iSR] = efficiency[iSR] * nGenerated / point.sumwGenerated;
+
+        cout << endl << "correlations" << endl << "SR";
+        for (int iSR = 0; iSR < nRegions; iSR++) cout << "\t" << iSR;
+        cout << endl << fixed << setprecision(2);
+        for (int iSR = 0; iSR < nRegions; iSR++){
+            cout << iSR;
+            for (int jSR = 0; jSR < nRegions; jSR++){
+                double sumw2;
+                double both = mask_sumw(point.records,
+                    (1u << iSR) | (1u << jSR), true, sumw2)
+                    / point.sumwGenerated;
+                double variance = fraction[iSR] * (1 - fraction[iSR])
+                    * fraction[jSR] * (1 - fraction[jSR]);
+                cout << "\t";
+                if (variance > 0)
+                    cout << (both - fraction[iSR] * fraction[jSR])
+                        / sqrt(variance);
+                else cout << "-";
+            }
+            cout << endl;
+        } // end loop over SRs
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+
+
+        // COMBINATIONS
+        // ------------
+        for (int jArg = iArg; jArg + 1 < argc; jArg += 2){
+            string combination = argv[jArg];
+            string regions = argv[jArg+1];
+            if (combination == "best") continue;
+
+            double sumw2;
+            double sumw = mask_sumw(point.records, region_mask(regions),
+                combination == "overlap", sumw2);
+            cout << endl << combination << " of SRs " << regions << ":\t"
+                 << sumw / nGenerated << " +- " << sqrt(sumw2) / nGenerated
+                 << endl;
+        } // end loop over combinations
+
+        // The best expected SR: the most signal events per allowed event
+        for (int jArg = iArg; jArg + 1 < argc; jArg += 2){
+            if (string(argv[jArg]) != "best") continue;
+
+            int best = -1;
+            double bestRatio = 0.0;
+            cout << endl << "SR\tefficiency / limit" << endl;
+            for (int iSR = 0; iSR < nRegions; iSR++){
+                double limit = upper_limit(argv[jArg+1], iSR);
+                if (limit <= 0.0){
+                    cout << iSR << "\tno limit" << endl;
+                    continue;
+                }
+                double ratio = efficiency[iSR] / limit;
+                cout << iSR << "\t" << ratio << endl;
+                if (ratio > bestRatio){
+                    bestRatio = ratio;
+                    best = iSR;
+                }
+            }
+            if (best < 0) cout << "best SR: none" << endl;
+            else cout << "best SR: " << best << ", efficiency "
+                << efficiency[best] << " +- " << error[best] << endl;
+        } // end loop over best
+    } // end loop over points
+    cout << endl;
+
+    return 0;
+}
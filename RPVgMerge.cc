@@ -0,0 +1,130 @@
+/******************************************************************************** 
+*   RPVgMerge.cc                                                                *
+*   Combines the shards of a sharded RPVgPoint run into one result, Oct 2026   *
+*                                                                               *
+*   Usage:  ./RPVgMerge [output] [shard files ...]                              *
+*   e.g.    ./RPVgMerge output.dat output.dat.300_800_SR8.shard*                *
+*                                                                               *
+*   Appends one row to the output file, in the same format as an unsharded     *
+*   run of RPVgPoint, and prints the combined cutflow with the binomial        *
+*   uncertainty of each count. The combined cutflow is also saved next to the  *
+*   output file as shard 0 of 1 (e.g. output.dat.300_800_SR8.shard0of1).        *
+*   If every shard has histograms ([shard file].hist), so does the result.     *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipCutflow.h"            // cutflow records
+#include "FlipHistograms.h"         // cut stage histograms
+#include <vector>                   // for vectors
+#include <fstream>                  // for file in/out
+using namespace std;
+
+int main(int argc, char *argv[]) { 
+
+    if (argc < 3){
+        cout << "Usage: ./RPVgMerge [output] [shard files ...]" << endl;
+        return 1;
+    }
+    
+    string outfile = argv[1];
+    
+    
+    // READ AND SUM SHARDS
+    // -------------------
+    cutflowrecord total;
+    vector<bool> found;             // which shards we've seen
+    histogramset histograms;        // sum of the shards' histograms ...
+    bool haveHistograms = true;     // ... if they all have them
+    
+    for (int iArg = 2; iArg < argc; iArg++){
+        cutflowrecord shard;
+        if (!read_cutflow(argv[iArg], shard)){
+            cout << "ERROR reading " << argv[iArg] << endl;
+            return 1;
+        }
+        
+        // The shard number indexes found: don't trust it
+        if (shard.shardCount < 1 || shard.shardIndex < 0 || 
+            shard.shardIndex >= shard.shardCount){
+            cout << "ERROR: " << argv[iArg] << " says it is shard " 
+                 << shard.shardIndex << " of " << shard.shardCount << endl;
+            return 1;
+        }
+        
+        if (iArg == 2){
+            total = shard;
+            found.assign(shard.shardCount, false);
+        }
+        else if (shard.shardCount != int(found.size())){
+            cout << "ERROR: " << argv[iArg] << " is one of " 
+                 << shard.shardCount << " shards, " << argv[2] << " one of "
+                 << found.size() << endl;
+            return 1;
+        }
+        else if (!merge_cutflow(total, shard)){
+            cout << "ERROR: " << argv[iArg] << " is not a shard of the same "
+                 << "run as " << argv[2] << endl;
+            return 1;
+        }
+        
+        if (found[shard.shardIndex]){
+            cout << "ERROR: shard " << shard.shardIndex << " appears twice" 
+                 << endl;
+            return 1;
+        }
+        found[shard.shardIndex] = true;
+        
+        histogramset shardhist;
+        if (!haveHistograms || !read_histograms(string(argv[iArg]) + ".hist", 
+            shardhist)) haveHistograms = false;
+        else if (iArg == 2) histograms = shardhist;
+        else if (!add_histograms(histograms, shardhist)){
+            cout << "WARNING: histograms of " << argv[iArg] << " don't match, "
+                 << "not merging histograms" << endl;
+            haveHistograms = false;
+        }
+    } // end loop over shard files
+    
+    for (unsigned int iShard = 0; iShard < found.size(); iShard++)
+        if (!found[iShard]) cout << "WARNING: shard " << iShard << " of " 
+            << found.size() << " is missing" << endl;
+    
+    
+    // UNCERTAINTIES
+    // -------------
+    // The uncertainty on each (weighted) count is for a fixed number of 
+    // generated events (the first entry of the cutflow), which is why the 
+    // shards have to be summed before it is computed. See cut_error.
+    //
+    double nGenerated = total.counts[0].count;
+    cout << endl;
+    for (unsigned int iCut = 0; iCut < total.counts.size(); iCut++){
+        cout << total.counts[iCut].label << ":\t" << total.counts[iCut].count 
+             << "\t" << total.counts[iCut].sumw << " +- " 
+             << cut_error(total.counts[iCut], nGenerated) << endl;
+    } // end loop over cuts
+    
+    cout << endl << "result:\t" << total.result << " +- " 
+         << cut_error(total.counts.back(), nGenerated) << endl;
+    
+    // Bootstrap (RPVg:bootstrap), if every shard had the same # replicas
+    read_replicas(total);
+    
+    
+    // OUTPUT
+    // ------
+    write_result(outfile, total);
+    
+    // Saved as if it were a single run (shard 0 of 1) of the point
+    total.shardIndex = 0;
+    total.shardCount = 1;
+    string mergedfile = cutflow_filename(outfile, total.mstop, total.mgluino, 
+        total.iSR, 0, 1);
+    if (!write_cutflow(mergedfile, total))
+        cout << "ERROR writing cutflow to " << mergedfile << endl;
+    if (haveHistograms && 
+        !write_histograms(mergedfile + ".hist", histograms, total.counts))
+        cout << "ERROR writing histograms to " << mergedfile << ".hist" << endl;
+    
+    return 0;
+}
@@ -0,0 +1,380 @@
+/********************************************************************************
+*   RPVgScan.cc                                                                 *
+*   Scans over any SLHA entries and Pythia settings, Oct 2026                   *
+*                                                                               *
+*   Usage:  ./RPVgScan [scan file] [all | list | point k | plan W |            *
+*                                   worker w W]                                 *
+*   e.g.    ./RPVgScan scan.txt list                                            *
+*           ./RPVgScan scan.txt point 17        (e.g. from a batch array)       *
+*           ./RPVgScan scan.txt worker 3 16     (share 3 of 16)                 *
+*                                                                               *
+*   The scan file (see FlipScan.h) names the parameters and how to sample      *
+*   them. Every point goes through the same patching and recast as            *
+*   RPVgPoint (see FlipRunPoint.cpp); each SR of each point appends a row to   *
+*   the scan's output file:                                                     *
+*       point  SR  [value of each parameter]  result  #generated               *
+*   (plus the early stop decision if there is one, and the bootstrap error    *
+*   and 95% interval with RPVg:bootstrap). The values are written exactly as  *
+*   the run got them. The first row written to a new file is a '#' header     *
+*   with the parameter names. Rows are appended under a lock, so any number   *
+*   of workers (or scans) may share the file.                                  *
+*                                                                               *
+*   'list' prints the points without running them; 'point k' runs only point  *
+*   k, so that a batch system can spread the scan over many nodes.             *
+*                                                                               *
+*   Run times are predicted from the scan's timing file, which its runs       *
+*   append to (see FlipSchedule.h), and the longest runs go first: 'all' keeps 'workers'     *
+*   (scan file) runs going at once, each in a forked process; 'plan W' packs  *
+*   the runs into W shares of about the same time, and 'worker w W' runs       *
+*   share w. The predicted makespan is printed first, the actual one last.    *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipRunPoint.h"           // does all the work
+#include "FlipScan.h"               // scan files and sampling
+#include <vector>                   // for vectors
+#include <map>                      // for running workers
+#include <cstdio>                   // for sprintf, freopen, remove
+#include <unistd.h>                 // for fork
+#include <sys/stat.h>               // for mkdir
+#include <sys/wait.h>               // for waitpid
+using namespace std;
+
+
+string job_value(scandimension& dimension, double value){
+    // A value as the run gets it: the string that goes into the settings,
+    // the masses or the spectrum (SLHA entries like the templates)
+
+    string name = dimension.name;
+    transform(name.begin(), name.end(), name.begin(), ::toupper);
+    if (is_setting(dimension) || name == "MASS/1000006" || 
+        name == "MASS/1000021") return scan_value(value);
+
+    char text[32];
+    sprintf(text, "%.8E", value);
+    return text;
+} // end job_value
+
+
+
+pointjob scan_job(scanspec& spec, vector<double>& values, int iPoint, int iSR){
+    // The RPVgPoint run for one point and SR
+
+    pointjob job;
+    job.mstop       = spec.mstop;
+    job.mgluino     = spec.mgluino;
+    job.iSR         = iSR;
+    job.cmndtemp    = spec.cmndtemp;
+    job.spctemp     = spec.spctemp;
+    job.outfile     = "";               // rows are written below
+    job.settings    = spec.settings;
+    job.settings.push_back("RPVg:timing = on");
+    job.settings.push_back("RPVg:timingFile = " + spec.timing);
+    stringstream tag;
+    tag << ".scan" << iPoint << "_SR" << iSR;
+    job.tag         = tag.str();
+
+    // Different points get different seeds (and the same point the same)
+    if (spec.seed != 0){
+        stringstream seedkey, seedstring;
+        seedkey << spec.seed << ":scan:" << iPoint;
+        seedstring << "RPVg:seed = " << 1 + long(fnv1a(seedkey.str()) % 900000000UL);
+        job.settings.push_back(seedstring.str());
+    }
+
+    for (unsigned int iDim = 0; iDim < spec.dimensions.size(); iDim++){
+        scandimension& dimension = spec.dimensions[iDim];
+        string name = dimension.name;
+        transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+        string value = job_value(dimension, values[iDim]);
+
+        if (is_setting(dimension))
+            job.settings.push_back(dimension.name + " = " + value);
+        else if (name == "MASS/1000006") job.mstop = value;
+        else if (name == "MASS/1000021") job.mgluino = value;
+        else job.spectrum.push_back(make_pair(dimension.name, value));
+    } // end loop over dimensions
+
+    return job;
+} // end scan_job
+
+
+
+string scan_header(scanspec& spec){
+    // The '#' header with the parameter names
+
+    stringstream header;
+    header << "# point\tSR";
+    for (unsigned int iDim = 0; iDim < spec.dimensions.size(); iDim++)
+        header << "\t" << spec.dimensions[iDim].name;
+    header << "\tresult\tgenerated\n";
+    return header.str();
+} // end scan_header
+
+
+
+void write_scan_row(scanspec& spec, vector<double>& values, int iPoint,
+    cutflowrecord& record){
+    // One row per point and SR, in one locked append (with the header if
+    // the file is still empty)
+
+    stringstream outstream;
+    outstream << iPoint << "\t" << record.iSR;
+    for (unsigned int iDim = 0; iDim < values.size(); iDim++)
+        outstream << "\t" << job_value(spec.dimensions[iDim], values[iDim]);
+    outstream.precision(6);
+    outstream.setf(ios::fixed);
+    outstream.setf(ios::showpoint);
+    outstream << "\t" << record.result << "\t" << record.nEvent;
+    if (!record.decision.empty())
+        outstream << "\t" << record.decision << "\t" << record.confidence;
+    double error, low, high;
+    if (replica_spread(record.replicas, record.replicas.nStages - 1, 
+        record.counts[0].count, error, low, high))
+        outstream << "\t" << error << "\t" << low << "\t" << high;
+    outstream << '\n';
+    if (!append_locked(spec.output, outstream.str(), scan_header(spec)))
+        cout << "ERROR: can't append to " << spec.output << endl;
+} // end write_scan_row
+
+
+
+int run_scan_job(scanspec& spec, vector<double>& values, int iPoint, int iSR){
+    // One point and SR, start to finish; 0 if it went well
+
+    pointjob job = scan_job(spec, values, iPoint, iSR);
+    cutflowrecord record;
+    if (run_point(job, record) != 0){
+        cout << "ERROR: point " << iPoint << " SR " << iSR << " failed" << endl;
+        return 1;
+    }
+    write_scan_row(spec, values, iPoint, record);
+    return 0;
+} // end run_scan_job
+
+
+
+double scan_cost(scanspec& spec, vector<double>& values, int iPoint, int iSR,
+    costmodel& model){
+    // Predicted seconds for one point and SR (0: no timing data)
+
+    pointjob job = scan_job(spec, values, iPoint, iSR);
+    vector<string> effective = effective_settings(job.cmndtemp, job.settings);
+    int nEvents = atoi(effective_setting(effective, "Main:numberOfEvents",
+        "1000").c_str());
+    return predict_cost(model, atof(job.mstop.c_str()), atof(job.mgluino.c_str()),
+        iSR, nEvents);
+} // end scan_cost
+
+
+
+int run_pool(scanspec& spec, vector< vector<double> >& points,
+    vector< pair<int,int> >& jobs, vector<int>& order, vector<double>& costs){
+    // spec.nWorkers forked runs at once, in the given order. Pythia's
+    // output goes to RPVgScan.[pid]/point[k]_SR[i].log, kept if it failed.
+
+    stringstream workdirstream;
+    workdirstream << "RPVgScan." << getpid();
+    string workdir = workdirstream.str();
+    mkdir(workdir.c_str(), 0777);
+
+    map<pid_t, int> running;                // job of each worker
+    map<pid_t, double> started;
+    unsigned int next = 0;
+    int status = 0;
+
+    while (next < order.size() || !running.empty()){
+        while (next < order.size() && int(running.size()) < spec.nWorkers){
+            int iJob = order[next++];
+            int iPoint = jobs[iJob].first, iSR = jobs[iJob].second;
+            stringstream logname;
+            logname << workdir << "/point" << iPoint << "_SR" << iSR << ".log";
+
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0){
+                if (!freopen(logname.str().c_str(), "w", stdout)) _exit(1);
+                srand((unsigned)(time(0) + getpid()));
+                int jobstatus = run_scan_job(spec, points[iPoint], iPoint, iSR);
+                fflush(stdout);
+                _exit(jobstatus);
+            }
+            if (pid < 0){
+                cout << "ERROR: can't start a worker for point " << iPoint
+                    << " SR " << iSR << endl;
+                status = 1;
+                continue;
+            }
+            running[pid] = iJob;
+            started[pid] = wallclock();
+        } // end loop over jobs to start
+
+        int jobstatus;
+        pid_t pid = waitpid(-1, &jobstatus, 0);
+        if (pid < 0) break;
+        if (running.find(pid) == running.end()) continue;
+        int iJob = running[pid];
+        int iPoint = jobs[iJob].first, iSR = jobs[iJob].second;
+        stringstream logname;
+        logname << workdir << "/point" << iPoint << "_SR" << iSR << ".log";
+
+        cout << "point " << iPoint << " SR " << iSR << ": ";
+        if (WIFEXITED(jobstatus) && WEXITSTATUS(jobstatus) == 0){
+            cout << "done";
+            remove(logname.str().c_str());
+        }
+        else {
+            cout << "FAILED, see " << logname.str();
+            status = 1;
+        }
+        cout << " in " << wallclock() - started[pid] << " s";
+        if (costs[iJob] > 0) cout << " (predicted " << costs[iJob] << " s)";
+        cout << endl;
+        running.erase(pid);
+        started.erase(pid);
+    } // end loop over jobs
+
+    rmdir(workdir.c_str());                 // only if no logs are left
+    return status;
+} // end run_pool
+
+
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2){
+        cout << "Usage: ./RPVgScan [scan file] [all | list | point k | plan W"
+             << " | worker w W]" << endl;
+        return 1;
+    }
+    string mode = (argc > 2) ? argv[2] : "all";
+    srand((unsigned)time(0));               // as in RPVgPoint
+
+    scanspec spec;
+    if (!read_scan(argv[1], spec)) return 1;
+    vector< vector<double> > points = scan_points(spec);
+
+    int first = 0;
+    int last = points.size();
+    int nWorkers = spec.nWorkers;
+    int iWorker = -1;                       // 'worker' mode: this one
+    if (mode == "point"){
+        first = (argc > 3) ? atoi(argv[3]) : -1;
+        last = first + 1;
+        if (first < 0 || first >= int(points.size())){
+            cout << "ERROR: the scan has points 0 ... " << points.size() - 1
+                << endl;
+            return 1;
+        }
+    }
+    else if (mode == "plan" || mode == "worker"){
+        if (mode == "plan" && argc > 3) nWorkers = atoi(argv[3]);
+        if (mode == "worker"){
+            iWorker = (argc > 3) ? atoi(argv[3]) : -1;
+            nWorkers = (argc > 4) ? atoi(argv[4]) : 0;
+        }
+        if (nWorkers < 1 || (mode == "worker" && 
+            (iWorker < 0 || iWorker >= nWorkers))){
+            cout << "ERROR: usage ./RPVgScan [scan file] plan W, or worker w W"
+                << " with 0 <= w < W" << endl;
+            return 1;
+        }
+    }
+    else if (mode != "all" && mode != "list"){
+        cout << "ERROR: unknown mode " << mode << endl;
+        return 1;
+    }
+
+    cout << endl << "RPVgScan: " << points.size() << " points ("
+        << spec.sampling << ") in " << spec.dimensions.size()
+        << " dimensions, " << spec.regions.size() << " SRs each" << endl;
+
+
+    // RUN TIMES
+    // ---------
+    // Predicted from earlier runs (see FlipSchedule.h), to start the long
+    // ones first. Without timing data the jobs run in scan order.
+    //
+    vector<runtiming> timings;
+    read_timings(spec.timing, timings);
+    costmodel model;
+    fit_costs(timings, model);
+
+    vector< pair<int,int> > jobs;           // point, SR
+    vector<double> costs;                   // predicted seconds
+    for (int iPoint = first; iPoint < last; iPoint++)
+        for (unsigned int iSR = 0; iSR < spec.regions.size(); iSR++){
+            jobs.push_back(make_pair(iPoint, spec.regions[iSR]));
+            costs.push_back(scan_cost(spec, points[iPoint], iPoint,
+                spec.regions[iSR], model));
+        }
+
+    vector<int> order, worker;
+    double predicted = longest_first(costs, nWorkers, order, worker);
+    if (model.nRuns == 0){
+        for (unsigned int iJob = 0; iJob < jobs.size(); iJob++){
+            order[iJob] = iJob;             // scan order, ...
+            worker[iJob] = iJob % nWorkers; // ... dealt out in turn
+        }
+        cout << "No timing data in " << spec.timing << ": scan order" << endl;
+    }
+    else cout << "Run times from " << model.nRuns << " runs in " << spec.timing
+        << ": predicted makespan " << predicted << " s with " << nWorkers
+        << " workers, longest first (" << makespan(costs, nWorkers)
+        << " s in scan order)" << endl;
+
+
+    // LIST AND PLAN
+    // -------------
+    if (mode == "list" || mode == "point")
+        for (int iPoint = first; iPoint < last; iPoint++){
+            cout << "point " << iPoint << ":";
+            for (unsigned int iDim = 0; iDim < spec.dimensions.size(); iDim++)
+                cout << "  " << spec.dimensions[iDim].name << " = "
+                    << job_value(spec.dimensions[iDim], points[iPoint][iDim]);
+            cout << endl;
+        }
+    if (mode == "list") return 0;
+
+    if (mode == "plan"){
+        // For a batch system: worker w runs './RPVgScan [scan file] worker
+        // w W' (with the same timing file)
+        vector<double> load(nWorkers, 0.0);
+        cout << "worker\tpoint\tSR\tpredicted (s)" << endl;
+        for (unsigned int iJob = 0; iJob < order.size(); iJob++){
+            int jJob = order[iJob];
+            load[worker[jJob]] += costs[jJob];
+            cout << worker[jJob] << "\t" << jobs[jJob].first << "\t"
+                << jobs[jJob].second << "\t" << costs[jJob] << endl;
+        }
+        for (int jWorker = 0; jWorker < nWorkers; jWorker++)
+            cout << "worker " << jWorker << ": " << load[jWorker] << " s" << endl;
+        return 0;
+    }
+
+
+    // RUN
+    // ---
+    double startTime = wallclock();
+    double predictedHere = predicted;
+    int status = 0;
+    if (mode == "all" && nWorkers > 1)
+        status = run_pool(spec, points, jobs, order, costs);
+    else {
+        if (iWorker >= 0) predictedHere = 0.0;
+        for (unsigned int iJob = 0; iJob < order.size(); iJob++){
+            int jJob = order[iJob];
+            if (iWorker >= 0 && worker[jJob] != iWorker) continue;
+            if (iWorker >= 0) predictedHere += costs[jJob];
+            if (run_scan_job(spec, points[jobs[jJob].first], jobs[jJob].first,
+                jobs[jJob].second) != 0) status = 1;
+        } // end loop over jobs
+    }
+
+    cout << endl << "RPVgScan: done in " << wallclock() - startTime << " s";
+    if (model.nRuns > 0) cout << " (predicted " << predictedHere << " s)";
+    cout << endl;
+
+    return status;
+}
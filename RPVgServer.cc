@@ -0,0 +1,376 @@
+/********************************************************************************
+*   RPVgServer.cc                                                               *
+*   Serves RPVgPoint runs over a Unix domain socket, Oct 2026                   *
+*                                                                               *
+*   Usage:  ./RPVgServer [socket] [workers] [template cmnd] [template spc]      *
+*                        [output]                                               *
+*   e.g.    ./RPVgServer RPVg.sock 4 TEMPLATE.cmnd TEMPLATE.spc output.dat      *
+*                                                                               *
+*   Every RPVgPoint pays for constructing Pythia (reading the XML settings     *
+*   database) before it does anything. The server does that once and keeps    *
+*   the 'warm' Pythia object; each job runs in a forked copy of it, so jobs    *
+*   never see each other's settings or spectra. At most [workers] jobs run at  *
+*   once, the rest wait in a queue (first come, first served).                 *
+*                                                                               *
+*   Protocol: one request per line, e.g. with  nc -U RPVg.sock                  *
+*       300 800 8,9 ; Main:numberOfEvents = 5000 ; RPVg:seed = 3                *
+*   i.e. stop mass, gluino mass, signal regions (comma separated), then any   *
+*   Pythia/RPVg settings separated by ';' (see RPVg:targetPrecision to ask    *
+*   for a precision instead of a number of events). Every SR is one job:       *
+*       queued [job] [mstop] [mgluino] [SR]                                     *
+*   (an SR that doesn't exist gets 'error - no SR ...' instead)               *
+*   and, as soon as it's done, its cutflow record (the format of               *
+*   FlipCutflow.cpp, '# RPVg cutflow' first) followed by                       *
+*       done [job]                  or      error [job] [reason]               *
+*   Results of different jobs may come back in any order. Other requests:     *
+*       status      ->  'status [# queued] [# running]'                        *
+*       quit        closes the connection (its queued jobs are dropped)        *
+*       shutdown    finishes the running jobs and stops the server             *
+*   Rows are also appended to [output] like RPVgPoint does ('-': none),        *
+*   under a lock (see append_locked in FlipCutflow.h).                          *
+*   Job logs (Pythia output) are in RPVgServer.[pid]/ until the job is done.   *
+*                                                                               *
+********************************************************************************/
+
+#include "FlipRunPoint.h"           // does all the work
+#include <vector>                   // for vectors
+#include <deque>                    // for the queue
+#include <map>                      // for running jobs
+#include <cstdio>                   // for freopen, remove
+#include <cstdlib>                  // for strtol
+#include <cstring>                  // for memset, strncpy
+#include <csignal>                  // for signal
+#include <cerrno>                   // for errno
+#include <poll.h>                   // for poll
+#include <unistd.h>                 // for fork
+#include <sys/socket.h>             // for sockets
+#include <sys/un.h>                 // for Unix domain sockets
+#include <sys/stat.h>               // for mkdir
+#include <sys/wait.h>               // for waitpid
+using namespace std;
+
+
+struct serverjob{
+    // one point and SR for one client
+    int id;                         // job number, reported to the client
+    int client;                     // socket of the client that asked
+    pointjob job;                   // what to run
+};
+
+struct serverclient{
+    int socket;                     // connection
+    string buffer;                  // incomplete request line
+};
+
+
+void send_line(int client, string line){
+    // Blocking write of the whole line; a client that left is ignored
+
+    line += '\n';
+    size_t sent = 0;
+    while (sent < line.size()){
+        ssize_t nSent = write(client, line.data() + sent, line.size() - sent);
+        if (nSent < 0 && errno == EINTR) continue;
+        if (nSent <= 0) return;
+        sent += nSent;
+    }
+} // end send_line
+
+
+
+string trim(string text){
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+} // end trim
+
+
+
+int main(int argc, char *argv[]) {
+
+    /****************************************************************************
+    * SET UP                                                                    *
+    ****************************************************************************/
+
+    string socketname   = "RPVg.sock";          // where clients connect
+    int nWorkers        = sysconf(_SC_NPROCESSORS_ONLN);
+    string cmndtemp     = "TEMPLATE.cmnd";      // default cmnd file template
+    string spctemp      = "TEMPLATE.spc";       // default spc template
+    string outfile      = "output.dat";         // rows, as in RPVgPoint
+
+    if (argc > 1)  socketname   = argv[1];
+    if (argc > 2)  nWorkers     = atoi(argv[2]);
+    if (argc > 3)  cmndtemp     = argv[3];
+    if (argc > 4)  spctemp      = argv[4];
+    if (argc > 5)  outfile      = argv[5];
+    if (outfile == "-") outfile = "";
+    if (nWorkers < 1) nWorkers = 1;
+
+    // Job results and logs
+    stringstream workdirstream;
+    workdirstream << "RPVgServer." << getpid();
+    string workdir = workdirstream.str();
+    mkdir(workdir.c_str(), 0777);
+
+    signal(SIGPIPE, SIG_IGN);                   // clients may leave any time
+
+
+    // THE WARM PYTHIA OBJECT
+    // ----------------------
+    Pythia8::Pythia pythia;
+    addRecastSettings(pythia);
+    vector<signalregion> signal_region;         // only to check the SRs asked
+    fill_signalregions(signal_region);
+    int nSR = signal_region.size();
+
+
+    // SOCKET
+    // ------
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketname.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socketname.c_str());                 // left over from a crash
+    if ( (listener < 0) ||
+         (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0) ||
+         (listen(listener, 16) != 0) ){
+        cout << "ERROR: can't listen on " << socketname << endl;
+        return 1;
+    }
+    cout << endl << "RPVgServer: listening on " << socketname << " with "
+         << nWorkers << " workers" << endl;
+
+
+
+    /****************************************************************************
+    * SERVE                                                                     *
+    * -----                                                                     *
+    * One loop, no threads: accept clients, read their requests into the      *
+    * queue, start jobs while there are free workers, and send back results    *
+    * of the jobs that finished.                                                *
+    ****************************************************************************/
+
+    vector<serverclient> clients;
+    deque<serverjob> queue;
+    map<pid_t, serverjob> running;
+    int nJobs = 0;
+    bool shuttingDown = false;
+
+    while (!shuttingDown || !running.empty()){
+
+        // WAIT FOR SOMETHING TO HAPPEN
+        // ----------------------------
+        // (a finished job doesn't wake poll up, hence the timeout)
+        vector<struct pollfd> polled(1 + clients.size());
+        polled[0].fd = shuttingDown ? -1 : listener;
+        polled[0].events = POLLIN;
+        for (unsigned int iClient = 0; iClient < clients.size(); iClient++){
+            polled[1 + iClient].fd = clients[iClient].socket;
+            polled[1 + iClient].events = POLLIN;
+        }
+        poll(&polled[0], polled.size(), 200);
+
+
+        // NEW CLIENTS
+        // -----------
+        if (polled[0].revents & POLLIN){
+            int client = accept(listener, 0, 0);
+            if (client >= 0){
+                serverclient newclient;
+                newclient.socket = client;
+                clients.push_back(newclient);
+            }
+        }
+
+
+        // REQUESTS
+        // --------
+        vector<int> leaving;
+        for (unsigned int iClient = 0; iClient < clients.size(); iClient++){
+            if (!(polled[1 + iClient].revents & (POLLIN | POLLHUP))) continue;
+            serverclient& client = clients[iClient];
+
+            char data[4096];
+            ssize_t nRead = read(client.socket, data, sizeof(data));
+            if (nRead <= 0){
+                leaving.push_back(client.socket);
+                continue;
+            }
+            client.buffer.append(data, nRead);
+
+            size_t newline;
+            while ((newline = client.buffer.find('\n')) != string::npos){
+                string request = trim(client.buffer.substr(0, newline));
+                client.buffer.erase(0, newline + 1);
+                if (request.empty() || request[0] == '#') continue;
+
+                if (request == "quit"){
+                    leaving.push_back(client.socket);
+                    break;
+                }
+                if (request == "shutdown"){
+                    shuttingDown = true;
+                    continue;
+                }
+                if (request == "status"){
+                    stringstream reply;
+                    reply << "status " << queue.size() << " " << running.size();
+                    send_line(client.socket, reply.str());
+                    continue;
+                }
+
+                // mstop mgluino SRs ; setting ; setting ...
+                vector<string> settings;
+                stringstream fields(request);
+                string field;
+                getline(fields, field, ';');
+                string head = field;
+                while (getline(fields, field, ';'))
+                    if (!trim(field).empty()) settings.push_back(trim(field));
+
+                stringstream headstream(head);
+                string mstop, mgluino, regions;
+                headstream >> mstop >> mgluino >> regions;
+                if (regions.empty() || shuttingDown){
+                    send_line(client.socket, "error - can't read '" + request
+                        + "'");
+                    continue;
+                }
+
+                stringstream regionstream(regions);
+                string region;
+                while (getline(regionstream, region, ',')){
+                    char* end;
+                    long iSR = strtol(region.c_str(), &end, 10);
+                    if (region.empty() || *end != '\0' || iSR < 0 || iSR >= nSR){
+                        stringstream reply;
+                        reply << "error - no SR '" << region << "' (0 to "
+                              << nSR - 1 << ")";
+                        send_line(client.socket, reply.str());
+                        continue;
+                    }
+
+                    serverjob job;
+                    job.id              = ++nJobs;
+                    job.client          = client.socket;
+                    job.job.mstop       = mstop;
+                    job.job.mgluino     = mgluino;
+                    job.job.iSR         = iSR;
+                    job.job.cmndtemp    = cmndtemp;
+                    job.job.spctemp     = spctemp;
+                    job.job.outfile     = outfile;
+                    job.job.settings    = settings;
+                    stringstream tag;
+                    tag << ".job" << job.id;
+                    job.job.tag         = tag.str();
+                    queue.push_back(job);
+
+                    stringstream reply;
+                    reply << "queued " << job.id << " " << mstop << " "
+                          << mgluino << " " << job.job.iSR;
+                    send_line(client.socket, reply.str());
+                } // end loop over signal regions
+            } // end loop over complete lines
+        } // end loop over clients
+
+        // Clients that left: close, drop their queued jobs
+        for (unsigned int iLeft = 0; iLeft < leaving.size(); iLeft++){
+            close(leaving[iLeft]);
+            for (unsigned int iClient = 0; iClient < clients.size(); iClient++)
+                if (clients[iClient].socket == leaving[iLeft]){
+                    clients.erase(clients.begin() + iClient);
+                    break;
+                }
+            for (unsigned int iJob = queue.size(); iJob > 0; iJob--)
+                if (queue[iJob-1].client == leaving[iLeft])
+                    queue.erase(queue.begin() + iJob - 1);
+            for (map<pid_t, serverjob>::iterator job = running.begin();
+                job != running.end(); ++job)
+                if (job->second.client == leaving[iLeft]) job->second.client = -1;
+        } // end loop over clients that left
+
+
+        // START JOBS
+        // ----------
+        while (!shuttingDown && !queue.empty() &&
+            int(running.size()) < nWorkers){
+            serverjob job = queue.front();
+            queue.pop_front();
+
+            stringstream jobname;
+            jobname << workdir << "/job" << job.id;
+
+            pid_t pid = fork();
+            if (pid == 0){
+                // The worker: a copy of the warm Pythia object, without
+                // the server's sockets (a client that leaves must see EOF)
+                close(listener);
+                for (unsigned int iClient = 0; iClient < clients.size(); 
+                    iClient++) close(clients[iClient].socket);
+                if (!freopen((jobname.str() + ".log").c_str(), "w", stdout))
+                    _exit(1);
+                srand((unsigned)(time(0) + getpid()));
+                cutflowrecord record;
+                int status = run_point(job.job, record, &pythia);
+                if (status == 0 && !write_cutflow(jobname.str() + ".cut", record))
+                    status = 1;
+                fflush(stdout);
+                _exit(status);
+            }
+            if (pid < 0){
+                stringstream reply;
+                reply << "error " << job.id << " can't start a worker";
+                send_line(job.client, reply.str());
+                continue;
+            }
+            running[pid] = job;
+        } // end loop over jobs to start
+
+
+        // FINISHED JOBS
+        // -------------
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0){
+            if (running.find(pid) == running.end()) continue;
+            serverjob job = running[pid];
+            running.erase(pid);
+
+            stringstream jobname;
+            jobname << workdir << "/job" << job.id;
+            stringstream done;
+
+            ifstream result((jobname.str() + ".cut").c_str());
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && result.is_open()){
+                string line;
+                while (getline(result, line))
+                    if (job.client >= 0) send_line(job.client, line);
+                done << "done " << job.id;
+                remove((jobname.str() + ".log").c_str());
+            }
+            else done << "error " << job.id << " run failed, see "
+                      << jobname.str() << ".log";
+            result.close();
+            remove((jobname.str() + ".cut").c_str());
+
+            if (job.client >= 0) send_line(job.client, done.str());
+        } // end loop over finished jobs
+
+    } // end serving loop
+
+
+
+    /****************************************************************************
+    *   CLEAN UP                                                                *
+    *****************************************************************************/
+
+    for (unsigned int iClient = 0; iClient < clients.size(); iClient++)
+        close(clients[iClient].socket);
+    close(listener);
+    unlink(socketname.c_str());
+    rmdir(workdir.c_str());                     // only if no logs are left
+
+    return 0;
+}
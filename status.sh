@@ -0,0 +1,35 @@
+#!/bin/bash
+# HOW TO USE
+# Summarizes every RPVgPoint run on this node that publishes a status record
+# (see RPVg:status in FlipApplyCuts.cpp). One line per run.
+# arguments are as follows:
+# $1 status directory (default: /tmp/RPVgStatus, same as RPVg:statusDir)
+# 
+# FLAGS in the last column:
+#   STALLED  no update for more than 3 minutes (stuck point?)
+#   DEAD     the process is gone without cleaning up its record
+# 
+dir=${1:-/tmp/RPVgStatus}
+now=$(date +%s)
+
+printf "%7s %6s %6s %3s %17s %8s %6s %8s %8s %8s %9s  %s\n" \
+    PID MSTOP MGLU SR GENERATED PASSED ABORTS "EV/S" ETA "CPU(s)" "RSS(MB)" FLAG
+
+shopt -s nullglob
+for file in $dir/*.status;
+    do
+    awk -v now=$now -v file=$file '
+        { value[$1] = $3 }
+        END {
+            flag = ""
+            if (now - value["updated"] > 180) flag = "STALLED"
+            if (system("kill -0 " value["pid"] " 2>/dev/null") != 0) flag = "DEAD"
+            eta = (value["eta"] < 0) ? "-" : sprintf("%dm%02ds", \
+                value["eta"] / 60, value["eta"] % 60)
+            printf "%7s %6s %6s %3s %8d/%-8d %8d %6d %8.1f %8s %8.0f %9.1f  %s\n", \
+                value["pid"], value["mstop"], value["mgluino"], value["SR"], \
+                value["generated"], value["requested"], value["passed"], \
+                value["aborts"], value["rate"], eta, value["cpu"], \
+                value["rss"] / 1024, flag
+        }' $file
+    done 